@@ -18,6 +18,10 @@
 #include <deque>
 #include <map>
 #include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #include <unistd.h>
 
@@ -40,10 +44,29 @@ using namespace riscv;
 
 struct rv_parse_elf
 {
+	/*
+	 * Executable sections are split into chunks of instructions that are
+	 * scanned and formatted on worker threads. Results are retired in
+	 * order by the main thread, which limits how far workers run ahead.
+	 */
+	static const size_t chunk_insts = 65536;
+	static const size_t chunk_window = 64;
+
+	struct disasm_chunk
+	{
+		addr_t start;                  /* first instruction */
+		addr_t end;
+		addr_t hist;                   /* first instruction of the preceding history */
+		std::vector<addr_t> targets;
+		std::string out;
+		bool done;
+	};
+
 	elf_file elf;
 	std::string filename;
 	std::map<addr_t,uint32_t> continuations;
 	ssize_t continuation_num = 1;
+	size_t num_threads = std::max(1U, std::thread::hardware_concurrency());
 
 	bool enable_color = false;
 	bool elf_header = false;
@@ -80,7 +103,7 @@ struct rv_parse_elf
 
 	const char* symlookup(addr_t addr, bool nearest)
 	{
-		static char symbol_tmpname[256];
+		static thread_local char symbol_tmpname[256];
 		auto sym = elf.sym_by_addr((Elf64_Addr)addr);
 		auto bli = continuations.find(addr);
 		if (sym && bli != continuations.end()) {
@@ -111,13 +134,69 @@ struct rv_parse_elf
 		return nullptr;
 	}
 
-	void scan_continuations(addr_t start, addr_t end, addr_t pc_bias)
+	/* split [start, end) at instruction boundaries */
+	std::vector<disasm_chunk> split_chunks(addr_t start, addr_t end)
 	{
-		disasm dec;
+		std::vector<disasm_chunk> chunks;
+		std::deque<addr_t> recent;
 		addr_t pc = start;
 		addr_t pc_offset;
-		addr_t addr = 0;
-		while (pc < end) {
+		for (size_t n = 0; pc < end; n++) {
+			if (n % chunk_insts == 0) {
+				if (chunks.size() > 0) chunks.back().end = pc;
+				chunks.push_back(disasm_chunk{ pc, end, recent.size() ? recent.front() : pc });
+			}
+			inst_fetch(pc, pc_offset);
+			recent.push_back(pc);
+			if (recent.size() > rvx_instruction_buffer_len) recent.pop_front();
+			pc += pc_offset;
+		}
+		return chunks;
+	}
+
+	/* run fn on each chunk on worker threads and retire chunks in order */
+	void run_chunks(std::vector<disasm_chunk> &chunks,
+		std::function<void(disasm_chunk&)> fn, std::function<void(disasm_chunk&)> retire)
+	{
+		std::mutex mutex;
+		std::condition_variable cond;
+		std::atomic<size_t> next(0);
+		size_t retired = 0;
+		std::vector<std::thread> workers;
+		for (size_t t = 0; t < std::min(num_threads, chunks.size()); t++) {
+			workers.emplace_back([&] {
+				size_t i;
+				while ((i = next++) < chunks.size()) {
+					{
+						std::unique_lock<std::mutex> lock(mutex);
+						cond.wait(lock, [&] { return i < retired + chunk_window; });
+					}
+					fn(chunks[i]);
+					std::lock_guard<std::mutex> lock(mutex);
+					chunks[i].done = true;
+					cond.notify_all();
+				}
+			});
+		}
+		for (auto &chunk : chunks) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				cond.wait(lock, [&] { return chunk.done; });
+			}
+			retire(chunk);
+			std::lock_guard<std::mutex> lock(mutex);
+			retired++;
+			cond.notify_all();
+		}
+		for (auto &worker : workers) worker.join();
+	}
+
+	void scan_continuations(disasm_chunk &chunk, addr_t end, addr_t pc_bias)
+	{
+		disasm dec;
+		addr_t pc = chunk.start;
+		addr_t pc_offset;
+		while (pc < chunk.end) {
 			dec.pc = pc;
 			dec.inst = inst_fetch(pc, pc_offset);
 			decode_inst_rv64(dec, dec.inst);
@@ -125,10 +204,7 @@ struct rv_parse_elf
 				case rv_op_jal:
 				case rv_op_jalr:
 					if (pc + pc_offset < end) {
-						addr = pc - pc_bias + pc_offset;
-						if (continuations.find(addr) == continuations.end()) {
-							continuations.insert(std::pair<addr_t,uint32_t>(addr, continuation_num++));
-						}
+						chunk.targets.push_back(pc - pc_bias + pc_offset);
 					}
 					break;
 				default:
@@ -136,10 +212,7 @@ struct rv_parse_elf
 			}
 			switch (dec.codec) {
 				case rv_codec_sb:
-					addr = pc - pc_bias + dec.imm;
-					if (continuations.find(addr) == continuations.end()) {
-						continuations.insert(std::pair<addr_t,uint32_t>(addr, continuation_num++));
-					}
+					chunk.targets.push_back(pc - pc_bias + dec.imm);
 					break;
 				default:
 					break;
@@ -148,20 +221,29 @@ struct rv_parse_elf
 		}
 	}
 
-	void print_disassembly(addr_t start, addr_t end, addr_t pc_bias, addr_t gp)
+	void print_disassembly(disasm_chunk &chunk, addr_t pc_bias, addr_t gp)
 	{
 		disasm dec;
 		std::deque<disasm> dec_hist;
-		addr_t pc = start;
+		addr_t pc = chunk.hist;
 		addr_t pc_offset;
-		while (pc < end) {
+		symbol_name_fn symlookup_fn = [this](addr_t addr, bool nearest) {
+			return symlookup(addr, nearest);
+		};
+		symbol_colorize_fn colorize_fn = [this](const char *type) {
+			return colorize(type);
+		};
+		while (pc < chunk.end) {
 			dec.pc = pc;
 			dec.inst = inst_fetch(pc, pc_offset);
 			decode_inst_rv64(dec, dec.inst);
 			if (decode_pseudo) decode_pseudo_inst(dec);
-			disasm_inst_print(dec, dec_hist, pc, pc_bias, gp,
-				std::bind(&rv_parse_elf::symlookup, this, std::placeholders::_1, std::placeholders::_2),
-				std::bind(&rv_parse_elf::colorize, this, std::placeholders::_1));
+			if (pc < chunk.start) {
+				disasm_inst_history(dec, dec_hist);
+			} else {
+				disasm_inst_format(chunk.out, dec, dec_hist, pc, pc_bias, gp,
+					symlookup_fn, colorize_fn);
+			}
 			pc += pc_offset;
 		}
 	}
@@ -169,14 +251,35 @@ struct rv_parse_elf
 	void print_disassembly()
 	{
 		const Elf64_Sym *gp_sym = elf.sym_by_name("_gp");
+		addr_t gp = addr_t(gp_sym ? gp_sym->st_value : 0);
 		for (size_t i = 0; i < elf.shdrs.size(); i++) {
 			Elf64_Shdr &shdr = elf.shdrs[i];
 			if (shdr.sh_flags & SHF_EXECINSTR) {
-				addr_t offset = (addr_t)elf.sections[i].buf.data();
+				addr_t offset = (addr_t)elf.sections[i].data();
+				addr_t end = offset + shdr.sh_size;
+				addr_t pc_bias = offset - shdr.sh_addr;
 				printf("%sSection[%2lu] %-111s%s\n", colorize("title"), i, elf.shdr_name(i), colorize("reset"));
-				scan_continuations(offset, offset + shdr.sh_size, offset - shdr.sh_addr);
-				print_disassembly(offset, offset + shdr.sh_size, offset- shdr.sh_addr,
-					addr_t(gp_sym ? gp_sym->st_value : 0));
+				auto chunks = split_chunks(offset, end);
+
+				/* number continuations in address order of discovery */
+				run_chunks(chunks, [&](disasm_chunk &chunk) {
+					scan_continuations(chunk, end, pc_bias);
+				}, [&](disasm_chunk &chunk) {
+					for (auto addr : chunk.targets) {
+						if (continuations.find(addr) == continuations.end()) {
+							continuations.insert(std::pair<addr_t,uint32_t>(addr, continuation_num++));
+						}
+					}
+					std::vector<addr_t>().swap(chunk.targets);
+				});
+
+				for (auto &chunk : chunks) chunk.done = false;
+				run_chunks(chunks, [&](disasm_chunk &chunk) {
+					print_disassembly(chunk, pc_bias, gp);
+				}, [&](disasm_chunk &chunk) {
+					fwrite(chunk.out.data(), 1, chunk.out.size(), stdout);
+					std::string().swap(chunk.out);
+				});
 				printf("\n");
 			}
 		}
@@ -213,6 +316,14 @@ struct rv_parse_elf
 			{ "-P", "--pseudo", cmdline_arg_type_none,
 				"Decode Pseudoinstructions",
 				[&](std::string s) { return (decode_pseudo = true); } },
+			{ "-j", "--threads", cmdline_arg_type_string,
+				"Disassembly threads",
+				[&](std::string s) {
+					long long n;
+					if (!parse_integral(s, n) || n < 1) return false;
+					num_threads = size_t(n);
+					return true;
+				} },
 			{ "-h", "--print-headers", cmdline_arg_type_none,
 				"Print All Headers",
 				[&](std::string s) { return (elf_header = section_headers = program_headers = true); } },
@@ -27,6 +27,8 @@
 #include <deque>
 #include <map>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <type_traits>
 
@@ -70,6 +72,8 @@
 #include "amo.h"
 #include "processor-logging.h"
 #include "processor-base.h"
+#include "queue.h"
+#include "processor-trace.h"
 #include "processor-impl.h"
 #include "interp.h"
 #include "processor-model.h"
@@ -79,6 +83,7 @@
 #include "processor-histogram.h"
 #include "processor-proxy.h"
 #include "debug-cli.h"
+#include "processor-block-cache.h"
 
 #include "asmjit.h"
 
@@ -88,6 +93,8 @@
 #include "jit-fusion.h"
 #include "jit-tracer.h"
 #include "jit-regalloc.h"
+#include "jit-hotspot.h"
+#include "jit-trace-store.h"
 #include "jit-runloop.h"
 
 using namespace riscv;
@@ -161,6 +168,7 @@ struct rv_jit_emulator
 	int proc_logs = 0;
 	int trace_iters = 100;
 	int trace_length = 0;
+	size_t trace_cache_mb = 0;
 	bool disable_fusion = false;
 	bool memory_registers = false;
 	bool update_instret = false;
@@ -169,6 +177,8 @@ struct rv_jit_emulator
 	uint64_t initial_seed = 0;
 	std::string elf_filename;
 	std::string stats_dirname;
+	std::string trace_filename;
+	std::string trace_cache_dir;
 
 	std::vector<std::string> host_cmdline;
 	std::vector<std::string> host_env;
@@ -209,6 +219,9 @@ struct rv_jit_emulator
 			{ "-D", "--save-exit-stats", cmdline_arg_type_string,
 				"Save Registers and Statistics at Exit",
 				[&](std::string s) { stats_dirname = s; return (proc_logs |= proc_log_exit_save_stats); } },
+			{ "-B", "--binary-trace", cmdline_arg_type_string,
+				"Write Binary Instruction Trace (disables JIT)",
+				[&](std::string s) { trace_filename = s; mode = jit_mode_none; return (proc_logs |= proc_log_trace); } },
 			{ "-P", "--pc-usage-histogram", cmdline_arg_type_none,
 				"Record program counter usage",
 				[&](std::string s) { return (proc_logs |= proc_log_hist_pc); } },
@@ -242,6 +255,12 @@ struct rv_jit_emulator
 			{ "-I", "--trace-iters", cmdline_arg_type_string,
 				"Trace iterations",
 				[&](std::string s) { trace_iters = strtoull(s.c_str(), nullptr, 10); return true; } },
+			{ "-C", "--jit-cache-mb", cmdline_arg_type_string,
+				"JIT trace cache size limit in MiB (default unbounded)",
+				[&](std::string s) { trace_cache_mb = strtoull(s.c_str(), nullptr, 10); return true; } },
+			{ "-J", "--jit-cache-dir", cmdline_arg_type_string,
+				"Save and reload JIT traces keyed by executable text hash",
+				[&](std::string s) { trace_cache_dir = s; return true; } },
 			{ "-s", "--seed", cmdline_arg_type_string,
 				"Random seed",
 				[&](std::string s) { initial_seed = strtoull(s.c_str(), nullptr, 10); return true; } },
@@ -291,7 +310,7 @@ struct rv_jit_emulator
 			case jit_mode_none:
 				break;
 			case jit_mode_trace:
-				proc_logs |= proc_log_hist_pc | proc_log_jit_trap;
+				proc_logs |= proc_log_jit_trap;
 				break;
 			case jit_mode_audit:
 				proc_logs |= proc_log_jit_audit;
@@ -303,12 +322,15 @@ struct rv_jit_emulator
 		proc.log = proc_logs;
 		proc.mmu.mem->log = (proc.log & proc_log_memory);
 		proc.stats_dirname = stats_dirname;
+		if (proc.log & proc_log_trace) proc.trace_open(trace_filename);
 		if (symbolicate) proc.symlookup = [&](addr_t va) { return proc.symlookup_elf(va); };
 
 		/* set JIT options */
 		proc.trace_iters = trace_iters;
+		proc.trace_cache_limit = trace_cache_mb << 20;
 		proc.update_instret = update_instret;
 		proc.memory_registers = memory_registers;
+		proc.trace_cache_dir = trace_cache_dir;
 
 		/* randomise integer register state with 512 bits of entropy */
 		proc.seed_registers(cpu, initial_seed, 512);
@@ -26,6 +26,8 @@
 #include <deque>
 #include <map>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <type_traits>
 
@@ -68,6 +70,8 @@
 #include "amo.h"
 #include "processor-logging.h"
 #include "processor-base.h"
+#include "queue.h"
+#include "processor-trace.h"
 #include "processor-impl.h"
 #include "interp.h"
 #include "processor-model.h"
@@ -77,6 +81,7 @@
 #include "processor-histogram.h"
 #include "processor-proxy.h"
 #include "debug-cli.h"
+#include "processor-block-cache.h"
 #include "processor-runloop.h"
 
 #ifdef RECOGNI
@@ -141,6 +146,7 @@ struct rv_emulator
 	uint64_t initial_seed = 0;
 	std::string elf_filename;
 	std::string stats_dirname;
+	std::string trace_filename;
 
 	std::vector<std::string> host_cmdline;
 	std::vector<std::string> host_env;
@@ -175,6 +181,9 @@ struct rv_emulator
 			{ "-D", "--save-exit-stats", cmdline_arg_type_string,
 				"Save Registers and Statistics at Exit",
 				[&](std::string s) { stats_dirname = s; return (proc_logs |= proc_log_exit_save_stats); } },
+			{ "-B", "--binary-trace", cmdline_arg_type_string,
+				"Write Binary Instruction Trace",
+				[&](std::string s) { trace_filename = s; return (proc_logs |= proc_log_trace); } },
 			{ "-P", "--pc-usage-histogram", cmdline_arg_type_none,
 				"Record program counter usage",
 				[&](std::string s) { return (proc_logs |= proc_log_hist_pc); } },
@@ -241,6 +250,7 @@ struct rv_emulator
 		proc.log = proc_logs;
 		proc.mmu.mem->log = (proc.log & proc_log_memory);
 		proc.stats_dirname = stats_dirname;
+		if (proc.log & proc_log_trace) proc.trace_open(trace_filename);
 		if (symbolicate) proc.symlookup = [&](addr_t va) { return proc.symlookup_elf(va); };
 
 		/* randomise integer register state with 512 bits of entropy */
@@ -298,6 +308,7 @@ struct rv_emulator
 		proc.log = proc_logs;
 		proc.mmu.mem->log = (proc.log & proc_log_memory);
 		proc.stats_dirname = stats_dirname;
+		if (proc.log & proc_log_trace) proc.trace_open(trace_filename);
 		if (symbolicate) proc.symlookup = [&](addr_t va) { return proc.symlookup_elf(va); };
 
 		/* randomise integer register state with 512 bits of entropy */
@@ -9,80 +9,225 @@ using priv_emulator_rv32imafdc = processor_runloop<processor_privileged<processo
 using priv_emulator_rv64imafdc = processor_runloop<processor_privileged<processor_rv64imafdc_model<decode,processor_priv_rv64imafd,mmu_soft_rv64>>>;
 
 
-priv_emulator_rv32imafdc proc;
-rv_emulator emulator;
+/* An embedded machine; each thread acts on its current machine */
+
+struct rv8_machine
+{
+	rv_emulator emulator;
+	priv_emulator_rv32imafdc proc;
+};
+
+static thread_local rv8_machine *machine_current = nullptr;
+
+static priv_emulator_rv32imafdc& current_proc()
+{
+	if (!machine_current) {
+		panic("rv8: no current machine on this thread");
+	}
+	return machine_current->proc;
+}
+
+rv8_machine *emulation_create(int argc, const char* argv[], const char* envp[])
+{
+	rv8_machine *machine = new rv8_machine();
+	rv8_machine *save = machine_current;
+	machine_current = machine;
+	machine->emulator.parse_commandline(argc, argv, envp);
+	if (machine->emulator.ram_boot == 0) {
+		machine->emulator.load();
+	}
+	machine->emulator.setup_priv<priv_emulator_rv32imafdc>(machine->proc);
+	emulation_make_current(save);
+	return machine;
+}
+
+void emulation_destroy(rv8_machine *machine)
+{
+	if (machine_current == machine) {
+		machine_current = nullptr;
+	}
+	delete machine;
+}
+
+void emulation_make_current(rv8_machine *machine)
+{
+	/* the host FP environment holds the outgoing machine's accrued flags */
+	if (machine_current) {
+		fenv_getflags(machine_current->proc.fcsr);
+	}
+	machine_current = machine;
+	if (machine) {
+		fenv_init();
+		machine->proc.make_current();
+	} else {
+		processor_singleton::current = nullptr;
+	}
+}
+
+rv8_machine *emulation_current()
+{
+	return machine_current;
+}
 
 int emulation_setup(int argc, const char* argv[], const char* envp[])
 {
-	emulator.parse_commandline(argc, argv, envp);
-	emulator.load();
-	emulator.setup_priv<priv_emulator_rv32imafdc>(proc);
+	emulation_make_current(emulation_create(argc, argv, envp));
 	return 0;
 }
 
 int emulation_run(size_t count)
 {
     exit_cause ec;
-    ec = proc.step(count);
+    ec = current_proc().step(count);
     return (ec != exit_cause_cli);
 }
 
 char *emulation_debug(char *debug_cmd)
 {
-    std::shared_ptr<debug_cli<priv_emulator_rv32imafdc>> cli;
-    cli->one_shot(&proc, debug_cmd);
+    auto &proc = current_proc();
+    proc.cli->one_shot(&proc, debug_cmd);
     return NULL;
 }
 
 void emulation_fini()
 {
-    emulator.fini_priv(proc);
+    rv8_machine *machine = machine_current;
+    if (!machine) return;
+    machine->emulator.fini_priv(machine->proc);
+    emulation_destroy(machine);
 }
 
 int emulation_pin_get(std::string pin_type, unsigned pin_instance) {
-    return proc.pins.pin_get(pin_type, pin_instance);
+    return current_proc().pins.pin_get(pin_type, pin_instance);
 }
 
     
 void emulation_set_reg_write_callback(std::function<int (unsigned long long,
 							 unsigned)> fn)
 {
-    proc.device_external->reg_write_cb_fn = fn;
+    current_proc().device_external->reg_write_cb_fn = fn;
 }
 
 void emulation_set_reg_read_callback(std::function<int (unsigned long long,
 							unsigned &)> fn)
 {
-    proc.device_external->reg_read_cb_fn = fn;
+    current_proc().device_external->reg_read_cb_fn = fn;
 }
 
 void emulation_pin_set(std::string pin_type, unsigned pin_instance,
 		       int pullup, int val) {
+    auto &proc = current_proc();
     proc.pins.ext_pin_set(pin_type, pin_instance, val);
     proc.pins.ext_pin_pullup(pin_type, pin_instance, pullup);
 }
 
+/* host access never wraps the physical address space */
+
+static bool mem_range_valid(unsigned long long addr, size_t len)
+{
+    typedef priv_emulator_rv32imafdc::ux ux;
+    return addr <= std::numeric_limits<ux>::max() &&
+	(len == 0 || len - 1 <= std::numeric_limits<ux>::max() - addr);
+}
+
+/* host writes bypass the MMU, so flush decoded code on pages they touch */
+
+void emulation_mem_invalidate(unsigned long long addr, size_t len) {
+    auto &proc = current_proc();
+    if (len == 0 || !mem_range_valid(addr, len)) {
+	return;
+    }
+    unsigned long long last = (addr + len - 1) & page_mask;
+    for (auto hart : proc.harts) {
+	for (unsigned long long page = addr & page_mask; ; page += page_size) {
+	    if (hart->mmu.code_page(page)) {
+		hart->mmu.code_store();
+		break;
+	    }
+	    if (page == last) {
+		break;
+	    }
+	}
+    }
+}
+
+/* word access goes through the memory bus so device registers can be reached */
+
 int emulation_mem_write(unsigned long long addr, unsigned long *val, int size) {
+    auto &proc = current_proc();
+    if (size < 0 || !mem_range_valid(addr, size)) {
+	return -1;
+    }
     int rv = 0;
-    for (int i = 0; i < size; i+= 4) {
-	rv = proc.mmu.mem->store(addr, *val);
+    for (int i = 0; i < size; i += 4) {
+	rv = proc.mmu.mem->store_32(addr + i, u32(*val));
 	if (rv != 0) {
 	    break;
-	} 
+	}
 	val++;
     }
+    emulation_mem_invalidate(addr, size);
     return rv;
 }
 
 int emulation_mem_read(unsigned long long addr, unsigned long *val, int size) {
+    auto &proc = current_proc();
+    if (size < 0 || !mem_range_valid(addr, size)) {
+	return -1;
+    }
     int rv = 0;
-    for (int i = 0; i < size; i+= 4) {
-	rv = proc.mmu.mem->store(addr, *val);
+    for (int i = 0; i < size; i += 4) {
+	u32 word;
+	rv = proc.mmu.mem->load_32(addr + i, word);
 	if (rv != 0) {
 	    break;
-	} 
-	val++;
+	}
+	*val++ = word;
     }
     return rv;
 }
 
+void *emulation_mem_map(unsigned long long addr, size_t len) {
+    struct iovec iov;
+    if (len == 0 || emulation_mem_map_iov(addr, len, &iov, 1) != 1) {
+	return nullptr;
+    }
+    return iov.iov_base;
+}
+
+int emulation_mem_map_iov(unsigned long long addr, size_t len, struct iovec *iov, int iovcnt) {
+    auto &proc = current_proc();
+    if (!mem_range_valid(addr, len)) {
+	return -1;
+    }
+    return proc.mmu.mem->mpa_to_iovec(addr, len, iov, iovcnt);
+}
+
+int emulation_mem_write_bytes(unsigned long long addr, const void *buf, size_t len) {
+    auto &proc = current_proc();
+    if (!mem_range_valid(addr, len)) {
+	return -1;
+    }
+    int rv = proc.mmu.mem->store_bytes(addr, (char*)buf, len);
+    if (rv == 0) {
+	emulation_mem_invalidate(addr, len);
+    }
+    return rv;
+}
+
+int emulation_mem_read_bytes(unsigned long long addr, void *buf, size_t len) {
+    auto &proc = current_proc();
+    if (!mem_range_valid(addr, len)) {
+	return -1;
+    }
+    return proc.mmu.mem->load_bytes(addr, (char*)buf, len);
+}
+
+void emulation_set_mmio_batch_callback(mmio_txn_batch_fn fn, size_t ring_size) {
+    auto &proc = current_proc();
+    if (fn) {
+	proc.device_external->start_async(fn, ring_size);
+    } else {
+	proc.device_external->stop_async();
+    }
+}
@@ -39,6 +39,7 @@
 #include <unistd.h>
 #include <termios.h>
 #include <sys/mman.h>
+#include <sys/uio.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 
@@ -66,13 +67,14 @@
 #include "amo.h"
 #include "processor-logging.h"
 #include "processor-base.h"
+#include "queue.h"
+#include "processor-trace.h"
 #include "processor-impl.h"
 #include "mmu-memory.h"
 #include "tlb-soft.h"
 #include "mmu-soft.h"
 #include "interp.h"
 #include "processor-model.h"
-#include "queue.h"
 #include "console.h"
 #include "device-rom-boot.h"
 #include "device-rom-sbi.h"
@@ -86,11 +88,14 @@
 #include "device-gpio.h"
 #include "device-rand.h"
 #include "device-htif.h"
+#include "mmio-txn.h"
 #include "device-external.h"
 #include "processor-histogram.h"
 #include "processor-priv-1.9.h"
 #include "debug-cli.h"
+#include "processor-block-cache.h"
 #include "processor-runloop.h"
+#include "processor-snapshot.h"
 
 #ifdef RECOGNI
 #include "rv8.h"
@@ -149,8 +154,14 @@ struct rv_emulator
 	addr_t map_physical = 0;
 	s64 ram_boot = 0;
 	uint64_t initial_seed = 0;
+	size_t num_harts = 1;
+	bool virtual_time = false;
+	u64 snapshot_instret = 0;
+	std::string snapshot_save_filename;
+	std::string snapshot_restore_filename;
 	std::string boot_filename;
 	std::string stats_dirname;
+	std::string trace_filename;
 
 	std::vector<std::string> host_cmdline;
 	std::vector<std::string> host_env;
@@ -206,6 +217,26 @@ struct rv_emulator
 			pma_type_main | elf_pma_flags(phdr.p_flags));
 	}
 
+	/* map a raw boot image over RAM copy-on-write, returns the image size */
+	size_t map_boot_image_priv(const char* filename, addr_t ram_base, size_t ram_size)
+	{
+		struct stat statbuf;
+		int fd = open(filename, O_RDONLY);
+		if (fd < 0 || fstat(fd, &statbuf) < 0) {
+			panic("unable to open boot file: %s: %s", filename, strerror(errno));
+		}
+		if (size_t(statbuf.st_size) > ram_size) {
+			panic("boot file larger than RAM: %s", filename);
+		}
+		if (statbuf.st_size > 0 && mmap((void*)ram_base, round_up(size_t(statbuf.st_size), page_size),
+			PROT_READ | PROT_WRITE, MAP_FIXED | MAP_PRIVATE, fd, 0) == MAP_FAILED)
+		{
+			panic("unable to map boot file: %s: %s", filename, strerror(errno));
+		}
+		close(fd);
+		return statbuf.st_size;
+	}
+
 	void parse_commandline(int argc, const char* argv[], const char* envp[])
 	{
 		cmdline_option options[] =
@@ -246,6 +277,9 @@ struct rv_emulator
 			{ "-D", "--save-exit-stats", cmdline_arg_type_string,
 				"Save Registers and Statistics at Exit",
 				[&](std::string s) { stats_dirname = s; return (proc_logs |= proc_log_exit_save_stats); } },
+			{ "-B", "--binary-trace", cmdline_arg_type_string,
+				"Write Binary Instruction Trace",
+				[&](std::string s) { trace_filename = s; return (proc_logs |= proc_log_trace); } },
 			{ "-P", "--pc-usage-histogram", cmdline_arg_type_none,
 				"Record program counter usage",
 				[&](std::string s) { return (proc_logs |= proc_log_hist_pc); } },
@@ -270,6 +304,21 @@ struct rv_emulator
 			{ "-b", "--binary", cmdline_arg_type_string,
 				"Boot Binary ( 32, 64 )",
 				[&](std::string s) { return parse_integral(s, ram_boot); } },
+			{ "-n", "--harts", cmdline_arg_type_string,
+				"Number of harts",
+				[&](std::string s) { num_harts = strtoull(s.c_str(), nullptr, 10); return true; } },
+			{ "-V", "--virtual-time", cmdline_arg_type_none,
+				"Derive time from instructions retired",
+				[&](std::string s) { return (virtual_time = true); } },
+			{ "-k", "--save-snapshot", cmdline_arg_type_string,
+				"Save a machine snapshot and exit at --snapshot-instret",
+				[&](std::string s) { snapshot_save_filename = s; return true; } },
+			{ "-i", "--snapshot-instret", cmdline_arg_type_string,
+				"Instructions retired before saving the snapshot",
+				[&](std::string s) { snapshot_instret = strtoull(s.c_str(), nullptr, 10); return true; } },
+			{ "-K", "--restore-snapshot", cmdline_arg_type_string,
+				"Restore a machine snapshot",
+				[&](std::string s) { snapshot_restore_filename = s; return true; } },
 			{ "-s", "--seed", cmdline_arg_type_string,
 				"Random seed",
 				[&](std::string s) { initial_seed = strtoull(s.c_str(), nullptr, 10); return true; } },
@@ -293,6 +342,19 @@ struct rv_emulator
 			exit(9);
 		}
 
+		/* number of harts is limited by the MIPI and timer devices */
+		if (num_harts < 1 || num_harts > mipi_mmio_device<priv_emulator_rv64imafdc>::num_harts) {
+			panic("--harts must be between 1 and %d",
+				mipi_mmio_device<priv_emulator_rv64imafdc>::num_harts);
+		}
+
+		if ((snapshot_save_filename.size() || snapshot_restore_filename.size()) && num_harts > 1) {
+			panic("snapshots are only supported with one hart");
+		}
+		if (snapshot_save_filename.size() && snapshot_instret == 0) {
+			panic("--save-snapshot requires --snapshot-instret");
+		}
+
 		/* get command line options */
 		boot_filename = result.first[0];
 		for (size_t i = 0; i < result.first.size(); i++) {
@@ -319,6 +381,8 @@ struct rv_emulator
 		proc.log = proc_logs;
 		proc.mmu.mem->log = (proc.log & proc_log_memory);
 		proc.stats_dirname = stats_dirname;
+		proc.virtual_time = virtual_time;
+		if (proc.log & proc_log_trace) proc.trace_open(trace_filename);
 
 		/* randomise integer register state with 512 bits of entropy */
 		proc.seed_registers(cpu, initial_seed, 512);
@@ -327,8 +391,6 @@ struct rv_emulator
 		typename P::ux rom_base = 0, rom_size = 0, rom_entry = 0;
 
 		if (ram_boot == 32 || ram_boot == 64) {
-			struct stat statbuf;
-			FILE *file = nullptr;
 			memory_segment<typename P::ux> *segment = nullptr;
 
 			/* Add 1GB RAM to the mmu */
@@ -338,19 +400,8 @@ struct rv_emulator
 			if (segment == nullptr) {
 				panic("unable to locate ram");
 			}
-			if (stat(boot_filename.c_str(), &statbuf) < 0) {
-				panic("unable to stat boot file: %s", boot_filename.c_str());
-			}
-			if (!(file = fopen(boot_filename.c_str(), "r"))) {
-				panic("unable to open boot file: %s", boot_filename.c_str());
-			}
-			ssize_t len = fread((void*)ram_base, 1, statbuf.st_size, file);
-			if (len != statbuf.st_size) {
-				panic("unable to read boot file: %s", boot_filename.c_str());
-			}
-			fclose(file);
 			rom_base = default_ram_base;
-			rom_size = statbuf.st_size;
+			rom_size = map_boot_image_priv(boot_filename.c_str(), ram_base, default_ram_size);
 			rom_entry = default_ram_base;
 		} else {
 			/* Find the ELF executable PT_LOAD segment base address */
@@ -378,9 +429,10 @@ struct rv_emulator
 		}
 
 		/* Initialize interpreter */
+		proc.num_harts = num_harts;
 		proc.init();
 		proc.reset(); /* Reset code calls mapped ROM image */
-		proc.device_config->num_harts = 1;
+		proc.device_config->num_harts = num_harts;
 		proc.device_config->time_base = 1000000000;
 		proc.device_config->rom_base = rom_base;
 		proc.device_config->rom_size = rom_size;
@@ -391,6 +443,48 @@ struct rv_emulator
 		/* Override the reset vector */
 		proc.pc = rom_entry;
 
+		/* Restore the machine state over the freshly loaded image */
+		if (snapshot_restore_filename.size()) {
+			snapshot_restore(proc, snapshot_restore_filename);
+		}
+
+		/* Run to the snapshot point, save and exit */
+		if (snapshot_save_filename.size()) {
+			while (proc.instret < snapshot_instret) {
+				u64 count = std::min<u64>(P::inst_step, snapshot_instret - proc.instret);
+				if (proc.step(proc.step_limit(count)) == exit_cause_poweroff) {
+					panic("snapshot: powered off at instret %llu", u64(proc.instret));
+				}
+			}
+			snapshot_save(proc, snapshot_save_filename);
+			return;
+		}
+
+		/*
+		 * Secondary harts share memory and devices with the boot hart and
+		 * have their own TLBs and decode caches. Only the boot hart writes
+		 * the binary trace and enters the debugger
+		 */
+		std::vector<std::unique_ptr<P>> harts;
+		std::vector<std::thread> hart_threads;
+		for (size_t i = 1; i < num_harts; i++) {
+			auto hart = std::unique_ptr<P>(new P());
+			hart->log = proc.log & ~(proc_log_trace | proc_log_ebreak_cli | proc_log_trap_cli);
+			hart->virtual_time = virtual_time;
+			hart->seed_registers(cpu, initial_seed ? initial_seed + i : 0, 512);
+			hart->init_hart(proc, i);
+			hart->reset();
+			hart->pc = rom_entry;
+			harts.push_back(std::move(hart));
+		}
+		for (auto &hart : harts) {
+			P *h = hart.get();
+			hart_threads.push_back(std::thread([h] {
+				h->hart_thread_init();
+				h->run(exit_cause_continue);
+			}));
+		}
+
 #if defined (ENABLE_GPERFTOOL)
 		ProfilerStart("test-emulate.out");
 #endif
@@ -403,6 +497,13 @@ struct rv_emulator
 		proc.run(proc.log & proc_log_ebreak_cli
 			? exit_cause_cli : exit_cause_continue);
 
+		/* stop secondary harts */
+		proc.poweroff_req = true;
+		proc.wake_harts();
+		for (auto &thread : hart_threads) {
+			thread.join();
+		}
+
 #if defined (ENABLE_GPERFTOOL)
 		ProfilerStop();
 #endif
@@ -455,6 +556,8 @@ struct rv_emulator
 		proc.log = proc_logs;
 		proc.mmu.mem->log = (proc.log & proc_log_memory);
 		proc.stats_dirname = stats_dirname;
+		proc.virtual_time = virtual_time;
+		if (proc.log & proc_log_trace) proc.trace_open(trace_filename);
 
 		/* randomise integer register state with 512 bits of entropy */
 		proc.seed_registers(cpu, initial_seed, 512);
@@ -463,8 +566,6 @@ struct rv_emulator
 		typename P::ux rom_base = 0, rom_size = 0, rom_entry = 0;
 
 		if (ram_boot == 32 || ram_boot == 64) {
-			struct stat statbuf;
-			FILE *file = nullptr;
 			memory_segment<typename P::ux> *segment = nullptr;
 
 			/* Add 1GB RAM to the mmu */
@@ -474,19 +575,8 @@ struct rv_emulator
 			if (segment == nullptr) {
 				panic("unable to locate ram");
 			}
-			if (stat(boot_filename.c_str(), &statbuf) < 0) {
-				panic("unable to stat boot file: %s", boot_filename.c_str());
-			}
-			if (!(file = fopen(boot_filename.c_str(), "r"))) {
-				panic("unable to open boot file: %s", boot_filename.c_str());
-			}
-			ssize_t len = fread((void*)ram_base, 1, statbuf.st_size, file);
-			if (len != statbuf.st_size) {
-				panic("unable to read boot file: %s", boot_filename.c_str());
-			}
-			fclose(file);
 			rom_base = default_ram_base;
-			rom_size = statbuf.st_size;
+			rom_size = map_boot_image_priv(boot_filename.c_str(), ram_base, default_ram_size);
 			rom_entry = default_ram_base;
 		} else {
 			/* Find the ELF executable PT_LOAD segment base address */
@@ -0,0 +1,171 @@
+//
+//  rv-trace.cc
+//
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cinttypes>
+#include <cstdarg>
+#include <cerrno>
+#include <cassert>
+#include <csignal>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include <pthread.h>
+
+#include "host-endian.h"
+#include "types.h"
+#include "bits.h"
+#include "format.h"
+#include "meta.h"
+#include "util.h"
+#include "cmdline.h"
+#include "codec.h"
+#include "strings.h"
+#include "disasm.h"
+#include "queue.h"
+#include "processor-trace.h"
+
+using namespace riscv;
+
+struct rv_trace
+{
+	std::string filename;
+	u64 start = 0;
+	u64 count = std::numeric_limits<u64>::max();
+	u64 pc_begin = 0;
+	u64 pc_end = std::numeric_limits<u64>::max();
+	bool operands = false;
+	bool decode_pseudo = false;
+	bool help_or_error = false;
+
+	void parse_commandline(int argc, const char *argv[])
+	{
+		cmdline_option options[] =
+		{
+			{ "-s", "--start", cmdline_arg_type_string,
+				"Start at instret",
+				[&](std::string s) { return parse_value(s.c_str(), start); } },
+			{ "-n", "--count", cmdline_arg_type_string,
+				"Number of instructions to print",
+				[&](std::string s) { return parse_value(s.c_str(), count); } },
+			{ "-b", "--pc-begin", cmdline_arg_type_string,
+				"Only print instructions at or above pc",
+				[&](std::string s) { return parse_value(s.c_str(), pc_begin); } },
+			{ "-e", "--pc-end", cmdline_arg_type_string,
+				"Only print instructions below pc",
+				[&](std::string s) { return parse_value(s.c_str(), pc_end); } },
+			{ "-o", "--operands", cmdline_arg_type_none,
+				"Print register writes and memory accesses",
+				[&](std::string s) { return (operands = true); } },
+			{ "-P", "--pseudo", cmdline_arg_type_none,
+				"Decode Pseudoinstructions",
+				[&](std::string s) { return (decode_pseudo = true); } },
+			{ "-h", "--help", cmdline_arg_type_none,
+				"Show help",
+				[&](std::string s) { return (help_or_error = true); } },
+			{ nullptr, nullptr, cmdline_arg_type_none,   nullptr, nullptr }
+		};
+
+		auto result = cmdline_option::process_options(options, argc, argv);
+		if (!result.second) {
+			help_or_error = true;
+		} else if (result.first.size() != 1 && !help_or_error) {
+			printf("%s: wrong number of arguments\n", argv[0]);
+			help_or_error = true;
+		}
+
+		if (help_or_error) {
+			printf("usage: %s [<options>] <trace_file>\n", argv[0]);
+			cmdline_option::print_options(options);
+			exit(9);
+		}
+
+		filename = result.first[0];
+	}
+
+	static bool parse_value(const char *valstr, u64 &val)
+	{
+		long long v;
+		if (!parse_integral(valstr, v)) return false;
+		val = u64(v);
+		return true;
+	}
+
+	static std::string format_inst(inst_t inst)
+	{
+		switch (inst_length(inst)) {
+			case 2:  return format_string("%04llx    ", inst);
+			case 4:  return format_string("%08llx", inst);
+			default: return format_string("(invalid)");
+		}
+	}
+
+	static std::string format_effects(trace_record &rec)
+	{
+		std::string op;
+		if (rec.flags & trace_flag_ireg) {
+			op.append(format_string("%s=0x%llx", rv_ireg_name_sym[rec.rd], rec.rd_val));
+		}
+		if (rec.flags & trace_flag_freg) {
+			op.append(format_string("%s=0x%llx", rv_freg_name_sym[rec.rd], rec.rd_val));
+		}
+		if (rec.flags & (trace_flag_load | trace_flag_store)) {
+			if (op.size() > 0) op.append(", ");
+			op.append(format_string("%s%d", rec.flags & trace_flag_store ? "st" : "ld", 8 << rec.width));
+			if (!(rec.flags & trace_flag_noaddr)) {
+				op.append(format_string("[0x%llx]", rec.mem_addr));
+			}
+			if (rec.flags & trace_flag_store) {
+				op.append(format_string("=0x%llx", rec.mem_val));
+			}
+		}
+		return op;
+	}
+
+	int run()
+	{
+		static const char *fmt_32 = "%019llu %08llx (%s) %-30s %s\n";
+		static const char *fmt_64 = "%019llu %016llx (%s) %-30s %s\n";
+
+		trace_reader reader;
+		trace_record rec;
+		if (!reader.open(filename)) {
+			panic("rv-trace: invalid trace file: %s", filename.c_str());
+		}
+		reader.seek(start);
+		while (count > 0 && reader.next(rec)) {
+			if (rec.instret < start || rec.pc < pc_begin || rec.pc >= pc_end) continue;
+			disasm dec;
+			dec.pc = rec.pc;
+			dec.inst = rec.inst;
+			if (reader.hdr.xlen == 32) decode_inst_rv32(dec, dec.inst);
+			else decode_inst_rv64(dec, dec.inst);
+			if (decode_pseudo) decode_pseudo_inst(dec);
+			std::string args = disasm_inst_simple(dec);
+			std::string effects = operands ? format_effects(rec) : std::string();
+			printf(reader.hdr.xlen == 32 ? fmt_32 : fmt_64, rec.instret, rec.pc,
+				format_inst(rec.inst).c_str(), args.c_str(), effects.c_str());
+			count--;
+		}
+		return 0;
+	}
+};
+
+int rv_trace_main(int argc, const char *argv[])
+{
+	rv_trace trace;
+	trace.parse_commandline(argc, argv);
+	return trace.run();
+}
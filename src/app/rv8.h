@@ -3,7 +3,22 @@
 
 #include <functional>
 #include <string>
+#include <sys/uio.h>
 #include "asm/types.h"
+#include "mmio-txn.h"
+
+/*
+ * Each machine is independent; the functions below act on the calling
+ * thread's current machine. emulation_setup creates a machine and makes
+ * it current; a thread pool can create machines with emulation_create
+ * and bind one to a worker with emulation_make_current before use.
+ */
+struct rv8_machine;
+
+rv8_machine *emulation_create(int argc, const char* argv[], const char* envp[]);
+void emulation_destroy(rv8_machine *machine);
+void emulation_make_current(rv8_machine *machine);
+rv8_machine *emulation_current();
 
 int emulation_setup(int argc, const char* argv[], const char* envp[]);
 int emulation_run(size_t count);
@@ -24,7 +39,43 @@ void emulation_set_reg_write_callback(std::function<int (unsigned long long,
 							 unsigned)> fn);
 void emulation_set_reg_read_callback(std::function<int (unsigned long long,
 							unsigned &)> fn);
+
+/*
+ * Word access transfers size bytes as 32-bit words, one per element of
+ * val, through the memory bus so device registers can be reached.
+ * A negative size or a range outside the physical address space
+ * returns -1.
+ */
 int emulation_mem_write(unsigned long long addr, unsigned long *val, int size);
 int emulation_mem_read(unsigned long long addr, unsigned long *val, int size);
 
+/*
+ * Bulk access to guest physical RAM. emulation_mem_map returns a host
+ * pointer if the whole range is contiguous in the host, otherwise null;
+ * emulation_mem_map_iov fills up to iovcnt iovecs and returns the count.
+ * Host pointers stay valid until the machine is destroyed. Both return
+ * -1 (or null) if any part of the range is not main memory. The bytes
+ * functions copy all of len or nothing, and a range within one device
+ * is passed to it as a burst. Code decoded from pages written with the
+ * bytes or word functions is flushed; callers writing guest code through
+ * mapped pointers must call emulation_mem_invalidate for the range.
+ */
+void *emulation_mem_map(unsigned long long addr, size_t len);
+int emulation_mem_map_iov(unsigned long long addr, size_t len, struct iovec *iov, int iovcnt);
+int emulation_mem_write_bytes(unsigned long long addr, const void *buf, size_t len);
+int emulation_mem_read_bytes(unsigned long long addr, void *buf, size_t len);
+void emulation_mem_invalidate(unsigned long long addr, size_t len);
+
+/*
+ * Asynchronous external MMIO. With a batch callback, external device
+ * accesses of any size are queued as transactions and fn is called with
+ * batches in program order on a device thread. Writes are posted and
+ * the hart only waits for reads, which fn completes by setting val (or
+ * filling data) and result. fn must not use the word access functions.
+ * ring_size bounds the transactions in flight and must be a power of
+ * two. An empty fn delivers queued writes and returns to the register
+ * callbacks.
+ */
+void emulation_set_mmio_batch_callback(riscv::mmio_txn_batch_fn fn, size_t ring_size = 1024);
+
 #endif
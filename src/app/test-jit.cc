@@ -27,6 +27,8 @@
 #include <deque>
 #include <map>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <type_traits>
 
@@ -70,6 +72,8 @@
 #include "amo.h"
 #include "processor-logging.h"
 #include "processor-base.h"
+#include "queue.h"
+#include "processor-trace.h"
 #include "processor-impl.h"
 #include "interp.h"
 #include "processor-model.h"
@@ -79,6 +83,7 @@
 #include "processor-histogram.h"
 #include "processor-proxy.h"
 #include "debug-cli.h"
+#include "processor-block-cache.h"
 
 #include "asmjit.h"
 
@@ -88,6 +93,8 @@
 #include "jit-fusion.h"
 #include "jit-tracer.h"
 #include "jit-regalloc.h"
+#include "jit-hotspot.h"
+#include "jit-trace-store.h"
 #include "jit-runloop.h"
 
 #include "assembler.h"
@@ -17,8 +17,12 @@
 #include <vector>
 #include <limits>
 #include <map>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
 
 #include <sys/mman.h>
+#include <sys/uio.h>
 
 #include "host-endian.h"
 #include "types.h"
@@ -40,6 +44,14 @@
 
 using namespace riscv;
 
+struct rom_segment : memory_segment<u64>
+{
+	rom_segment(u64 mpa) : memory_segment<u64>("ROM", mpa, /*uva*/0, page_size,
+		pma_type_main | pma_prot_read | pma_prot_execute) {}
+
+	buserror_t load_16(addr_t va, u16 &val) { val = u16(mpa + va); return 0; }
+};
+
 int main(int argc, char *argv[])
 {
 	assert(page_shift == 12);
@@ -81,12 +93,63 @@ int main(int argc, char *argv[])
 	// test that invalid_ppn is returned for (PDID=0, ASID=1, VA=0x11000)
 	assert(mmu.l1_dtlb.lookup(/* PDID */ 0, /* ASID */ 1, /* VA */ 0x10000) == nullptr);
 
+	// host lookups only hit once an access tag for the privilege context is cached
+	u8 page[page_size];
+	assert(mmu.l1_dtlb.lookup_host(0, 0, 0x10008, /* ctx */ 1, false) == 0);
+	tlb_ent->uva = addr_t(page);
+	tlb_ent->rtag = tlb_type::access_tag(0x10000, /* ctx */ 1);
+	assert(mmu.l1_dtlb.lookup_host(0, 0, 0x10008, /* ctx */ 1, false) == addr_t(page) + 8);
+	assert(mmu.l1_dtlb.lookup_host(0, 0, 0x10008, /* ctx */ 1, true) == 0);
+	assert(mmu.l1_dtlb.lookup_host(0, 0, 0x10008, /* ctx */ 0, false) == 0);
+	assert(mmu.l1_dtlb.lookup_host(0, 1, 0x10008, /* ctx */ 1, false) == 0);
+
+	// dropping the write tags of a code page sends stores to the slow path
+	tlb_ent->wtag = tlb_type::access_tag(0x10000, /* ctx */ 1);
+	assert(mmu.l1_dtlb.lookup_host(0, 0, 0x10008, /* ctx */ 1, true) == addr_t(page) + 8);
+	mmu.l1_dtlb.clear_wtag(addr_t(page));
+	assert(mmu.l1_dtlb.lookup_host(0, 0, 0x10008, /* ctx */ 1, true) == 0);
+	assert(mmu.l1_dtlb.lookup_host(0, 0, 0x10008, /* ctx */ 1, false) == addr_t(page) + 8);
+
 	// flush the L1 DTLB
 	mmu.l1_dtlb.flush(0);
+	assert(mmu.l1_dtlb.lookup_host(0, 0, 0x10008, /* ctx */ 1, false) == 0);
 
 	// test that invalid_ppn is returned for (VA=0x10000, ASID=0)
 	assert(mmu.l1_dtlb.lookup(/* PDID */ 0, /* ASID */ 0, /* VA */ 0x10000) == nullptr);
 
+	// ASID flushes only invalidate entries for that ASID
+	mmu.l1_dtlb.insert(0, /* ASID */ 1, 0x10000, 0, 0xff, 0x1);
+	mmu.l1_dtlb.insert(0, /* ASID */ 2, 0x20000, 0, 0xff, 0x2);
+	mmu.l1_dtlb.flush(0, 1);
+	assert(mmu.l1_dtlb.lookup(0, 1, 0x10000) == nullptr);
+	assert(mmu.l1_dtlb.lookup(0, 2, 0x20000) != nullptr);
+
+	// entries inserted after a flush are valid
+	mmu.l1_dtlb.insert(0, /* ASID */ 1, 0x10000, 0, 0xff, 0x1);
+	assert(mmu.l1_dtlb.lookup(0, 1, 0x10000) != nullptr);
+
+	// VA flushes only invalidate the entry for that VA
+	mmu.l1_dtlb.flush(0, 1, 0x10000);
+	assert(mmu.l1_dtlb.lookup(0, 1, 0x10000) == nullptr);
+	assert(mmu.l1_dtlb.lookup(0, 2, 0x20000) != nullptr);
+
+	// VA flushes within a superpage mapping flush the PDID
+	mmu.l1_dtlb.add_superpage(0, 0x40200000, 21);
+	mmu.l1_dtlb.flush(0, 1, 0x40300000);
+	assert(mmu.l1_dtlb.lookup(0, 2, 0x20000) == nullptr);
+
+	// insert a 2 MiB megapage for VA 0x40200000 into the superpage TLB (shift 21, level 1)
+	mmu.l2_stlb.insert(/* PDID */ 0, /* ASID */ 0, /* VA */ 0x40200000, /* shift */ 21, /* PTE level */ 1, /* PTE.bits */ 0xff, /* PPN */ 0x80200);
+	assert(mmu.l2_stlb.lookup(0, 0, 0x403ff008) != nullptr);
+	assert(mmu.l2_stlb.lookup(0, 0, 0x403ff008)->ppn == 0x80200);
+	assert(mmu.l2_stlb.lookup(0, 0, 0x40400000) == nullptr);
+	assert(mmu.l2_stlb.lookup(0, 1, 0x40200000) == nullptr);
+	assert(mmu.l2_stlb.hits == 2 && mmu.l2_stlb.misses == 2);
+
+	// flush the superpage TLB for ASID 0
+	mmu.l2_stlb.flush(0, 0);
+	assert(mmu.l2_stlb.lookup(0, 0, 0x40200000) == nullptr);
+
 	// add RAM to the MMU emulation (exclude zero page)
 	mmu.mem->add_ram(0x1000, /*1GB*/0x40000000LL - 0x1000);
 
@@ -95,4 +158,61 @@ int main(int argc, char *argv[])
 	addr_t uva = mmu.mem->mpa_to_uva(segment, 0x1000);
 	assert(segment);
 	assert(uva == mmu.mem->segments.front()->uva + 0x0LL);
+
+	// segments added earlier take precedence over overlapping later segments
+	u64 elf_buf[1024];
+	user_memory<u64> mem;
+	mem.add_mmap(0x80001000, addr_t(elf_buf), sizeof(elf_buf), pma_type_main | pma_prot_read);
+	mem.add_ram(0x80000000, 0x10000);
+	addr_t ram_uva = mem.segments.back()->uva;
+	assert(mem.segment_index.size() == 3);
+	assert(mem.mpa_to_uva(segment, 0x80000000) == ram_uva);
+	assert(mem.mpa_to_uva(segment, 0x80001008) == addr_t(elf_buf) + 8);
+	assert(segment == mem.segments.front().get());
+	assert(mem.mpa_to_uva(segment, 0x80003000) == ram_uva + 0x3000);
+	assert(mem.mpa_to_uva(segment, 0x8000ffff) == ram_uva + 0xffff);
+	segment = nullptr;
+	assert(mem.mpa_to_uva(segment, 0x80010000) == 0 && segment == nullptr);
+
+	// a segment ending at the top of the address space does not wrap
+	mem.add_mmap(u64(-4096), addr_t(elf_buf), sizeof(elf_buf) >> 1, pma_type_io);
+	assert(mem.mpa_to_uva(segment, u64(-1)) == addr_t(elf_buf) + 4095);
+	segment = nullptr;
+	assert(mem.mpa_to_uva(segment, 0) == 0 && segment == nullptr);
+
+	// main memory resolves to a host pointer, IO and unmapped addresses do not
+	assert(mem.mpa_to_host<u64>(0x80001008) == elf_buf + 1);
+	assert(mem.mpa_to_host<u32>(0x80003000) == (u32*)(ram_uva + 0x3000));
+	assert(mem.mpa_to_host<u8>(u64(-1)) == nullptr);
+	assert(mem.mpa_to_host<u8>(0x80010000) == nullptr);
+
+	// ranges spanning segments resolve to one iovec per host range
+	struct iovec iov[3];
+	assert(mem.mpa_to_iovec(0x80000ff8, 0x2010, iov, 3) == 3);
+	assert(iov[0].iov_base == (void*)(ram_uva + 0xff8) && iov[0].iov_len == 8);
+	assert(iov[1].iov_base == (void*)elf_buf && iov[1].iov_len == sizeof(elf_buf));
+	assert(iov[2].iov_base == (void*)(ram_uva + 0x3000) && iov[2].iov_len == 8);
+	assert(mem.mpa_to_iovec(0x80000ff8, 0x2010, iov, 2) == -1);
+	assert(mem.mpa_to_iovec(0x8000fff8, 16, iov, 3) == -1);
+	assert(mem.mpa_to_iovec(u64(-8), 8, iov, 3) == -1);
+
+	// bulk copies are bounds checked and all or nothing
+	u8 src[32], dst[32];
+	for (size_t i = 0; i < sizeof(src); i++) src[i] = u8(i + 1);
+	assert(mem.copy_to_mpa(0x80000ff0, src, sizeof(src)) == 0);
+	assert(*(u8*)(ram_uva + 0xff0) == 1 && ((u8*)elf_buf)[0] == 17);
+	memset(dst, 0, sizeof(dst));
+	assert(mem.copy_from_mpa(dst, 0x80000ff0, sizeof(dst)) == 0);
+	assert(memcmp(src, dst, sizeof(src)) == 0);
+	assert(mem.copy_to_mpa(0x8000fff0, src, sizeof(src)) == -1);
+	assert(*(u8*)(ram_uva + 0xfff0) == 0);
+
+	// ROM devices are main memory without a host mapping and use the memory bus
+	auto rom = std::make_shared<rom_segment>(0x1000);
+	mem.add_segment(rom);
+	u16 half = 0;
+	assert(mem.mpa_to_host<u16>(0x1004) == nullptr);
+	assert(mem.mpa_to_iovec(0x1000, 16, iov, 3) == -1);
+	assert(mem.load_16(0x1004, half) == 0 && half == 0x1004);
+	assert(mem.store_16(0x1004, half) == -1);
 }
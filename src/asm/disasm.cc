@@ -60,7 +60,7 @@ static const void sprintf_pad(size_t &offset, std::string &buf, size_t pad_to, c
 }
 
 static const void sprintf_addr(size_t &offset, std::string &buf, addr_t addr,
-	riscv::symbol_name_fn symlookup, riscv::symbol_colorize_fn colorize)
+	const riscv::symbol_name_fn &symlookup, const riscv::symbol_colorize_fn &colorize)
 {
 	sprintf_pad(offset, buf, 80);
 	sprintf(buf, colorize("address"));
@@ -79,14 +79,22 @@ static const void sprintf_addr(size_t &offset, std::string &buf, addr_t addr,
 void riscv::disasm_inst_print(disasm &dec, std::deque<disasm> &dec_hist,
 	addr_t pc, addr_t pc_bias, addr_t gp,
 	riscv::symbol_name_fn symlookup, riscv::symbol_colorize_fn colorize)
+{
+	std::string buf;
+	buf.reserve(256);
+	disasm_inst_format(buf, dec, dec_hist, pc, pc_bias, gp, symlookup, colorize);
+	fputs(buf.c_str(), stdout);
+}
+
+void riscv::disasm_inst_format(std::string &buf, disasm &dec, std::deque<disasm> &dec_hist,
+	addr_t pc, addr_t pc_bias, addr_t gp,
+	const riscv::symbol_name_fn &symlookup, const riscv::symbol_colorize_fn &colorize)
 {
 	size_t offset = 0;
 	addr_t addr = pc - pc_bias;
 	const char *fmt = rv_inst_format[dec.op];
 	const char *symbol_name = symlookup((addr_t)addr, false);
 	const char* csr_name = nullptr;
-	std::string buf;
-	buf.reserve(256);
 
 	// print symbol name if present
 	if (symbol_name) {
@@ -194,8 +202,13 @@ void riscv::disasm_inst_print(disasm &dec, std::deque<disasm> &dec_hist,
 
 	// print address if present
 	if (decoded_address) sprintf_addr(offset, buf, addr, symlookup, colorize);
-	printf("%s\n", buf.c_str());
+	buf += "\n";
 
+	disasm_inst_history(dec, dec_hist);
+}
+
+void riscv::disasm_inst_history(disasm &dec, std::deque<disasm> &dec_hist)
+{
 	// clear the instruction history on jump boundaries
 	switch(dec.op) {
 		case rv_op_jal:
@@ -201,6 +201,15 @@ namespace riscv {
 		symbol_name_fn symlookup = null_symbol_lookup,
 		symbol_colorize_fn colorize = null_symbol_colorize);
 
+	/* append the formatted instruction and a newline to buf */
+	void disasm_inst_format(std::string &buf, disasm &dec, std::deque<disasm> &dec_hist,
+		addr_t pc, addr_t pc_bias, addr_t gp,
+		const symbol_name_fn &symlookup = null_symbol_lookup,
+		const symbol_colorize_fn &colorize = null_symbol_colorize);
+
+	/* add an instruction to the history used to decode address pairs */
+	void disasm_inst_history(disasm &dec, std::deque<disasm> &dec_hist);
+
 }
 
 #endif
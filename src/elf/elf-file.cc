@@ -10,10 +10,15 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <functional>
 
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 
+#include "host-endian.h"
 #include "elf.h"
 #include "elf-file.h"
 #include "elf-format.h"
@@ -43,6 +48,7 @@ void elf_file::clear()
 	shstrtab = symtab = strtab = 0;
 	sections.resize(0);
 	relocations.resize(0);
+	file_map.reset();
 }
 
 void elf_file::init_object(int ei_class)
@@ -100,6 +106,7 @@ size_t elf_file::add_symbol(std::string name, Elf32_Word st_bind, Elf32_Word st_
 	Elf64_Byte st_other, Elf64_Half st_shndx, Elf64_Addr st_value)
 {
 	if (!symtab || !strtab) return 0;
+	sections[strtab].unmap();
 	Elf64_Word st_name = sections[strtab].buf.size();
 	std::copy(name.c_str(), name.c_str() + name.length(),
 		std::back_inserter(sections[strtab].buf));
@@ -138,9 +145,19 @@ size_t elf_file::section_num(std::string section_name)
 	else return SHN_UNDEF;
 }
 
+/* sections in host byte order are used in place, others are copied and swapped */
+static bool elf_host_data(int ei_data)
+{
+#if BYTE_ORDER == LITTLE_ENDIAN
+	return ei_data == ELFDATA2LSB;
+#else
+	return ei_data == ELFDATA2MSB;
+#endif
+}
+
 void elf_file::load(std::string filename, elf_load load_type)
 {
-	FILE *file;
+	int fd;
 	struct stat stat_buf;
 	std::vector<uint8_t> buf;
 	std::vector<std::pair<size_t,size_t>> bounds;
@@ -150,79 +167,82 @@ void elf_file::load(std::string filename, elf_load load_type)
 
 	// open file
 	this->filename = filename;
-	file = fopen(filename.c_str(), "r");
-	if (!file) {
-		panic("error fopen: %s: %s", filename.c_str(), strerror(errno));
+	fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		panic("error open: %s: %s", filename.c_str(), strerror(errno));
 	}
 
 	// check file length
-	if (fstat(fileno(file), &stat_buf) < 0) {
-		fclose(file);
+	if (fstat(fd, &stat_buf) < 0) {
+		close(fd);
 		panic("error fstat: %s: %s", filename.c_str(), strerror(errno));
 	}
-
-	// read file magic
 	if (stat_buf.st_size < EI_NIDENT) {
-		fclose(file);
+		close(fd);
 		panic("error invalid ELF file: %s", filename.c_str());
 	}
 	filesize = stat_buf.st_size;
-	buf.resize(EI_NIDENT);
-	size_t bytes_read = fread(buf.data(), 1, EI_NIDENT, file);
-	if (bytes_read != EI_NIDENT || !elf_check_magic(buf.data())) {
-		fclose(file);
+
+	// map file read only, pages are only read in when used
+	void *addr = mmap(nullptr, filesize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		panic("error mmap: %s: %s", filename.c_str(), strerror(errno));
+	}
+	size_t map_size = filesize;
+	file_map = std::shared_ptr<uint8_t>((uint8_t*)addr,
+		[map_size](uint8_t *p) { munmap(p, map_size); });
+	const uint8_t *base = file_map.get();
+	auto read_at = [&](uint64_t offset, size_t size) {
+		if (offset > (uint64_t)filesize || size > (uint64_t)filesize - offset) {
+			panic("error read: %s", filename.c_str());
+		}
+		buf.assign(base + offset, base + offset + size);
+	};
+
+	// read file magic
+	read_at(0, EI_NIDENT);
+	if (!elf_check_magic(buf.data())) {
 		panic("error invalid ELF magic: %s", filename.c_str());
 	}
 	ei_class = buf[EI_CLASS];
 	ei_data = buf[EI_DATA];
 
 	// read, byteswap and normalize file header
-	switch (ei_class) {
-		case ELFCLASS32: buf.resize(sizeof(Elf32_Ehdr)); break;
-		case ELFCLASS64: buf.resize(sizeof(Elf64_Ehdr)); break;
-		default:
-			fclose(file);
-			panic("error invalid ELF class: %s", filename.c_str());
-	}
-	fseek(file, 0, SEEK_SET);
-	if (fread(buf.data(), 1, buf.size(), file) != buf.size()) {
-		fclose(file);
-		panic("error fread: %s", filename.c_str());
-	}
 	uint64_t phdr_end = 0, shdr_end = 0;
 	switch (ei_class) {
 		case ELFCLASS32:
+			read_at(0, sizeof(Elf32_Ehdr));
 			elf_bswap_ehdr32((Elf32_Ehdr*)buf.data(), ei_data, ELFENDIAN_HOST);
 			elf_ehdr32_to_ehdr64(&ehdr, (Elf32_Ehdr*)buf.data());
 			phdr_end = ehdr.e_phoff + ehdr.e_phnum * sizeof(Elf32_Phdr);
 			shdr_end = ehdr.e_shoff + ehdr.e_shnum * sizeof(Elf32_Shdr);
 			break;
 		case ELFCLASS64:
+			read_at(0, sizeof(Elf64_Ehdr));
 			elf_bswap_ehdr64((Elf64_Ehdr*)buf.data(), ei_data, ELFENDIAN_HOST);
 			memcpy(&ehdr, (Elf64_Ehdr*)buf.data(), sizeof(Elf64_Ehdr));
 			phdr_end = ehdr.e_phoff + ehdr.e_phnum * sizeof(Elf64_Phdr);
 			shdr_end = ehdr.e_shoff + ehdr.e_shnum * sizeof(Elf64_Shdr);
 			break;
+		default:
+			panic("error invalid ELF class: %s", filename.c_str());
 	}
 
 	if (load_type == elf_load_exec) {
-		fclose(file);
 		return;
 	}
 
 	// check program and section header offsets are within the file size
 	if (phdr_end > (uint64_t)stat_buf.st_size) {
-		fclose(file);
 		panic("program header offset %ld > %d range: %s",
 			phdr_end, stat_buf.st_size, filename.c_str());
 	}
 	if (shdr_end > (uint64_t)stat_buf.st_size) {
-		fclose(file);
 		panic("section header offset %ld > %d range: %s",
 			shdr_end, stat_buf.st_size, filename.c_str());
 	}
 	if (ehdr.e_phoff < shdr_end && ehdr.e_shoff < phdr_end) {
-		fclose(file);
 		panic("section and program headers overlap: %s",
 			filename.c_str());
 	}
@@ -231,33 +251,22 @@ void elf_file::load(std::string filename, elf_load load_type)
 
 	// check header version
 	if (ehdr.e_version != EV_CURRENT) {
-		fclose(file);
 		panic("error invalid ELF version: %s", filename.c_str());
 	}
 
 	// read, byteswap and normalize program and section headers
 	switch (ei_class) {
 		case ELFCLASS32:
-			buf.resize(sizeof(Elf32_Phdr));
 			for (int i = 0; i < ehdr.e_phnum; i++) {
-				fseek(file, ehdr.e_phoff + i * sizeof(Elf32_Phdr), SEEK_SET);
-				if (fread(buf.data(), 1, buf.size(), file) != buf.size()) {
-					fclose(file);
-					panic("error fread: %s", filename.c_str());
-				}
+				read_at(ehdr.e_phoff + i * sizeof(Elf32_Phdr), sizeof(Elf32_Phdr));
 				Elf32_Phdr *phdr32 = (Elf32_Phdr*)buf.data();
 				Elf64_Phdr phdr64;
 				elf_bswap_phdr32(phdr32, ei_data, ELFENDIAN_HOST);
 				elf_phdr32_to_phdr64(&phdr64, phdr32);
 				phdrs.push_back(phdr64);
 			}
-			buf.resize(sizeof(Elf32_Shdr));
 			for (int i = 0; i < ehdr.e_shnum; i++) {
-				fseek(file, ehdr.e_shoff + i * sizeof(Elf32_Shdr), SEEK_SET);
-				if (fread(buf.data(), 1, buf.size(), file) != buf.size()) {
-					fclose(file);
-					panic("error fread: %s", filename.c_str());
-				}
+				read_at(ehdr.e_shoff + i * sizeof(Elf32_Shdr), sizeof(Elf32_Shdr));
 				Elf32_Shdr *shdr32 = (Elf32_Shdr*)buf.data();
 				Elf64_Shdr shdr64;
 				elf_bswap_shdr32(shdr32, ei_data, ELFENDIAN_HOST);
@@ -266,24 +275,14 @@ void elf_file::load(std::string filename, elf_load load_type)
 			}
 			break;
 		case ELFCLASS64:
-			buf.resize(sizeof(Elf64_Phdr));
 			for (int i = 0; i < ehdr.e_phnum; i++) {
-				fseek(file, ehdr.e_phoff + i * sizeof(Elf64_Phdr), SEEK_SET);
-				if (fread(buf.data(), 1, buf.size(), file) != buf.size()) {
-					fclose(file);
-					panic("error fread: %s", filename.c_str());
-				}
+				read_at(ehdr.e_phoff + i * sizeof(Elf64_Phdr), sizeof(Elf64_Phdr));
 				Elf64_Phdr *phdr64 = (Elf64_Phdr*)buf.data();
 				elf_bswap_phdr64(phdr64, ei_data, ELFENDIAN_HOST);
 				phdrs.push_back(*phdr64);
 			}
-			buf.resize(sizeof(Elf64_Shdr));
 			for (int i = 0; i < ehdr.e_shnum; i++) {
-				fseek(file, ehdr.e_shoff + i * sizeof(Elf64_Shdr), SEEK_SET);
-				if (fread(buf.data(), 1, buf.size(), file) != buf.size()) {
-					fclose(file);
-					panic("error fread: %s", filename.c_str());
-				}
+				read_at(ehdr.e_shoff + i * sizeof(Elf64_Shdr), sizeof(Elf64_Shdr));
 				Elf64_Shdr *shdr64 = (Elf64_Shdr*)buf.data();
 				elf_bswap_shdr64(shdr64, ei_data, ELFENDIAN_HOST);
 				shdrs.push_back(*shdr64);
@@ -294,21 +293,13 @@ void elf_file::load(std::string filename, elf_load load_type)
 	// Find interp
 	for (size_t i = 0; i < phdrs.size(); i++) {
 		if (phdrs[i].p_type == PT_INTERP) {
-			size_t size = phdrs[i].p_filesz;
-			size_t offset = phdrs[i].p_offset;
-			interp.clear();
-			interp.insert(0, size, 0);
-			fseek(file, offset, SEEK_SET);
-			if (fread((void*)interp.data(), 1, size, file) != size) {
-				fclose(file);
-				panic("error fread: %s", filename.c_str());
-			}
+			read_at(phdrs[i].p_offset, phdrs[i].p_filesz);
+			interp.assign(buf.begin(), buf.end());
 			break;
 		}
 	}
 
 	if (load_type == elf_load_headers) {
-		fclose(file);
 		return;
 	}
 
@@ -329,7 +320,7 @@ void elf_file::load(std::string filename, elf_load load_type)
 		}
 	}
 
-	// read section data into buffers
+	// point sections into the mapped file
 	sections.resize(shdrs.size());
 	for (size_t i = 0; i < shdrs.size(); i++) {
 		uint64_t section_end = shdrs[i].sh_offset + shdrs[i].sh_size;
@@ -338,25 +329,20 @@ void elf_file::load(std::string filename, elf_load load_type)
 		if (shdrs[i].sh_type == SHT_NOBITS) continue;
 		for (auto &bound : bounds) {
 			if (shdrs[i].sh_offset < bound.second && bound.first < section_end) {
-				fclose(file);
 				panic("section %d overlap: %s",
 					i, filename.c_str());
 			}
 		}
 		if (shdrs[i].sh_offset + shdrs[i].sh_size > (uint64_t)stat_buf.st_size) {
-			fclose(file);
 			panic("section offset %ld > %d range: %s",
 				section_end, stat_buf.st_size, filename.c_str());
 		}
-		fseek(file, shdrs[i].sh_offset, SEEK_SET);
-		sections[i].buf.resize(shdrs[i].sh_size);
-		if (fread(sections[i].buf.data(), 1, shdrs[i].sh_size, file) != shdrs[i].sh_size) {
-			fclose(file);
-			panic("error fread: %s", filename.c_str());
+		sections[i].map = (uint8_t*)base + shdrs[i].sh_offset;
+		if (!elf_host_data(ei_data)) {
+			sections[i].unmap();
 		}
 		bounds.push_back(std::pair<size_t,size_t>(shdrs[i].sh_offset, section_end));
 	}
-	fclose(file);
 	buf.resize(0);
 
 	// byteswap symbol table
@@ -472,7 +458,7 @@ void elf_file::save(std::string filename)
 	for (size_t i = 0; i < sections.size(); i++) {
 		if (shdrs[i].sh_type == SHT_NOBITS) continue;
 		fseek(file, shdrs[i].sh_offset, SEEK_SET);
-		if (fwrite(sections[i].buf.data(), 1, shdrs[i].sh_size, file) != shdrs[i].sh_size) {
+		if (fwrite(sections[i].data(), 1, shdrs[i].sh_size, file) != shdrs[i].sh_size) {
 			fclose(file);
 			panic("error fwrite: %s", filename.c_str());
 		}
@@ -486,7 +472,7 @@ void elf_file::save(std::string filename)
 
 void elf_file::byteswap_symbol_table(ELFENDIAN endian)
 {
-	if (symtab == 0) return;
+	if (symtab == 0 || elf_host_data(ei_data)) return;
 
 	size_t num_symbols = shdrs[symtab].sh_size / shdrs[symtab].sh_entsize;
 	switch (ei_class) {
@@ -518,6 +504,7 @@ void elf_file::copy_to_section_names()
 {
 	if (shstrtab == 0) return;
 
+	sections[shstrtab].unmap();
 	sections[shstrtab].buf.clear();
 	for (size_t i = 0; i < sections.size(); i++) {
 		std::string name = sections[i].name;
@@ -573,6 +560,7 @@ void elf_file::copy_to_symbol_table_sections()
 	if (symtab == 0) return;
 
 	elf_section &symtab_section = sections[symtab];
+	symtab_section.unmap();
 
 	// set sh_info to index of first global symbol
 	for (size_t i = 0; i < symbols.size(); i++) {
@@ -608,14 +596,15 @@ void elf_file::copy_from_relocation_table_sections()
 				Elf64_Shdr &shdr = shdrs[i];
 				if (shdr.sh_type & SHT_RELA) {
 					rela_text = i;
-					size_t length = sections[i].buf.size();
-					Elf32_Rela *rela = (Elf32_Rela*)sections[i].buf.data();
+					size_t length = sections[i].length();
+					Elf32_Rela *rela = (Elf32_Rela*)sections[i].data();
 					Elf32_Rela *rela_end = (Elf32_Rela*)((uint8_t*)rela + length);
 					relocations.clear();
 					while (rela < rela_end) {
-						elf_bswap_rela32(rela, ei_data, ELFENDIAN_HOST);
+						Elf32_Rela rela32 = *rela;
+						elf_bswap_rela32(&rela32, ei_data, ELFENDIAN_HOST);
 						Elf64_Rela rela64;
-						elf_rela32_to_rela64(&rela64, rela);
+						elf_rela32_to_rela64(&rela64, &rela32);
 						relocations.push_back(rela64);
 						rela++;
 					}
@@ -627,13 +616,14 @@ void elf_file::copy_from_relocation_table_sections()
 				Elf64_Shdr &shdr = shdrs[i];
 				if (shdr.sh_type & SHT_RELA) {
 					rela_text = i;
-					size_t length = sections[i].buf.size();
-					Elf64_Rela *rela = (Elf64_Rela*)sections[i].buf.data();
+					size_t length = sections[i].length();
+					Elf64_Rela *rela = (Elf64_Rela*)sections[i].data();
 					Elf64_Rela *rela_end = (Elf64_Rela*)((uint8_t*)rela + length);
 					relocations.clear();
 					while (rela < rela_end) {
-						elf_bswap_rela64(rela, ei_data, ELFENDIAN_HOST);
-						relocations.push_back(*rela);
+						Elf64_Rela rela64 = *rela;
+						elf_bswap_rela64(&rela64, ei_data, ELFENDIAN_HOST);
+						relocations.push_back(rela64);
 						rela++;
 					}
 				}
@@ -650,6 +640,7 @@ void elf_file::copy_to_relocation_table_sections()
 		case ELFCLASS32: {
 			shdrs[rela_text].sh_entsize = sizeof(Elf32_Rela);
 			shdrs[rela_text].sh_size = sizeof(Elf32_Rela) * relocations.size();
+			sections[rela_text].unmap();
 			sections[rela_text].buf.resize(shdrs[rela_text].sh_size);
 			Elf32_Rela *rela = (Elf32_Rela*)sections[rela_text].buf.data();
 			for (size_t j = 0; j < relocations.size(); j++) {
@@ -661,6 +652,7 @@ void elf_file::copy_to_relocation_table_sections()
 		case ELFCLASS64: {
 			shdrs[rela_text].sh_entsize = sizeof(Elf64_Rela);
 			shdrs[rela_text].sh_size = sizeof(Elf64_Rela) * relocations.size();
+			sections[rela_text].unmap();
 			sections[rela_text].buf.resize(shdrs[rela_text].sh_size);
 			Elf64_Rela *rela = (Elf64_Rela*)sections[rela_text].buf.data();
 			for (size_t j = 0; j < relocations.size(); j++) {
@@ -709,7 +701,7 @@ void elf_file::recalculate_section_offsets()
 		sections[i].offset = next_offset;
 		shdrs[i].sh_offset = i == 0 ? 0 : next_offset;
 		if (shdrs[i].sh_type != SHT_NOBITS) {
-			sections[i].size = sections[i].buf.size();
+			sections[i].size = sections[i].length();
 		}
 		shdrs[i].sh_size = sections[i].size;
 		next_offset += shdrs[i].sh_size;
@@ -729,8 +721,8 @@ void elf_file::recalculate_section_offsets()
 uint8_t* elf_file::offset(size_t offset)
 {
 	for (size_t i = 0; i < sections.size(); i++) {
-		if (offset >= sections[i].offset && offset < sections[i].offset + sections[i].buf.size()) {
-			return sections[i].buf.data() + (offset - sections[i].offset);
+		if (offset >= sections[i].offset && offset < sections[i].offset + sections[i].length()) {
+			return sections[i].data() + (offset - sections[i].offset);
 		}
 	}
 	panic("illegal offset: %lu", offset);
@@ -740,7 +732,7 @@ uint8_t* elf_file::offset(size_t offset)
 elf_section* elf_file::section(size_t offset)
 {
 	for (size_t i = 0; i < sections.size(); i++) {
-		if (offset >= sections[i].offset && offset < sections[i].offset + sections[i].buf.size()) {
+		if (offset >= sections[i].offset && offset < sections[i].offset + sections[i].length()) {
 			return &sections[i];
 		}
 	}
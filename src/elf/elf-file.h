@@ -9,12 +9,24 @@ struct cmp_str {
 	bool operator()(char const *a, char const *b) const { return std::strcmp(a, b) < 0; }
 };
 
+/* section data is a view into the mapped file until it is modified */
 struct elf_section
 {
 	std::string name;
 	size_t offset;
 	size_t size;
 	std::vector<uint8_t> buf;
+	uint8_t *map = nullptr;
+
+	uint8_t* data() { return map ? map : buf.data(); }
+	size_t length() { return map ? size : buf.size(); }
+
+	void unmap()
+	{
+		if (!map) return;
+		buf.assign(map, map + size);
+		map = nullptr;
+	}
 };
 
 enum elf_load
@@ -40,6 +52,7 @@ struct elf_file
 	std::map<Elf64_Addr,size_t> addr_symbol_map;
 	std::map<const char*,size_t,cmp_str> name_symbol_map;
 	std::vector<elf_section> sections;
+	std::shared_ptr<uint8_t> file_map;
 
 	size_t text;
 	size_t rela_text;
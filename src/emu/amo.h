@@ -61,6 +61,22 @@ namespace riscv {
 		}
 		return 0;
 	}
+
+	/* AMO on host memory using host atomics, returns the previous value */
+	template <typename T> T amo_atomic(amo_op op, T *addr, T val) {
+		switch (op) {
+			case amoswap: return __atomic_exchange_n(addr, val, __ATOMIC_SEQ_CST);
+			case amoadd:  return __atomic_fetch_add(addr, val, __ATOMIC_SEQ_CST);
+			case amoxor:  return __atomic_fetch_xor(addr, val, __ATOMIC_SEQ_CST);
+			case amoor:   return __atomic_fetch_or (addr, val, __ATOMIC_SEQ_CST);
+			case amoand:  return __atomic_fetch_and(addr, val, __ATOMIC_SEQ_CST);
+			default: break;
+		}
+		T old = __atomic_load_n(addr, __ATOMIC_RELAXED);
+		while (!__atomic_compare_exchange_n(addr, &old, amo_fn<T>(op, old, val), true,
+			__ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+		return old;
+	}
 }
 
 #endif
@@ -9,121 +9,252 @@
 
 namespace riscv {
 
-	/* EXTERNAL MMIO device */
+	/*
+	 * EXTERNAL MMIO device
+	 *
+	 * By default 32-bit accesses call the register callbacks on the
+	 * hart's thread. With a batch callback, accesses of every size and
+	 * bursts are queued as mmio_txn in program order and handed to the
+	 * callback in batches on a device thread. Writes are posted; the
+	 * hart only waits for reads to complete, which also orders them
+	 * after earlier writes.
+	 */
 
 	template <typename P>
 	struct external_mmio_device : memory_segment<typename P::ux>
 	{
 		typedef typename P::ux UX;
 
+		enum {
+			total_size = sizeof(u32) * 4096,
+			batch_max = 64
+		};
+
+		struct txn_slot
+		{
+			mmio_txn txn;
+			std::vector<u8> buf;           /* copy of posted burst data */
+			bool done;
+		};
+
 		P &proc;
-		
+
 		std::function<int (unsigned long long addr,
 				   unsigned val)> reg_write_cb_fn;
 		std::function<int (unsigned long long addr,
 				   unsigned &val)> reg_read_cb_fn;
-		
-		enum {
-			total_size = sizeof(u32) * 4096
-		};
+
+		/* asynchronous mode */
+		mmio_txn_batch_fn batch_fn;
+		std::vector<txn_slot> slots;
+		std::unique_ptr<queue_atomic<txn_slot*>> pending_queue;
+		std::unique_ptr<queue_atomic<txn_slot*>> free_queue;
+		std::mutex mutex;
+		std::condition_variable pending_cond;
+		std::condition_variable done_cond;
+		std::atomic<bool> idle;
+		std::atomic<bool> running;
+		std::atomic<u64> write_errors;
+		std::thread thread;
 
 		/* MIPI constructor */
 
 	external_mmio_device(P &proc, UX mpa):
 			memory_segment<UX>("EXTERNAL", mpa, /*uva*/0, /*size*/total_size,
 				pma_type_io | pma_prot_read | pma_prot_write),
-			proc(proc)
+			proc(proc), idle(false), running(false), write_errors(0)
 			{
 			    reg_write_cb_fn = NULL;
 			}
 
-#if 0			
-		buserror_t load_8 (addr_t va, u8  &val)
+		~external_mmio_device()
 		{
-			val = (va < total_size) ? *(as_u8() + va) : 0;
-			if (proc.log & proc_log_mmio) {
-				printf("external_mmio:0x%04llx -> 0x%02hhx\n", addr_t(va), val);
+			stop_async();
+		}
+
+		/* start queueing transactions, ring_size bounds the transactions in flight */
+		void start_async(mmio_txn_batch_fn fn, size_t ring_size)
+		{
+			stop_async();
+			if (!ispow2(ring_size)) {
+				panic("external_mmio: ring size must be a power of two: %zu", ring_size);
 			}
-			return 0;
+			batch_fn = fn;
+			slots = std::vector<txn_slot>(ring_size);
+			pending_queue.reset(new queue_atomic<txn_slot*>(ring_size));
+			free_queue.reset(new queue_atomic<txn_slot*>(ring_size));
+			for (auto &slot : slots) {
+				free_queue->push_back(&slot);
+			}
+			running.store(true, std::memory_order_release);
+			thread = std::thread(&external_mmio_device::mainloop, this);
 		}
 
-		buserror_t load_16(addr_t va, u16 &val)
+		/* deliver queued transactions and return to the register callbacks */
+		void stop_async()
 		{
-			val = (va < total_size - 1) ? *(as_u16() + (va>>1)) : 0;
-			if (proc.log & proc_log_mmio) {
-				printf("external_mmio:0x%04llx -> 0x%04hx\n", addr_t(va), val);
+			if (!running.load(std::memory_order_acquire)) return;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				running.store(false, std::memory_order_release);
+				pending_cond.notify_one();
 			}
-			return 0;
+			thread.join();
+			batch_fn = mmio_txn_batch_fn();
 		}
-#endif
-		
-		buserror_t load_32(addr_t va, u32 &val)
+
+		txn_slot* alloc_txn()
 		{
-		        buserror_t rv = 1;
-			if (va < (total_size - 3)) {
-			    rv = reg_read_cb_fn(va, val);
+			txn_slot *slot;
+			while (!(slot = free_queue->pop_front())) {
+				std::this_thread::yield();
 			}
-			if (proc.log & proc_log_mmio) {
-				printf("external_mmio:0x%04llx -> 0x%08x\n", addr_t(va), val);
+			slot->done = false;
+			return slot;
+		}
+
+		void post(txn_slot *slot)
+		{
+			pending_queue->push_back(slot);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (idle.load(std::memory_order_relaxed)) {
+				std::lock_guard<std::mutex> lock(mutex);
+				pending_cond.notify_one();
 			}
+		}
+
+		/* post a transaction and wait for the model to complete it */
+		buserror_t complete(txn_slot *slot)
+		{
+			post(slot);
+			std::unique_lock<std::mutex> lock(mutex);
+			done_cond.wait(lock, [&] { return slot->done; });
+			buserror_t rv = slot->txn.result;
+			lock.unlock();
 			return rv;
 		}
 
-#if 0		
-		buserror_t load_64(addr_t va, u64 &val)
+		void mainloop()
 		{
-			val = (va < total_size - 7) ? *(as_u64() + (va>>3)) : 0;
-			if (proc.log & proc_log_mmio) {
-				printf("external_mmio:0x%04llx -> 0x%016llx\n", addr_t(va), val);
+			sigset_t set;
+			sigfillset(&set);
+			if (pthread_sigmask(SIG_BLOCK, &set, NULL) != 0) {
+				panic("external_mmio: can't set thread signal mask: %s", strerror(errno));
+			}
+			txn_slot *batch[batch_max];
+			mmio_txn *txns[batch_max];
+			for (;;) {
+				size_t n = 0;
+				while (n < batch_max && (batch[n] = pending_queue->pop_front())) {
+					txns[n] = &batch[n]->txn;
+					n++;
+				}
+				if (n == 0) {
+					std::unique_lock<std::mutex> lock(mutex);
+					idle.store(true, std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					if (!running.load(std::memory_order_acquire) && pending_queue->empty()) break;
+					pending_cond.wait(lock, [&] { return !running.load(std::memory_order_acquire) || !pending_queue->empty(); });
+					idle.store(false, std::memory_order_relaxed);
+					continue;
+				}
+				batch_fn(txns, n);
+				bool reads = false;
+				for (size_t i = 0; i < n; i++) {
+					if (batch[i]->txn.type == mmio_txn_read) {
+						reads = true;
+					} else {
+						if (batch[i]->txn.result != 0) write_errors++;
+						free_queue->push_back(batch[i]);
+					}
+				}
+				if (reads) {
+					std::lock_guard<std::mutex> lock(mutex);
+					for (size_t i = 0; i < n; i++) {
+						if (batch[i]->txn.type == mmio_txn_read) batch[i]->done = true;
+					}
+					done_cond.notify_all();
+				}
 			}
-			return 0;
 		}
 
-		buserror_t store_8 (addr_t va, u8  val)
+		template <typename T>
+		buserror_t read_reg(addr_t va, T &val)
 		{
+			buserror_t rv = -1;
+			if (va <= total_size - sizeof(T)) {
+				if (running.load(std::memory_order_acquire)) {
+					txn_slot *slot = alloc_txn();
+					slot->txn = mmio_txn{ va, 0, nullptr, sizeof(T), mmio_txn_read, 0 };
+					rv = complete(slot);
+					val = T(slot->txn.val);
+					free_queue->push_back(slot);
+				} else if (sizeof(T) == 4) {
+					unsigned word = 0;
+					rv = reg_read_cb_fn(va, word);
+					val = T(word);
+				}
+			}
 			if (proc.log & proc_log_mmio) {
-				printf("external_mmio:0x%04llx <- 0x%02hhx\n", addr_t(va), val);
+				printf("external_mmio:0x%04llx -> 0x%0*llx\n", addr_t(va), int(sizeof(T) * 2), u64(val));
 			}
-			if (va < total_size) *(as_u8() + va) = val;
-			//trigger();
-			pin_set();
-			return 0;
+			return rv;
 		}
 
-		buserror_t store_16(addr_t va, u16 val)
+		template <typename T>
+		buserror_t write_reg(addr_t va, T val)
 		{
 			if (proc.log & proc_log_mmio) {
-				printf("external_mmio:0x%04llx <- 0x%04hx\n", addr_t(va), val);
+				printf("external_mmio:0x%04llx <- 0x%0*llx\n", addr_t(va), int(sizeof(T) * 2), u64(val));
 			}
-			if (va < total_size - 1) *(as_u16() + (va>>1)) = val;
-			//trigger();
-			pin_set();
-			return 0;
+			if (va > total_size - sizeof(T)) {
+				return -1;
+			}
+			if (running.load(std::memory_order_acquire)) {
+				txn_slot *slot = alloc_txn();
+				slot->txn = mmio_txn{ va, u64(val), nullptr, sizeof(T), mmio_txn_write, 0 };
+				post(slot);
+				return 0;
+			} else if (sizeof(T) == 4) {
+				return reg_write_cb_fn(va, unsigned(val));
+			}
+			return -1;
 		}
-#endif
-		buserror_t store_32(addr_t va, u32 val)
+
+		buserror_t load_8 (addr_t va, u8  &val) { return read_reg(va, val); }
+		buserror_t load_16(addr_t va, u16 &val) { return read_reg(va, val); }
+		buserror_t load_32(addr_t va, u32 &val) { return read_reg(va, val); }
+		buserror_t load_64(addr_t va, u64 &val) { return read_reg(va, val); }
+
+		buserror_t store_8 (addr_t va, u8  val) { return write_reg(va, val); }
+		buserror_t store_16(addr_t va, u16 val) { return write_reg(va, val); }
+		buserror_t store_32(addr_t va, u32 val) { return write_reg(va, val); }
+		buserror_t store_64(addr_t va, u64 val) { return write_reg(va, val); }
+
+		/* bursts are only supported with a batch callback */
+		buserror_t load_bytes(addr_t va, char *bytes, size_t len)
 		{
-			if (proc.log & proc_log_mmio) {
-				printf("external_mmio:0x%04llx <- 0x%08x\n", addr_t(va), val);
+			if (!running.load(std::memory_order_acquire) || va > total_size || len > total_size - va) {
+				return -1;
 			}
-			if (va < (total_size - 3)) {
-			    return reg_write_cb_fn(va, val);
-			}
-			return 1;
+			txn_slot *slot = alloc_txn();
+			slot->txn = mmio_txn{ va, 0, (u8*)bytes, u32(len), mmio_txn_read, 0 };
+			buserror_t rv = complete(slot);
+			free_queue->push_back(slot);
+			return rv;
 		}
-#if 0
-		buserror_t store_64(addr_t va, u64 val)
+
+		buserror_t store_bytes(addr_t va, char *bytes, size_t len)
 		{
-			if (proc.log & proc_log_mmio) {
-				printf("external_mmio:0x%04llx <- 0x%016llx\n", addr_t(va), val);
+			if (!running.load(std::memory_order_acquire) || va > total_size || len > total_size - va) {
+				return -1;
 			}
-			if (va < total_size - 7) *(as_u64() + (va>>3)) = val;
-			//trigger();
-			pin_set();
+			txn_slot *slot = alloc_txn();
+			slot->buf.assign(bytes, bytes + len);
+			slot->txn = mmio_txn{ va, 0, slot->buf.data(), u32(len), mmio_txn_write, 0 };
+			post(slot);
 			return 0;
 		}
-#endif
-
 	};
 
 }
@@ -77,6 +77,12 @@ namespace riscv {
 			debug("gpio_mmio:pull             0x%08x", gpio.pull);
 		}
 
+		template <typename S>
+		void snapshot(S &s)
+		{
+			s.io(gpio);
+		}
+
 		void service()
 		{
 			plic->set_irq(irq, (gpio.ie & gpio.ip) ? 1 : 0);
@@ -106,7 +112,7 @@ namespace riscv {
 		void trigger()
 		{
 			if (gpio.out & OUT_POWER_OFF) {
-				proc.raise(P::internal_cause_poweroff, proc.pc);
+				proc.poweroff();
 			}
 			if (gpio.out & OUT_RESET) {
 				proc.reset();
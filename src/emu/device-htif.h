@@ -47,6 +47,13 @@ namespace riscv {
 			debug("htif_mmio:htif_fromhost    %llu", htif_fromhost);
 		}
 
+		template <typename S>
+		void snapshot(S &s)
+		{
+			s.io(htif_tohost);
+			s.io(htif_fromhost);
+		}
+
 		inline u64 htif_device_command(u8 device, u8 command) {
 			return ((u64)device << 56) | ((u64)command << 48);
 		}
@@ -57,7 +64,7 @@ namespace riscv {
 		void handle_output()
 		{
 			if (htif_tohost == 1) {
-				proc.raise(P::internal_cause_poweroff, proc.pc);
+				proc.poweroff();
 			}
 			u8 device = htif_device(htif_tohost);
 			u8 command = htif_command(htif_tohost);
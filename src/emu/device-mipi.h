@@ -15,9 +15,8 @@ namespace riscv {
 		typedef typename P::ux UX;
 
 		enum {
-			bits_per_word = sizeof(u32) << 3,
 			num_harts = NUM_HARTS,
-			total_size = bits_per_word * num_harts
+			total_size = sizeof(u32) * num_harts
 		};
 
 		P &proc;
@@ -47,16 +46,24 @@ namespace riscv {
 			}
 		}
 
+		template <typename S>
+		void snapshot(S &s)
+		{
+			s.io(hart);
+		}
+
 		void signal_ipi(UX hart_id, u32 value)
 		{
 			if (hart_id >= num_harts) return;
-			hart[num_harts] |= (1ULL << (hart_id & (bits_per_word-1)));
+			__atomic_store_n(&hart[hart_id], value, __ATOMIC_SEQ_CST);
+			proc.wake_harts();
 		}
 
+		/* polled by each hart in its isr */
 		bool ipi_pending(UX hart_id)
 		{
 			if (hart_id >= num_harts) return false;
-			return hart[hart_id] > 0;
+			return __atomic_load_n(&hart[hart_id], __ATOMIC_SEQ_CST) > 0;
 		}
 
 		/* MIPI MMIO */
@@ -103,6 +110,7 @@ namespace riscv {
 				printf("mipi_mmio:0x%04llx <- 0x%02hhx\n", addr_t(va), val);
 			}
 			if (va < total_size) *(as_u8() + va) = val;
+			proc.wake_harts();
 			return 0;
 		}
 
@@ -112,6 +120,7 @@ namespace riscv {
 				printf("mipi_mmio:0x%04llx <- 0x%04hx\n", addr_t(va), val);
 			}
 			if (va < total_size - 1) *(as_u16() + (va>>1)) = val;
+			proc.wake_harts();
 			return 0;
 		}
 
@@ -121,6 +130,7 @@ namespace riscv {
 				printf("mipi_mmio:0x%04llx <- 0x%08x\n", addr_t(va), val);
 			}
 			if (va < total_size - 3) *(as_u32() + (va>>2)) = val;
+			proc.wake_harts();
 			return 0;
 		}
 
@@ -130,6 +140,7 @@ namespace riscv {
 				printf("mipi_mmio:0x%04llx <- 0x%016llx\n", addr_t(va), val);
 			}
 			if (va < total_size - 7) *(as_u64() + (va>>3)) = val;
+			proc.wake_harts();
 			return 0;
 		}
 
@@ -38,6 +38,13 @@ namespace riscv {
 			debug("plic_mmio:served           0b%016llx", served);
 		}
 
+		template <typename S>
+		void snapshot(S &s)
+		{
+			s.io(pending);
+			s.io(served);
+		}
+
 		void set_irq(UX irq, int val)
 		{
 			if (val) {
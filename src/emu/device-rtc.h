@@ -40,6 +40,12 @@ namespace riscv {
 			debug("rtc_mmio:time              0x%llx", mtime);
 		}
 
+		template <typename S>
+		void snapshot(S &s)
+		{
+			s.io(mtime);
+		}
+
 		void update_time(UX time)
 		{
 			mtime = time;
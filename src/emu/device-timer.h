@@ -15,9 +15,8 @@ namespace riscv {
 		typedef typename P::ux UX;
 
 		enum {
-			bits_per_word = sizeof(u64) << 3,
 			num_harts = NUM_HARTS,
-			total_size = bits_per_word * num_harts
+			total_size = sizeof(u64) * num_harts
 		};
 
 		P &proc;
@@ -54,6 +53,22 @@ namespace riscv {
 			}
 		}
 
+		template <typename S>
+		void snapshot(S &s)
+		{
+			s.io(timecmp);
+			s.io(claimed);
+		}
+
+		/* the time timer_pending will next fire for a hart */
+		u64 next_deadline(UX hart_id)
+		{
+			if (hart_id >= num_harts || claimed[hart_id] > 0) {
+				return std::numeric_limits<u64>::max();
+			}
+			return timecmp[hart_id];
+		}
+
 		bool timer_pending(UX hart_id, u64 time)
 		{
 			if (hart_id >= num_harts || claimed[hart_id] > 0) return false;
@@ -138,6 +138,12 @@ namespace riscv {
 			plic->set_irq(irq, ((com.ier & IER_ERBDA) && console->has_char()) ? 1 : 0);
 		}
 
+		template <typename S>
+		void snapshot(S &s)
+		{
+			s.io(com);
+		}
+
 		void print_registers()
 		{
 			debug("uart_mmio:rbr              %d", com.rbr);
@@ -7,6 +7,2199 @@
 #ifndef rv_interp_h
 #define rv_interp_h
 
+#if defined (ENABLE_THREADED_INTERP)
+
+/* Execute Instruction RV32 (threaded) */
+
+template <bool rvi, bool rvm, bool rva, bool rvs, bool rvf, bool rvd, bool rvq, bool rvc, typename T, typename P>
+typename P::ux exec_inst_rv32(T &dec, P &proc, typename P::ux pc_offset)
+{
+	using namespace riscv;
+	enum { xlen = 32 };
+	typedef s32 sx;
+	typedef u32 ux;
+
+	static const void* dispatch[] = {
+		&&illegal,
+		rvi ? &&op_lui : &&illegal,
+		rvi ? &&op_auipc : &&illegal,
+		rvi ? &&op_jal : &&illegal,
+		rvi ? &&op_jalr : &&illegal,
+		rvi ? &&op_beq : &&illegal,
+		rvi ? &&op_bne : &&illegal,
+		rvi ? &&op_blt : &&illegal,
+		rvi ? &&op_bge : &&illegal,
+		rvi ? &&op_bltu : &&illegal,
+		rvi ? &&op_bgeu : &&illegal,
+		rvi ? &&op_lb : &&illegal,
+		rvi ? &&op_lh : &&illegal,
+		rvi ? &&op_lw : &&illegal,
+		rvi ? &&op_lbu : &&illegal,
+		rvi ? &&op_lhu : &&illegal,
+		rvi ? &&op_sb : &&illegal,
+		rvi ? &&op_sh : &&illegal,
+		rvi ? &&op_sw : &&illegal,
+		rvi ? &&op_addi : &&illegal,
+		rvi ? &&op_slti : &&illegal,
+		rvi ? &&op_sltiu : &&illegal,
+		rvi ? &&op_xori : &&illegal,
+		rvi ? &&op_ori : &&illegal,
+		rvi ? &&op_andi : &&illegal,
+		rvi ? &&op_slli : &&illegal,
+		rvi ? &&op_srli : &&illegal,
+		rvi ? &&op_srai : &&illegal,
+		rvi ? &&op_add : &&illegal,
+		rvi ? &&op_sub : &&illegal,
+		rvi ? &&op_sll : &&illegal,
+		rvi ? &&op_slt : &&illegal,
+		rvi ? &&op_sltu : &&illegal,
+		rvi ? &&op_xor : &&illegal,
+		rvi ? &&op_srl : &&illegal,
+		rvi ? &&op_sra : &&illegal,
+		rvi ? &&op_or : &&illegal,
+		rvi ? &&op_and : &&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		rvm ? &&op_mul : &&illegal,
+		rvm ? &&op_mulh : &&illegal,
+		rvm ? &&op_mulhsu : &&illegal,
+		rvm ? &&op_mulhu : &&illegal,
+		rvm ? &&op_div : &&illegal,
+		rvm ? &&op_divu : &&illegal,
+		rvm ? &&op_rem : &&illegal,
+		rvm ? &&op_remu : &&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		rva ? &&op_lr_w : &&illegal,
+		rva ? &&op_sc_w : &&illegal,
+		rva ? &&op_amoswap_w : &&illegal,
+		rva ? &&op_amoadd_w : &&illegal,
+		rva ? &&op_amoxor_w : &&illegal,
+		rva ? &&op_amoor_w : &&illegal,
+		rva ? &&op_amoand_w : &&illegal,
+		rva ? &&op_amomin_w : &&illegal,
+		rva ? &&op_amomax_w : &&illegal,
+		rva ? &&op_amominu_w : &&illegal,
+		rva ? &&op_amomaxu_w : &&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		rvf ? &&op_flw : &&illegal,
+		rvf ? &&op_fsw : &&illegal,
+		rvf ? &&op_fmadd_s : &&illegal,
+		rvf ? &&op_fmsub_s : &&illegal,
+		rvf ? &&op_fnmsub_s : &&illegal,
+		rvf ? &&op_fnmadd_s : &&illegal,
+		rvf ? &&op_fadd_s : &&illegal,
+		rvf ? &&op_fsub_s : &&illegal,
+		rvf ? &&op_fmul_s : &&illegal,
+		rvf ? &&op_fdiv_s : &&illegal,
+		rvf ? &&op_fsgnj_s : &&illegal,
+		rvf ? &&op_fsgnjn_s : &&illegal,
+		rvf ? &&op_fsgnjx_s : &&illegal,
+		rvf ? &&op_fmin_s : &&illegal,
+		rvf ? &&op_fmax_s : &&illegal,
+		rvf ? &&op_fsqrt_s : &&illegal,
+		rvf ? &&op_fle_s : &&illegal,
+		rvf ? &&op_flt_s : &&illegal,
+		rvf ? &&op_feq_s : &&illegal,
+		rvf ? &&op_fcvt_w_s : &&illegal,
+		rvf ? &&op_fcvt_wu_s : &&illegal,
+		rvf ? &&op_fcvt_s_w : &&illegal,
+		rvf ? &&op_fcvt_s_wu : &&illegal,
+		rvf ? &&op_fmv_x_s : &&illegal,
+		rvf ? &&op_fclass_s : &&illegal,
+		rvf ? &&op_fmv_s_x : &&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		rvd ? &&op_fld : &&illegal,
+		rvd ? &&op_fsd : &&illegal,
+		rvd ? &&op_fmadd_d : &&illegal,
+		rvd ? &&op_fmsub_d : &&illegal,
+		rvd ? &&op_fnmsub_d : &&illegal,
+		rvd ? &&op_fnmadd_d : &&illegal,
+		rvd ? &&op_fadd_d : &&illegal,
+		rvd ? &&op_fsub_d : &&illegal,
+		rvd ? &&op_fmul_d : &&illegal,
+		rvd ? &&op_fdiv_d : &&illegal,
+		rvd ? &&op_fsgnj_d : &&illegal,
+		rvd ? &&op_fsgnjn_d : &&illegal,
+		rvd ? &&op_fsgnjx_d : &&illegal,
+		rvd ? &&op_fmin_d : &&illegal,
+		rvd ? &&op_fmax_d : &&illegal,
+		rvd ? &&op_fcvt_s_d : &&illegal,
+		rvd ? &&op_fcvt_d_s : &&illegal,
+		rvd ? &&op_fsqrt_d : &&illegal,
+		rvd ? &&op_fle_d : &&illegal,
+		rvd ? &&op_flt_d : &&illegal,
+		rvd ? &&op_feq_d : &&illegal,
+		rvd ? &&op_fcvt_w_d : &&illegal,
+		rvd ? &&op_fcvt_wu_d : &&illegal,
+		rvd ? &&op_fcvt_d_w : &&illegal,
+		rvd ? &&op_fcvt_d_wu : &&illegal,
+		rvd ? &&op_fclass_d : &&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+	};
+
+	goto *dispatch[dec.op];
+	op_lui: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : dec.imm;
+		return pc_offset;
+	}
+	op_auipc: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + dec.imm;
+		return pc_offset;
+	}
+	op_jal: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + pc_offset; pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_jalr: {
+		ux new_offset = (proc.ireg[dec.rs1] + dec.imm - proc.pc) & ~1; proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + pc_offset; pc_offset = new_offset;
+		return pc_offset;
+	}
+	op_beq: {
+		if (proc.ireg[dec.rs1].r.x.val == proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_bne: {
+		if (proc.ireg[dec.rs1].r.x.val != proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_blt: {
+		if (proc.ireg[dec.rs1].r.x.val < proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_bge: {
+		if (proc.ireg[dec.rs1].r.x.val >= proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_bltu: {
+		if (proc.ireg[dec.rs1].r.xu.val < proc.ireg[dec.rs2].r.xu.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_bgeu: {
+		if (proc.ireg[dec.rs1].r.xu.val >= proc.ireg[dec.rs2].r.xu.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_lb: {
+		s8 t; proc.mmu.template load<P,s8>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_lh: {
+		s16 t; proc.mmu.template load<P,s16>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_lw: {
+		s32 t; proc.mmu.template load<P,s32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_lbu: {
+		u8 t; proc.mmu.template load<P,u8>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_lhu: {
+		u16 t; proc.mmu.template load<P,u16>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_sb: {
+		proc.mmu.template store<P,s8>(proc, proc.ireg[dec.rs1] + dec.imm, s8(proc.ireg[dec.rs2]));
+		return pc_offset;
+	}
+	op_sh: {
+		proc.mmu.template store<P,s16>(proc, proc.ireg[dec.rs1] + dec.imm, s16(proc.ireg[dec.rs2]));
+		return pc_offset;
+	}
+	op_sw: {
+		proc.mmu.template store<P,s32>(proc, proc.ireg[dec.rs1] + dec.imm, proc.ireg[dec.rs2].r.w.val);
+		return pc_offset;
+	}
+	op_addi: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val + sx(dec.imm);
+		return pc_offset;
+	}
+	op_slti: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val < sx(dec.imm);
+		return pc_offset;
+	}
+	op_sltiu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val < ux(dec.imm);
+		return pc_offset;
+	}
+	op_xori: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val ^ ux(dec.imm);
+		return pc_offset;
+	}
+	op_ori: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val | ux(dec.imm);
+		return pc_offset;
+	}
+	op_andi: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val & ux(dec.imm);
+		return pc_offset;
+	}
+	op_slli: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val << dec.imm;
+		return pc_offset;
+	}
+	op_srli: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val >> dec.imm;
+		return pc_offset;
+	}
+	op_srai: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val >> dec.imm;
+		return pc_offset;
+	}
+	op_add: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val + proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_sub: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val - proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_sll: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val << (proc.ireg[dec.rs2] & 0b1111111);
+		return pc_offset;
+	}
+	op_slt: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val < proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_sltu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val < proc.ireg[dec.rs2].r.xu.val;
+		return pc_offset;
+	}
+	op_xor: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val ^ proc.ireg[dec.rs2].r.xu.val;
+		return pc_offset;
+	}
+	op_srl: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val >> (proc.ireg[dec.rs2] & 0b1111111);
+		return pc_offset;
+	}
+	op_sra: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val >> (proc.ireg[dec.rs2] & 0b1111111);
+		return pc_offset;
+	}
+	op_or: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val | proc.ireg[dec.rs2].r.xu.val;
+		return pc_offset;
+	}
+	op_and: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val & proc.ireg[dec.rs2].r.xu.val;
+		return pc_offset;
+	}
+	op_mul: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val * proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_mulh: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulh(proc.ireg[dec.rs1].r.x.val, proc.ireg[dec.rs2].r.x.val);
+		return pc_offset;
+	}
+	op_mulhsu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulhsu(proc.ireg[dec.rs1].r.x.val, proc.ireg[dec.rs2].r.xu.val);
+		return pc_offset;
+	}
+	op_mulhu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulhu(proc.ireg[dec.rs1].r.xu.val, proc.ireg[dec.rs2].r.xu.val);
+		return pc_offset;
+	}
+	op_div: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val == std::numeric_limits<sx>::min() && proc.ireg[dec.rs2].r.x.val == -1 ? std::numeric_limits<sx>::min() : proc.ireg[dec.rs2].r.x.val == 0 ? -1 : proc.ireg[dec.rs1].r.x.val / proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_divu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? -1 : sx(proc.ireg[dec.rs1].r.xu.val / proc.ireg[dec.rs2].r.xu.val);
+		return pc_offset;
+	}
+	op_rem: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val == std::numeric_limits<sx>::min() && proc.ireg[dec.rs2].r.x.val == -1 ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? proc.ireg[dec.rs1].r.x.val : proc.ireg[dec.rs1].r.x.val % proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_remu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? proc.ireg[dec.rs1].r.x.val : sx(proc.ireg[dec.rs1].r.xu.val % proc.ireg[dec.rs2].r.xu.val);
+		return pc_offset;
+	}
+	op_lr_w: {
+		s32 t; proc.mmu.template load_reserved<P,s32>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_sc_w: {
+		ux res = proc.mmu.template store_conditional<P,s32>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.w.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
+		return pc_offset;
+	}
+	op_amoswap_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoswap, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoadd_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoadd, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoxor_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoxor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoor_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoand_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoand, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amomin_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomin, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amomax_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomax, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amominu_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amominu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amomaxu_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomaxu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_flw: {
+		u32 t; proc.mmu.template load<P,u32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.freg[dec.rd].r.wu.val = t;
+		return pc_offset;
+	}
+	op_fsw: {
+		proc.mmu.template store<P,f32>(proc, proc.ireg[dec.rs1] + dec.imm, proc.freg[dec.rs2].r.s.val);
+		return pc_offset;
+	}
+	op_fmadd_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val + proc.freg[dec.rs3].r.s.val;
+		return pc_offset;
+	}
+	op_fmsub_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val - proc.freg[dec.rs3].r.s.val;
+		return pc_offset;
+	}
+	op_fnmsub_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * -proc.freg[dec.rs2].r.s.val + proc.freg[dec.rs3].r.s.val;
+		return pc_offset;
+	}
+	op_fnmadd_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * -proc.freg[dec.rs2].r.s.val - proc.freg[dec.rs3].r.s.val;
+		return pc_offset;
+	}
+	op_fadd_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val + proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fsub_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val - proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fmul_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fdiv_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val / proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fsgnj_s: {
+		proc.freg[dec.rd].r.wu.val = (proc.freg[dec.rs1].r.wu.val & u32(~(1U<<31))) | (proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		return pc_offset;
+	}
+	op_fsgnjn_s: {
+		proc.freg[dec.rd].r.wu.val = (proc.freg[dec.rs1].r.wu.val & u32(~(1U<<31))) | (~proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		return pc_offset;
+	}
+	op_fsgnjx_s: {
+		proc.freg[dec.rd].r.wu.val = proc.freg[dec.rs1].r.wu.val ^ (proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		return pc_offset;
+	}
+	op_fmin_s: {
+		proc.freg[dec.rd].r.s.val = (proc.freg[dec.rs1].r.s.val < proc.freg[dec.rs2].r.s.val) || std::isnan(proc.freg[dec.rs2].r.s.val) ? proc.freg[dec.rs1].r.s.val : proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fmax_s: {
+		proc.freg[dec.rd].r.s.val = (proc.freg[dec.rs1].r.s.val > proc.freg[dec.rs2].r.s.val) || std::isnan(proc.freg[dec.rs2].r.s.val) ? proc.freg[dec.rs1].r.s.val : proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fsqrt_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = riscv::f32_sqrt(proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fle_s: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val <= proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_flt_s: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val < proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_feq_s: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val == proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fcvt_w_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_w(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fcvt_wu_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_wu(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fcvt_s_w: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.w.val);
+		return pc_offset;
+	}
+	op_fcvt_s_wu: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.wu.val);
+		return pc_offset;
+	}
+	op_fmv_x_s: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : std::isnan(proc.freg[dec.rs1].r.s.val) ? s32(0x7fc00000) : proc.freg[dec.rs1].r.w.val;
+		return pc_offset;
+	}
+	op_fclass_s: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : f32_classify(proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fmv_s_x: {
+		proc.freg[dec.rd].r.wu.val = proc.ireg[dec.rs1].r.wu.val;
+		return pc_offset;
+	}
+	op_fld: {
+		u64 t; proc.mmu.template load<P,u64>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.freg[dec.rd].r.lu.val = t;
+		return pc_offset;
+	}
+	op_fsd: {
+		proc.mmu.template store<P,f64>(proc, proc.ireg[dec.rs1] + dec.imm, proc.freg[dec.rs2].r.d.val);
+		return pc_offset;
+	}
+	op_fmadd_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val + proc.freg[dec.rs3].r.d.val;
+		return pc_offset;
+	}
+	op_fmsub_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val - proc.freg[dec.rs3].r.d.val;
+		return pc_offset;
+	}
+	op_fnmsub_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * -proc.freg[dec.rs2].r.d.val + proc.freg[dec.rs3].r.d.val;
+		return pc_offset;
+	}
+	op_fnmadd_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * -proc.freg[dec.rs2].r.d.val - proc.freg[dec.rs3].r.d.val;
+		return pc_offset;
+	}
+	op_fadd_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val + proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fsub_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val - proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fmul_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fdiv_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val / proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fsgnj_d: {
+		proc.freg[dec.rd].r.lu.val = (proc.freg[dec.rs1].r.lu.val & u64(~(1ULL<<63))) | (proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		return pc_offset;
+	}
+	op_fsgnjn_d: {
+		proc.freg[dec.rd].r.lu.val = (proc.freg[dec.rs1].r.lu.val & u64(~(1ULL<<63))) | (~proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		return pc_offset;
+	}
+	op_fsgnjx_d: {
+		proc.freg[dec.rd].r.lu.val = proc.freg[dec.rs1].r.lu.val ^ (proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		return pc_offset;
+	}
+	op_fmin_d: {
+		proc.freg[dec.rd].r.d.val = (proc.freg[dec.rs1].r.d.val < proc.freg[dec.rs2].r.d.val) || std::isnan(proc.freg[dec.rs2].r.d.val) ? proc.freg[dec.rs1].r.d.val : proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fmax_d: {
+		proc.freg[dec.rd].r.d.val = (proc.freg[dec.rs1].r.d.val > proc.freg[dec.rs2].r.d.val) || std::isnan(proc.freg[dec.rs2].r.d.val) ? proc.freg[dec.rs1].r.d.val : proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fcvt_s_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fcvt_d_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fsqrt_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = riscv::f64_sqrt(proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fle_d: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val <= proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_flt_d: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val < proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_feq_d: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val == proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fcvt_w_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_w(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fcvt_wu_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_wu(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fcvt_d_w: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.w.val);
+		return pc_offset;
+	}
+	op_fcvt_d_wu: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.wu.val);
+		return pc_offset;
+	}
+	op_fclass_d: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : f64_classify(proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	illegal:
+		return -1; /* illegal instruction */
+}
+
+/* Execute Block RV32 (threaded) */
+
+template <bool rvi, bool rvm, bool rva, bool rvs, bool rvf, bool rvd, bool rvq, bool rvc, typename B, typename T, typename P>
+size_t exec_block_rv32(B *insts, size_t count, T *&cur, P &proc, typename P::ux inststop)
+{
+	using namespace riscv;
+	enum { xlen = 32 };
+	typedef s32 sx;
+	typedef u32 ux;
+
+	static const void* dispatch[] = {
+		&&unhandled,
+		rvi ? &&op_lui : &&unhandled,
+		rvi ? &&op_auipc : &&unhandled,
+		rvi ? &&op_jal : &&unhandled,
+		rvi ? &&op_jalr : &&unhandled,
+		rvi ? &&op_beq : &&unhandled,
+		rvi ? &&op_bne : &&unhandled,
+		rvi ? &&op_blt : &&unhandled,
+		rvi ? &&op_bge : &&unhandled,
+		rvi ? &&op_bltu : &&unhandled,
+		rvi ? &&op_bgeu : &&unhandled,
+		rvi ? &&op_lb : &&unhandled,
+		rvi ? &&op_lh : &&unhandled,
+		rvi ? &&op_lw : &&unhandled,
+		rvi ? &&op_lbu : &&unhandled,
+		rvi ? &&op_lhu : &&unhandled,
+		rvi ? &&op_sb : &&unhandled,
+		rvi ? &&op_sh : &&unhandled,
+		rvi ? &&op_sw : &&unhandled,
+		rvi ? &&op_addi : &&unhandled,
+		rvi ? &&op_slti : &&unhandled,
+		rvi ? &&op_sltiu : &&unhandled,
+		rvi ? &&op_xori : &&unhandled,
+		rvi ? &&op_ori : &&unhandled,
+		rvi ? &&op_andi : &&unhandled,
+		rvi ? &&op_slli : &&unhandled,
+		rvi ? &&op_srli : &&unhandled,
+		rvi ? &&op_srai : &&unhandled,
+		rvi ? &&op_add : &&unhandled,
+		rvi ? &&op_sub : &&unhandled,
+		rvi ? &&op_sll : &&unhandled,
+		rvi ? &&op_slt : &&unhandled,
+		rvi ? &&op_sltu : &&unhandled,
+		rvi ? &&op_xor : &&unhandled,
+		rvi ? &&op_srl : &&unhandled,
+		rvi ? &&op_sra : &&unhandled,
+		rvi ? &&op_or : &&unhandled,
+		rvi ? &&op_and : &&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		rvm ? &&op_mul : &&unhandled,
+		rvm ? &&op_mulh : &&unhandled,
+		rvm ? &&op_mulhsu : &&unhandled,
+		rvm ? &&op_mulhu : &&unhandled,
+		rvm ? &&op_div : &&unhandled,
+		rvm ? &&op_divu : &&unhandled,
+		rvm ? &&op_rem : &&unhandled,
+		rvm ? &&op_remu : &&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		rva ? &&op_lr_w : &&unhandled,
+		rva ? &&op_sc_w : &&unhandled,
+		rva ? &&op_amoswap_w : &&unhandled,
+		rva ? &&op_amoadd_w : &&unhandled,
+		rva ? &&op_amoxor_w : &&unhandled,
+		rva ? &&op_amoor_w : &&unhandled,
+		rva ? &&op_amoand_w : &&unhandled,
+		rva ? &&op_amomin_w : &&unhandled,
+		rva ? &&op_amomax_w : &&unhandled,
+		rva ? &&op_amominu_w : &&unhandled,
+		rva ? &&op_amomaxu_w : &&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		rvf ? &&op_flw : &&unhandled,
+		rvf ? &&op_fsw : &&unhandled,
+		rvf ? &&op_fmadd_s : &&unhandled,
+		rvf ? &&op_fmsub_s : &&unhandled,
+		rvf ? &&op_fnmsub_s : &&unhandled,
+		rvf ? &&op_fnmadd_s : &&unhandled,
+		rvf ? &&op_fadd_s : &&unhandled,
+		rvf ? &&op_fsub_s : &&unhandled,
+		rvf ? &&op_fmul_s : &&unhandled,
+		rvf ? &&op_fdiv_s : &&unhandled,
+		rvf ? &&op_fsgnj_s : &&unhandled,
+		rvf ? &&op_fsgnjn_s : &&unhandled,
+		rvf ? &&op_fsgnjx_s : &&unhandled,
+		rvf ? &&op_fmin_s : &&unhandled,
+		rvf ? &&op_fmax_s : &&unhandled,
+		rvf ? &&op_fsqrt_s : &&unhandled,
+		rvf ? &&op_fle_s : &&unhandled,
+		rvf ? &&op_flt_s : &&unhandled,
+		rvf ? &&op_feq_s : &&unhandled,
+		rvf ? &&op_fcvt_w_s : &&unhandled,
+		rvf ? &&op_fcvt_wu_s : &&unhandled,
+		rvf ? &&op_fcvt_s_w : &&unhandled,
+		rvf ? &&op_fcvt_s_wu : &&unhandled,
+		rvf ? &&op_fmv_x_s : &&unhandled,
+		rvf ? &&op_fclass_s : &&unhandled,
+		rvf ? &&op_fmv_s_x : &&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		rvd ? &&op_fld : &&unhandled,
+		rvd ? &&op_fsd : &&unhandled,
+		rvd ? &&op_fmadd_d : &&unhandled,
+		rvd ? &&op_fmsub_d : &&unhandled,
+		rvd ? &&op_fnmsub_d : &&unhandled,
+		rvd ? &&op_fnmadd_d : &&unhandled,
+		rvd ? &&op_fadd_d : &&unhandled,
+		rvd ? &&op_fsub_d : &&unhandled,
+		rvd ? &&op_fmul_d : &&unhandled,
+		rvd ? &&op_fdiv_d : &&unhandled,
+		rvd ? &&op_fsgnj_d : &&unhandled,
+		rvd ? &&op_fsgnjn_d : &&unhandled,
+		rvd ? &&op_fsgnjx_d : &&unhandled,
+		rvd ? &&op_fmin_d : &&unhandled,
+		rvd ? &&op_fmax_d : &&unhandled,
+		rvd ? &&op_fcvt_s_d : &&unhandled,
+		rvd ? &&op_fcvt_d_s : &&unhandled,
+		rvd ? &&op_fsqrt_d : &&unhandled,
+		rvd ? &&op_fle_d : &&unhandled,
+		rvd ? &&op_flt_d : &&unhandled,
+		rvd ? &&op_feq_d : &&unhandled,
+		rvd ? &&op_fcvt_w_d : &&unhandled,
+		rvd ? &&op_fcvt_wu_d : &&unhandled,
+		rvd ? &&op_fcvt_d_w : &&unhandled,
+		rvd ? &&op_fcvt_d_wu : &&unhandled,
+		rvd ? &&op_fclass_d : &&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+	};
+
+	size_t i = 0;
+	cur = &insts[0].dec;
+	typename P::ux pc_offset = insts[0].len;
+	goto *dispatch[cur->op];
+	op_lui: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_auipc: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_jal: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + pc_offset; pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_jalr: {
+		T &dec = *cur;
+		ux new_offset = (proc.ireg[dec.rs1] + dec.imm - proc.pc) & ~1; proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + pc_offset; pc_offset = new_offset;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_beq: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.x.val == proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_bne: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.x.val != proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_blt: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.x.val < proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_bge: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.x.val >= proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_bltu: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.xu.val < proc.ireg[dec.rs2].r.xu.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_bgeu: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.xu.val >= proc.ireg[dec.rs2].r.xu.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lb: {
+		T &dec = *cur;
+		s8 t; proc.mmu.template load<P,s8>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lh: {
+		T &dec = *cur;
+		s16 t; proc.mmu.template load<P,s16>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lw: {
+		T &dec = *cur;
+		s32 t; proc.mmu.template load<P,s32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lbu: {
+		T &dec = *cur;
+		u8 t; proc.mmu.template load<P,u8>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lhu: {
+		T &dec = *cur;
+		u16 t; proc.mmu.template load<P,u16>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sb: {
+		T &dec = *cur;
+		proc.mmu.template store<P,s8>(proc, proc.ireg[dec.rs1] + dec.imm, s8(proc.ireg[dec.rs2]));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sh: {
+		T &dec = *cur;
+		proc.mmu.template store<P,s16>(proc, proc.ireg[dec.rs1] + dec.imm, s16(proc.ireg[dec.rs2]));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sw: {
+		T &dec = *cur;
+		proc.mmu.template store<P,s32>(proc, proc.ireg[dec.rs1] + dec.imm, proc.ireg[dec.rs2].r.w.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_addi: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val + sx(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_slti: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val < sx(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sltiu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val < ux(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_xori: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val ^ ux(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_ori: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val | ux(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_andi: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val & ux(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_slli: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val << dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_srli: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val >> dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_srai: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val >> dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_add: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val + proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sub: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val - proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sll: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val << (proc.ireg[dec.rs2] & 0b1111111);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_slt: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val < proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sltu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val < proc.ireg[dec.rs2].r.xu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_xor: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val ^ proc.ireg[dec.rs2].r.xu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_srl: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val >> (proc.ireg[dec.rs2] & 0b1111111);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sra: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val >> (proc.ireg[dec.rs2] & 0b1111111);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_or: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val | proc.ireg[dec.rs2].r.xu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_and: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val & proc.ireg[dec.rs2].r.xu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_mul: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val * proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_mulh: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulh(proc.ireg[dec.rs1].r.x.val, proc.ireg[dec.rs2].r.x.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_mulhsu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulhsu(proc.ireg[dec.rs1].r.x.val, proc.ireg[dec.rs2].r.xu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_mulhu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulhu(proc.ireg[dec.rs1].r.xu.val, proc.ireg[dec.rs2].r.xu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_div: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val == std::numeric_limits<sx>::min() && proc.ireg[dec.rs2].r.x.val == -1 ? std::numeric_limits<sx>::min() : proc.ireg[dec.rs2].r.x.val == 0 ? -1 : proc.ireg[dec.rs1].r.x.val / proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_divu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? -1 : sx(proc.ireg[dec.rs1].r.xu.val / proc.ireg[dec.rs2].r.xu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_rem: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val == std::numeric_limits<sx>::min() && proc.ireg[dec.rs2].r.x.val == -1 ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? proc.ireg[dec.rs1].r.x.val : proc.ireg[dec.rs1].r.x.val % proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_remu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? proc.ireg[dec.rs1].r.x.val : sx(proc.ireg[dec.rs1].r.xu.val % proc.ireg[dec.rs2].r.xu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lr_w: {
+		T &dec = *cur;
+		s32 t; proc.mmu.template load_reserved<P,s32>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sc_w: {
+		T &dec = *cur;
+		ux res = proc.mmu.template store_conditional<P,s32>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.w.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoswap_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoswap, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoadd_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoadd, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoxor_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoxor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoor_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoand_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoand, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amomin_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomin, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amomax_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomax, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amominu_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amominu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amomaxu_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomaxu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_flw: {
+		T &dec = *cur;
+		u32 t; proc.mmu.template load<P,u32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.freg[dec.rd].r.wu.val = t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsw: {
+		T &dec = *cur;
+		proc.mmu.template store<P,f32>(proc, proc.ireg[dec.rs1] + dec.imm, proc.freg[dec.rs2].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmadd_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val + proc.freg[dec.rs3].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmsub_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val - proc.freg[dec.rs3].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fnmsub_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * -proc.freg[dec.rs2].r.s.val + proc.freg[dec.rs3].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fnmadd_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * -proc.freg[dec.rs2].r.s.val - proc.freg[dec.rs3].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fadd_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val + proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsub_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val - proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmul_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fdiv_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val / proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnj_s: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.wu.val = (proc.freg[dec.rs1].r.wu.val & u32(~(1U<<31))) | (proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnjn_s: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.wu.val = (proc.freg[dec.rs1].r.wu.val & u32(~(1U<<31))) | (~proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnjx_s: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.wu.val = proc.freg[dec.rs1].r.wu.val ^ (proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmin_s: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.s.val = (proc.freg[dec.rs1].r.s.val < proc.freg[dec.rs2].r.s.val) || std::isnan(proc.freg[dec.rs2].r.s.val) ? proc.freg[dec.rs1].r.s.val : proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmax_s: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.s.val = (proc.freg[dec.rs1].r.s.val > proc.freg[dec.rs2].r.s.val) || std::isnan(proc.freg[dec.rs2].r.s.val) ? proc.freg[dec.rs1].r.s.val : proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsqrt_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = riscv::f32_sqrt(proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fle_s: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val <= proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_flt_s: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val < proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_feq_s: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val == proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_w_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_w(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_wu_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_wu(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_s_w: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.w.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_s_wu: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.wu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmv_x_s: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : std::isnan(proc.freg[dec.rs1].r.s.val) ? s32(0x7fc00000) : proc.freg[dec.rs1].r.w.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fclass_s: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : f32_classify(proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmv_s_x: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.wu.val = proc.ireg[dec.rs1].r.wu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fld: {
+		T &dec = *cur;
+		u64 t; proc.mmu.template load<P,u64>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.freg[dec.rd].r.lu.val = t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsd: {
+		T &dec = *cur;
+		proc.mmu.template store<P,f64>(proc, proc.ireg[dec.rs1] + dec.imm, proc.freg[dec.rs2].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmadd_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val + proc.freg[dec.rs3].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmsub_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val - proc.freg[dec.rs3].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fnmsub_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * -proc.freg[dec.rs2].r.d.val + proc.freg[dec.rs3].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fnmadd_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * -proc.freg[dec.rs2].r.d.val - proc.freg[dec.rs3].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fadd_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val + proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsub_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val - proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmul_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fdiv_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val / proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnj_d: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.lu.val = (proc.freg[dec.rs1].r.lu.val & u64(~(1ULL<<63))) | (proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnjn_d: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.lu.val = (proc.freg[dec.rs1].r.lu.val & u64(~(1ULL<<63))) | (~proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnjx_d: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.lu.val = proc.freg[dec.rs1].r.lu.val ^ (proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmin_d: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.d.val = (proc.freg[dec.rs1].r.d.val < proc.freg[dec.rs2].r.d.val) || std::isnan(proc.freg[dec.rs2].r.d.val) ? proc.freg[dec.rs1].r.d.val : proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmax_d: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.d.val = (proc.freg[dec.rs1].r.d.val > proc.freg[dec.rs2].r.d.val) || std::isnan(proc.freg[dec.rs2].r.d.val) ? proc.freg[dec.rs1].r.d.val : proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_s_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_d_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsqrt_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = riscv::f64_sqrt(proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fle_d: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val <= proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_flt_d: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val < proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_feq_d: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val == proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_w_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_w(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_wu_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_wu(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_d_w: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.w.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_d_wu: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.wu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fclass_d: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : f64_classify(proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	unhandled:
+		return i; /* executed by the runloop */
+}
+
+#else
+
 /* Execute Instruction RV32 */
 
 template <bool rvi, bool rvm, bool rva, bool rvs, bool rvf, bool rvd, bool rvq, bool rvc, typename T, typename P>
@@ -245,12 +2438,12 @@ typename P::ux exec_inst_rv32(T &dec, P &proc, typename P::ux pc_offset)
 			break;
 		case rv_op_lr_w:
 			if (rva) {
-				proc.lr = proc.ireg[dec.rs1]; s32 t; proc.mmu.template load<P,s32>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+				s32 t; proc.mmu.template load_reserved<P,s32>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
 			};
 			break;
 		case rv_op_sc_w:
 			if (rva) {
-				ux res = 0; if (proc.lr != proc.ireg[dec.rs1]) res = 1; else proc.mmu.template store<P,s32>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.w.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
+				ux res = proc.mmu.template store_conditional<P,s32>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.w.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
 			};
 			break;
 		case rv_op_amoswap_w:
@@ -560,9 +2753,2736 @@ typename P::ux exec_inst_rv32(T &dec, P &proc, typename P::ux pc_offset)
 			break;
 		default: return -1; /* illegal instruction */
 	}
-	return pc_offset;
+	return pc_offset;
+}
+
+#endif
+
+#if defined (ENABLE_THREADED_INTERP)
+
+/* Execute Instruction RV64 (threaded) */
+
+template <bool rvi, bool rvm, bool rva, bool rvs, bool rvf, bool rvd, bool rvq, bool rvc, typename T, typename P>
+typename P::ux exec_inst_rv64(T &dec, P &proc, typename P::ux pc_offset)
+{
+	using namespace riscv;
+	enum { xlen = 64 };
+	typedef s64 sx;
+	typedef u64 ux;
+
+	static const void* dispatch[] = {
+		&&illegal,
+		rvi ? &&op_lui : &&illegal,
+		rvi ? &&op_auipc : &&illegal,
+		rvi ? &&op_jal : &&illegal,
+		rvi ? &&op_jalr : &&illegal,
+		rvi ? &&op_beq : &&illegal,
+		rvi ? &&op_bne : &&illegal,
+		rvi ? &&op_blt : &&illegal,
+		rvi ? &&op_bge : &&illegal,
+		rvi ? &&op_bltu : &&illegal,
+		rvi ? &&op_bgeu : &&illegal,
+		rvi ? &&op_lb : &&illegal,
+		rvi ? &&op_lh : &&illegal,
+		rvi ? &&op_lw : &&illegal,
+		rvi ? &&op_lbu : &&illegal,
+		rvi ? &&op_lhu : &&illegal,
+		rvi ? &&op_sb : &&illegal,
+		rvi ? &&op_sh : &&illegal,
+		rvi ? &&op_sw : &&illegal,
+		rvi ? &&op_addi : &&illegal,
+		rvi ? &&op_slti : &&illegal,
+		rvi ? &&op_sltiu : &&illegal,
+		rvi ? &&op_xori : &&illegal,
+		rvi ? &&op_ori : &&illegal,
+		rvi ? &&op_andi : &&illegal,
+		rvi ? &&op_slli : &&illegal,
+		rvi ? &&op_srli : &&illegal,
+		rvi ? &&op_srai : &&illegal,
+		rvi ? &&op_add : &&illegal,
+		rvi ? &&op_sub : &&illegal,
+		rvi ? &&op_sll : &&illegal,
+		rvi ? &&op_slt : &&illegal,
+		rvi ? &&op_sltu : &&illegal,
+		rvi ? &&op_xor : &&illegal,
+		rvi ? &&op_srl : &&illegal,
+		rvi ? &&op_sra : &&illegal,
+		rvi ? &&op_or : &&illegal,
+		rvi ? &&op_and : &&illegal,
+		&&illegal,
+		&&illegal,
+		rvi ? &&op_lwu : &&illegal,
+		rvi ? &&op_ld : &&illegal,
+		rvi ? &&op_sd : &&illegal,
+		rvi ? &&op_addiw : &&illegal,
+		rvi ? &&op_slliw : &&illegal,
+		rvi ? &&op_srliw : &&illegal,
+		rvi ? &&op_sraiw : &&illegal,
+		rvi ? &&op_addw : &&illegal,
+		rvi ? &&op_subw : &&illegal,
+		rvi ? &&op_sllw : &&illegal,
+		rvi ? &&op_srlw : &&illegal,
+		rvi ? &&op_sraw : &&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		rvm ? &&op_mul : &&illegal,
+		rvm ? &&op_mulh : &&illegal,
+		rvm ? &&op_mulhsu : &&illegal,
+		rvm ? &&op_mulhu : &&illegal,
+		rvm ? &&op_div : &&illegal,
+		rvm ? &&op_divu : &&illegal,
+		rvm ? &&op_rem : &&illegal,
+		rvm ? &&op_remu : &&illegal,
+		rvm ? &&op_mulw : &&illegal,
+		rvm ? &&op_divw : &&illegal,
+		rvm ? &&op_divuw : &&illegal,
+		rvm ? &&op_remw : &&illegal,
+		rvm ? &&op_remuw : &&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		rva ? &&op_lr_w : &&illegal,
+		rva ? &&op_sc_w : &&illegal,
+		rva ? &&op_amoswap_w : &&illegal,
+		rva ? &&op_amoadd_w : &&illegal,
+		rva ? &&op_amoxor_w : &&illegal,
+		rva ? &&op_amoor_w : &&illegal,
+		rva ? &&op_amoand_w : &&illegal,
+		rva ? &&op_amomin_w : &&illegal,
+		rva ? &&op_amomax_w : &&illegal,
+		rva ? &&op_amominu_w : &&illegal,
+		rva ? &&op_amomaxu_w : &&illegal,
+		rva ? &&op_lr_d : &&illegal,
+		rva ? &&op_sc_d : &&illegal,
+		rva ? &&op_amoswap_d : &&illegal,
+		rva ? &&op_amoadd_d : &&illegal,
+		rva ? &&op_amoxor_d : &&illegal,
+		rva ? &&op_amoor_d : &&illegal,
+		rva ? &&op_amoand_d : &&illegal,
+		rva ? &&op_amomin_d : &&illegal,
+		rva ? &&op_amomax_d : &&illegal,
+		rva ? &&op_amominu_d : &&illegal,
+		rva ? &&op_amomaxu_d : &&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		rvf ? &&op_flw : &&illegal,
+		rvf ? &&op_fsw : &&illegal,
+		rvf ? &&op_fmadd_s : &&illegal,
+		rvf ? &&op_fmsub_s : &&illegal,
+		rvf ? &&op_fnmsub_s : &&illegal,
+		rvf ? &&op_fnmadd_s : &&illegal,
+		rvf ? &&op_fadd_s : &&illegal,
+		rvf ? &&op_fsub_s : &&illegal,
+		rvf ? &&op_fmul_s : &&illegal,
+		rvf ? &&op_fdiv_s : &&illegal,
+		rvf ? &&op_fsgnj_s : &&illegal,
+		rvf ? &&op_fsgnjn_s : &&illegal,
+		rvf ? &&op_fsgnjx_s : &&illegal,
+		rvf ? &&op_fmin_s : &&illegal,
+		rvf ? &&op_fmax_s : &&illegal,
+		rvf ? &&op_fsqrt_s : &&illegal,
+		rvf ? &&op_fle_s : &&illegal,
+		rvf ? &&op_flt_s : &&illegal,
+		rvf ? &&op_feq_s : &&illegal,
+		rvf ? &&op_fcvt_w_s : &&illegal,
+		rvf ? &&op_fcvt_wu_s : &&illegal,
+		rvf ? &&op_fcvt_s_w : &&illegal,
+		rvf ? &&op_fcvt_s_wu : &&illegal,
+		rvf ? &&op_fmv_x_s : &&illegal,
+		rvf ? &&op_fclass_s : &&illegal,
+		rvf ? &&op_fmv_s_x : &&illegal,
+		rvf ? &&op_fcvt_l_s : &&illegal,
+		rvf ? &&op_fcvt_lu_s : &&illegal,
+		rvf ? &&op_fcvt_s_l : &&illegal,
+		rvf ? &&op_fcvt_s_lu : &&illegal,
+		rvd ? &&op_fld : &&illegal,
+		rvd ? &&op_fsd : &&illegal,
+		rvd ? &&op_fmadd_d : &&illegal,
+		rvd ? &&op_fmsub_d : &&illegal,
+		rvd ? &&op_fnmsub_d : &&illegal,
+		rvd ? &&op_fnmadd_d : &&illegal,
+		rvd ? &&op_fadd_d : &&illegal,
+		rvd ? &&op_fsub_d : &&illegal,
+		rvd ? &&op_fmul_d : &&illegal,
+		rvd ? &&op_fdiv_d : &&illegal,
+		rvd ? &&op_fsgnj_d : &&illegal,
+		rvd ? &&op_fsgnjn_d : &&illegal,
+		rvd ? &&op_fsgnjx_d : &&illegal,
+		rvd ? &&op_fmin_d : &&illegal,
+		rvd ? &&op_fmax_d : &&illegal,
+		rvd ? &&op_fcvt_s_d : &&illegal,
+		rvd ? &&op_fcvt_d_s : &&illegal,
+		rvd ? &&op_fsqrt_d : &&illegal,
+		rvd ? &&op_fle_d : &&illegal,
+		rvd ? &&op_flt_d : &&illegal,
+		rvd ? &&op_feq_d : &&illegal,
+		rvd ? &&op_fcvt_w_d : &&illegal,
+		rvd ? &&op_fcvt_wu_d : &&illegal,
+		rvd ? &&op_fcvt_d_w : &&illegal,
+		rvd ? &&op_fcvt_d_wu : &&illegal,
+		rvd ? &&op_fclass_d : &&illegal,
+		rvd ? &&op_fcvt_l_d : &&illegal,
+		rvd ? &&op_fcvt_lu_d : &&illegal,
+		rvd ? &&op_fmv_x_d : &&illegal,
+		rvd ? &&op_fcvt_d_l : &&illegal,
+		rvd ? &&op_fcvt_d_lu : &&illegal,
+		rvd ? &&op_fmv_d_x : &&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+	};
+
+	goto *dispatch[dec.op];
+	op_lui: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : dec.imm;
+		return pc_offset;
+	}
+	op_auipc: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + dec.imm;
+		return pc_offset;
+	}
+	op_jal: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + pc_offset; pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_jalr: {
+		ux new_offset = (proc.ireg[dec.rs1] + dec.imm - proc.pc) & ~1; proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + pc_offset; pc_offset = new_offset;
+		return pc_offset;
+	}
+	op_beq: {
+		if (proc.ireg[dec.rs1].r.x.val == proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_bne: {
+		if (proc.ireg[dec.rs1].r.x.val != proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_blt: {
+		if (proc.ireg[dec.rs1].r.x.val < proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_bge: {
+		if (proc.ireg[dec.rs1].r.x.val >= proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_bltu: {
+		if (proc.ireg[dec.rs1].r.xu.val < proc.ireg[dec.rs2].r.xu.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_bgeu: {
+		if (proc.ireg[dec.rs1].r.xu.val >= proc.ireg[dec.rs2].r.xu.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_lb: {
+		s8 t; proc.mmu.template load<P,s8>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_lh: {
+		s16 t; proc.mmu.template load<P,s16>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_lw: {
+		s32 t; proc.mmu.template load<P,s32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_lbu: {
+		u8 t; proc.mmu.template load<P,u8>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_lhu: {
+		u16 t; proc.mmu.template load<P,u16>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_sb: {
+		proc.mmu.template store<P,s8>(proc, proc.ireg[dec.rs1] + dec.imm, s8(proc.ireg[dec.rs2]));
+		return pc_offset;
+	}
+	op_sh: {
+		proc.mmu.template store<P,s16>(proc, proc.ireg[dec.rs1] + dec.imm, s16(proc.ireg[dec.rs2]));
+		return pc_offset;
+	}
+	op_sw: {
+		proc.mmu.template store<P,s32>(proc, proc.ireg[dec.rs1] + dec.imm, proc.ireg[dec.rs2].r.w.val);
+		return pc_offset;
+	}
+	op_addi: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val + sx(dec.imm);
+		return pc_offset;
+	}
+	op_slti: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val < sx(dec.imm);
+		return pc_offset;
+	}
+	op_sltiu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val < ux(dec.imm);
+		return pc_offset;
+	}
+	op_xori: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val ^ ux(dec.imm);
+		return pc_offset;
+	}
+	op_ori: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val | ux(dec.imm);
+		return pc_offset;
+	}
+	op_andi: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val & ux(dec.imm);
+		return pc_offset;
+	}
+	op_add: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val + proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_sub: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val - proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_sll: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val << (proc.ireg[dec.rs2] & 0b1111111);
+		return pc_offset;
+	}
+	op_slt: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val < proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_sltu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val < proc.ireg[dec.rs2].r.xu.val;
+		return pc_offset;
+	}
+	op_xor: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val ^ proc.ireg[dec.rs2].r.xu.val;
+		return pc_offset;
+	}
+	op_srl: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val >> (proc.ireg[dec.rs2] & 0b1111111);
+		return pc_offset;
+	}
+	op_sra: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val >> (proc.ireg[dec.rs2] & 0b1111111);
+		return pc_offset;
+	}
+	op_or: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val | proc.ireg[dec.rs2].r.xu.val;
+		return pc_offset;
+	}
+	op_and: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val & proc.ireg[dec.rs2].r.xu.val;
+		return pc_offset;
+	}
+	op_lwu: {
+		u32 t; proc.mmu.template load<P,u32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_ld: {
+		s64 t; proc.mmu.template load<P,s64>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_sd: {
+		proc.mmu.template store<P,s64>(proc, proc.ireg[dec.rs1] + dec.imm, proc.ireg[dec.rs2].r.l.val);
+		return pc_offset;
+	}
+	op_slli: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val << dec.imm;
+		return pc_offset;
+	}
+	op_srli: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val >> dec.imm;
+		return pc_offset;
+	}
+	op_srai: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val >> dec.imm;
+		return pc_offset;
+	}
+	op_addiw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val + dec.imm);
+		return pc_offset;
+	}
+	op_slliw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val << dec.imm);
+		return pc_offset;
+	}
+	op_srliw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val >> dec.imm);
+		return pc_offset;
+	}
+	op_sraiw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.w.val >> dec.imm;
+		return pc_offset;
+	}
+	op_addw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val + proc.ireg[dec.rs2].r.w.val);
+		return pc_offset;
+	}
+	op_subw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val - proc.ireg[dec.rs2].r.w.val);
+		return pc_offset;
+	}
+	op_sllw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val << (proc.ireg[dec.rs2] & 0b11111));
+		return pc_offset;
+	}
+	op_srlw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val >> (proc.ireg[dec.rs2] & 0b11111));
+		return pc_offset;
+	}
+	op_sraw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val >> (proc.ireg[dec.rs2] & 0b11111));
+		return pc_offset;
+	}
+	op_mul: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val * proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_mulh: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulh(proc.ireg[dec.rs1].r.x.val, proc.ireg[dec.rs2].r.x.val);
+		return pc_offset;
+	}
+	op_mulhsu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulhsu(proc.ireg[dec.rs1].r.x.val, proc.ireg[dec.rs2].r.xu.val);
+		return pc_offset;
+	}
+	op_mulhu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulhu(proc.ireg[dec.rs1].r.xu.val, proc.ireg[dec.rs2].r.xu.val);
+		return pc_offset;
+	}
+	op_div: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val == std::numeric_limits<sx>::min() && proc.ireg[dec.rs2].r.x.val == -1 ? std::numeric_limits<sx>::min() : proc.ireg[dec.rs2].r.x.val == 0 ? -1 : proc.ireg[dec.rs1].r.x.val / proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_divu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? -1 : sx(proc.ireg[dec.rs1].r.xu.val / proc.ireg[dec.rs2].r.xu.val);
+		return pc_offset;
+	}
+	op_rem: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val == std::numeric_limits<sx>::min() && proc.ireg[dec.rs2].r.x.val == -1 ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? proc.ireg[dec.rs1].r.x.val : proc.ireg[dec.rs1].r.x.val % proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_remu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? proc.ireg[dec.rs1].r.x.val : sx(proc.ireg[dec.rs1].r.xu.val % proc.ireg[dec.rs2].r.xu.val);
+		return pc_offset;
+	}
+	op_mulw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val * proc.ireg[dec.rs2].r.wu.val);
+		return pc_offset;
+	}
+	op_divw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.w.val == std::numeric_limits<s32>::min() && proc.ireg[dec.rs2].r.w.val == -1 ? std::numeric_limits<s32>::min() : proc.ireg[dec.rs2].r.w.val == 0 ? -1 : proc.ireg[dec.rs1].r.w.val / proc.ireg[dec.rs2].r.w.val;
+		return pc_offset;
+	}
+	op_divuw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.w.val == 0 ? -1 : s32(proc.ireg[dec.rs1].r.wu.val / proc.ireg[dec.rs2].r.wu.val);
+		return pc_offset;
+	}
+	op_remw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.w.val == std::numeric_limits<s32>::min() && proc.ireg[dec.rs2].r.w.val == -1 ? 0 : proc.ireg[dec.rs2].r.w.val == 0 ? proc.ireg[dec.rs1].r.w.val : proc.ireg[dec.rs1].r.w.val % proc.ireg[dec.rs2].r.w.val;
+		return pc_offset;
+	}
+	op_remuw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.w.val == 0 ? proc.ireg[dec.rs1].r.w.val : s32(proc.ireg[dec.rs1].r.wu.val % proc.ireg[dec.rs2].r.wu.val);
+		return pc_offset;
+	}
+	op_lr_w: {
+		s32 t; proc.mmu.template load_reserved<P,s32>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_sc_w: {
+		ux res = proc.mmu.template store_conditional<P,s32>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.w.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
+		return pc_offset;
+	}
+	op_amoswap_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoswap, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoadd_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoadd, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoxor_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoxor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoor_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoand_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoand, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amomin_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomin, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amomax_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomax, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amominu_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amominu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amomaxu_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomaxu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_lr_d: {
+		s64 t; proc.mmu.template load_reserved<P,s64>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_sc_d: {
+		ux res = proc.mmu.template store_conditional<P,s64>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.l.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
+		return pc_offset;
+	}
+	op_amoswap_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoswap, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoadd_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoadd, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoxor_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoxor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoor_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoand_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoand, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amomin_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amomin, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amomax_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amomax, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amominu_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amominu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amomaxu_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amomaxu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_flw: {
+		u32 t; proc.mmu.template load<P,u32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.freg[dec.rd].r.wu.val = t;
+		return pc_offset;
+	}
+	op_fsw: {
+		proc.mmu.template store<P,f32>(proc, proc.ireg[dec.rs1] + dec.imm, proc.freg[dec.rs2].r.s.val);
+		return pc_offset;
+	}
+	op_fmadd_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val + proc.freg[dec.rs3].r.s.val;
+		return pc_offset;
+	}
+	op_fmsub_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val - proc.freg[dec.rs3].r.s.val;
+		return pc_offset;
+	}
+	op_fnmsub_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * -proc.freg[dec.rs2].r.s.val + proc.freg[dec.rs3].r.s.val;
+		return pc_offset;
+	}
+	op_fnmadd_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * -proc.freg[dec.rs2].r.s.val - proc.freg[dec.rs3].r.s.val;
+		return pc_offset;
+	}
+	op_fadd_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val + proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fsub_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val - proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fmul_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fdiv_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val / proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fsgnj_s: {
+		proc.freg[dec.rd].r.wu.val = (proc.freg[dec.rs1].r.wu.val & u32(~(1U<<31))) | (proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		return pc_offset;
+	}
+	op_fsgnjn_s: {
+		proc.freg[dec.rd].r.wu.val = (proc.freg[dec.rs1].r.wu.val & u32(~(1U<<31))) | (~proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		return pc_offset;
+	}
+	op_fsgnjx_s: {
+		proc.freg[dec.rd].r.wu.val = proc.freg[dec.rs1].r.wu.val ^ (proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		return pc_offset;
+	}
+	op_fmin_s: {
+		proc.freg[dec.rd].r.s.val = (proc.freg[dec.rs1].r.s.val < proc.freg[dec.rs2].r.s.val) || std::isnan(proc.freg[dec.rs2].r.s.val) ? proc.freg[dec.rs1].r.s.val : proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fmax_s: {
+		proc.freg[dec.rd].r.s.val = (proc.freg[dec.rs1].r.s.val > proc.freg[dec.rs2].r.s.val) || std::isnan(proc.freg[dec.rs2].r.s.val) ? proc.freg[dec.rs1].r.s.val : proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fsqrt_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = riscv::f32_sqrt(proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fle_s: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val <= proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_flt_s: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val < proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_feq_s: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val == proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fcvt_w_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_w(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fcvt_wu_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_wu(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fcvt_s_w: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.w.val);
+		return pc_offset;
+	}
+	op_fcvt_s_wu: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.wu.val);
+		return pc_offset;
+	}
+	op_fmv_x_s: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : std::isnan(proc.freg[dec.rs1].r.s.val) ? s32(0x7fc00000) : proc.freg[dec.rs1].r.w.val;
+		return pc_offset;
+	}
+	op_fclass_s: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : f32_classify(proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fmv_s_x: {
+		proc.freg[dec.rd].r.wu.val = proc.ireg[dec.rs1].r.wu.val;
+		return pc_offset;
+	}
+	op_fcvt_l_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_l(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fcvt_lu_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_lu(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fcvt_s_l: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.l.val);
+		return pc_offset;
+	}
+	op_fcvt_s_lu: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.lu.val);
+		return pc_offset;
+	}
+	op_fld: {
+		u64 t; proc.mmu.template load<P,u64>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.freg[dec.rd].r.lu.val = t;
+		return pc_offset;
+	}
+	op_fsd: {
+		proc.mmu.template store<P,f64>(proc, proc.ireg[dec.rs1] + dec.imm, proc.freg[dec.rs2].r.d.val);
+		return pc_offset;
+	}
+	op_fmadd_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val + proc.freg[dec.rs3].r.d.val;
+		return pc_offset;
+	}
+	op_fmsub_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val - proc.freg[dec.rs3].r.d.val;
+		return pc_offset;
+	}
+	op_fnmsub_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * -proc.freg[dec.rs2].r.d.val + proc.freg[dec.rs3].r.d.val;
+		return pc_offset;
+	}
+	op_fnmadd_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * -proc.freg[dec.rs2].r.d.val - proc.freg[dec.rs3].r.d.val;
+		return pc_offset;
+	}
+	op_fadd_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val + proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fsub_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val - proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fmul_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fdiv_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val / proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fsgnj_d: {
+		proc.freg[dec.rd].r.lu.val = (proc.freg[dec.rs1].r.lu.val & u64(~(1ULL<<63))) | (proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		return pc_offset;
+	}
+	op_fsgnjn_d: {
+		proc.freg[dec.rd].r.lu.val = (proc.freg[dec.rs1].r.lu.val & u64(~(1ULL<<63))) | (~proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		return pc_offset;
+	}
+	op_fsgnjx_d: {
+		proc.freg[dec.rd].r.lu.val = proc.freg[dec.rs1].r.lu.val ^ (proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		return pc_offset;
+	}
+	op_fmin_d: {
+		proc.freg[dec.rd].r.d.val = (proc.freg[dec.rs1].r.d.val < proc.freg[dec.rs2].r.d.val) || std::isnan(proc.freg[dec.rs2].r.d.val) ? proc.freg[dec.rs1].r.d.val : proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fmax_d: {
+		proc.freg[dec.rd].r.d.val = (proc.freg[dec.rs1].r.d.val > proc.freg[dec.rs2].r.d.val) || std::isnan(proc.freg[dec.rs2].r.d.val) ? proc.freg[dec.rs1].r.d.val : proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fcvt_s_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fcvt_d_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fsqrt_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = riscv::f64_sqrt(proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fle_d: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val <= proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_flt_d: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val < proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_feq_d: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val == proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fcvt_w_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_w(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fcvt_wu_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_wu(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fcvt_d_w: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.w.val);
+		return pc_offset;
+	}
+	op_fcvt_d_wu: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.wu.val);
+		return pc_offset;
+	}
+	op_fclass_d: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : f64_classify(proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fcvt_l_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_l(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fcvt_lu_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_lu(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fmv_x_d: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : std::isnan(proc.freg[dec.rs1].r.d.val) ? s64(0x7ff8000000000000ULL) : proc.freg[dec.rs1].r.l.val;
+		return pc_offset;
+	}
+	op_fcvt_d_l: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.l.val);
+		return pc_offset;
+	}
+	op_fcvt_d_lu: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.lu.val);
+		return pc_offset;
+	}
+	op_fmv_d_x: {
+		proc.freg[dec.rd].r.lu.val = proc.ireg[dec.rs1].r.lu.val;
+		return pc_offset;
+	}
+	illegal:
+		return -1; /* illegal instruction */
+}
+
+/* Execute Block RV64 (threaded) */
+
+template <bool rvi, bool rvm, bool rva, bool rvs, bool rvf, bool rvd, bool rvq, bool rvc, typename B, typename T, typename P>
+size_t exec_block_rv64(B *insts, size_t count, T *&cur, P &proc, typename P::ux inststop)
+{
+	using namespace riscv;
+	enum { xlen = 64 };
+	typedef s64 sx;
+	typedef u64 ux;
+
+	static const void* dispatch[] = {
+		&&unhandled,
+		rvi ? &&op_lui : &&unhandled,
+		rvi ? &&op_auipc : &&unhandled,
+		rvi ? &&op_jal : &&unhandled,
+		rvi ? &&op_jalr : &&unhandled,
+		rvi ? &&op_beq : &&unhandled,
+		rvi ? &&op_bne : &&unhandled,
+		rvi ? &&op_blt : &&unhandled,
+		rvi ? &&op_bge : &&unhandled,
+		rvi ? &&op_bltu : &&unhandled,
+		rvi ? &&op_bgeu : &&unhandled,
+		rvi ? &&op_lb : &&unhandled,
+		rvi ? &&op_lh : &&unhandled,
+		rvi ? &&op_lw : &&unhandled,
+		rvi ? &&op_lbu : &&unhandled,
+		rvi ? &&op_lhu : &&unhandled,
+		rvi ? &&op_sb : &&unhandled,
+		rvi ? &&op_sh : &&unhandled,
+		rvi ? &&op_sw : &&unhandled,
+		rvi ? &&op_addi : &&unhandled,
+		rvi ? &&op_slti : &&unhandled,
+		rvi ? &&op_sltiu : &&unhandled,
+		rvi ? &&op_xori : &&unhandled,
+		rvi ? &&op_ori : &&unhandled,
+		rvi ? &&op_andi : &&unhandled,
+		rvi ? &&op_slli : &&unhandled,
+		rvi ? &&op_srli : &&unhandled,
+		rvi ? &&op_srai : &&unhandled,
+		rvi ? &&op_add : &&unhandled,
+		rvi ? &&op_sub : &&unhandled,
+		rvi ? &&op_sll : &&unhandled,
+		rvi ? &&op_slt : &&unhandled,
+		rvi ? &&op_sltu : &&unhandled,
+		rvi ? &&op_xor : &&unhandled,
+		rvi ? &&op_srl : &&unhandled,
+		rvi ? &&op_sra : &&unhandled,
+		rvi ? &&op_or : &&unhandled,
+		rvi ? &&op_and : &&unhandled,
+		&&unhandled,
+		&&unhandled,
+		rvi ? &&op_lwu : &&unhandled,
+		rvi ? &&op_ld : &&unhandled,
+		rvi ? &&op_sd : &&unhandled,
+		rvi ? &&op_addiw : &&unhandled,
+		rvi ? &&op_slliw : &&unhandled,
+		rvi ? &&op_srliw : &&unhandled,
+		rvi ? &&op_sraiw : &&unhandled,
+		rvi ? &&op_addw : &&unhandled,
+		rvi ? &&op_subw : &&unhandled,
+		rvi ? &&op_sllw : &&unhandled,
+		rvi ? &&op_srlw : &&unhandled,
+		rvi ? &&op_sraw : &&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		rvm ? &&op_mul : &&unhandled,
+		rvm ? &&op_mulh : &&unhandled,
+		rvm ? &&op_mulhsu : &&unhandled,
+		rvm ? &&op_mulhu : &&unhandled,
+		rvm ? &&op_div : &&unhandled,
+		rvm ? &&op_divu : &&unhandled,
+		rvm ? &&op_rem : &&unhandled,
+		rvm ? &&op_remu : &&unhandled,
+		rvm ? &&op_mulw : &&unhandled,
+		rvm ? &&op_divw : &&unhandled,
+		rvm ? &&op_divuw : &&unhandled,
+		rvm ? &&op_remw : &&unhandled,
+		rvm ? &&op_remuw : &&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		rva ? &&op_lr_w : &&unhandled,
+		rva ? &&op_sc_w : &&unhandled,
+		rva ? &&op_amoswap_w : &&unhandled,
+		rva ? &&op_amoadd_w : &&unhandled,
+		rva ? &&op_amoxor_w : &&unhandled,
+		rva ? &&op_amoor_w : &&unhandled,
+		rva ? &&op_amoand_w : &&unhandled,
+		rva ? &&op_amomin_w : &&unhandled,
+		rva ? &&op_amomax_w : &&unhandled,
+		rva ? &&op_amominu_w : &&unhandled,
+		rva ? &&op_amomaxu_w : &&unhandled,
+		rva ? &&op_lr_d : &&unhandled,
+		rva ? &&op_sc_d : &&unhandled,
+		rva ? &&op_amoswap_d : &&unhandled,
+		rva ? &&op_amoadd_d : &&unhandled,
+		rva ? &&op_amoxor_d : &&unhandled,
+		rva ? &&op_amoor_d : &&unhandled,
+		rva ? &&op_amoand_d : &&unhandled,
+		rva ? &&op_amomin_d : &&unhandled,
+		rva ? &&op_amomax_d : &&unhandled,
+		rva ? &&op_amominu_d : &&unhandled,
+		rva ? &&op_amomaxu_d : &&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		rvf ? &&op_flw : &&unhandled,
+		rvf ? &&op_fsw : &&unhandled,
+		rvf ? &&op_fmadd_s : &&unhandled,
+		rvf ? &&op_fmsub_s : &&unhandled,
+		rvf ? &&op_fnmsub_s : &&unhandled,
+		rvf ? &&op_fnmadd_s : &&unhandled,
+		rvf ? &&op_fadd_s : &&unhandled,
+		rvf ? &&op_fsub_s : &&unhandled,
+		rvf ? &&op_fmul_s : &&unhandled,
+		rvf ? &&op_fdiv_s : &&unhandled,
+		rvf ? &&op_fsgnj_s : &&unhandled,
+		rvf ? &&op_fsgnjn_s : &&unhandled,
+		rvf ? &&op_fsgnjx_s : &&unhandled,
+		rvf ? &&op_fmin_s : &&unhandled,
+		rvf ? &&op_fmax_s : &&unhandled,
+		rvf ? &&op_fsqrt_s : &&unhandled,
+		rvf ? &&op_fle_s : &&unhandled,
+		rvf ? &&op_flt_s : &&unhandled,
+		rvf ? &&op_feq_s : &&unhandled,
+		rvf ? &&op_fcvt_w_s : &&unhandled,
+		rvf ? &&op_fcvt_wu_s : &&unhandled,
+		rvf ? &&op_fcvt_s_w : &&unhandled,
+		rvf ? &&op_fcvt_s_wu : &&unhandled,
+		rvf ? &&op_fmv_x_s : &&unhandled,
+		rvf ? &&op_fclass_s : &&unhandled,
+		rvf ? &&op_fmv_s_x : &&unhandled,
+		rvf ? &&op_fcvt_l_s : &&unhandled,
+		rvf ? &&op_fcvt_lu_s : &&unhandled,
+		rvf ? &&op_fcvt_s_l : &&unhandled,
+		rvf ? &&op_fcvt_s_lu : &&unhandled,
+		rvd ? &&op_fld : &&unhandled,
+		rvd ? &&op_fsd : &&unhandled,
+		rvd ? &&op_fmadd_d : &&unhandled,
+		rvd ? &&op_fmsub_d : &&unhandled,
+		rvd ? &&op_fnmsub_d : &&unhandled,
+		rvd ? &&op_fnmadd_d : &&unhandled,
+		rvd ? &&op_fadd_d : &&unhandled,
+		rvd ? &&op_fsub_d : &&unhandled,
+		rvd ? &&op_fmul_d : &&unhandled,
+		rvd ? &&op_fdiv_d : &&unhandled,
+		rvd ? &&op_fsgnj_d : &&unhandled,
+		rvd ? &&op_fsgnjn_d : &&unhandled,
+		rvd ? &&op_fsgnjx_d : &&unhandled,
+		rvd ? &&op_fmin_d : &&unhandled,
+		rvd ? &&op_fmax_d : &&unhandled,
+		rvd ? &&op_fcvt_s_d : &&unhandled,
+		rvd ? &&op_fcvt_d_s : &&unhandled,
+		rvd ? &&op_fsqrt_d : &&unhandled,
+		rvd ? &&op_fle_d : &&unhandled,
+		rvd ? &&op_flt_d : &&unhandled,
+		rvd ? &&op_feq_d : &&unhandled,
+		rvd ? &&op_fcvt_w_d : &&unhandled,
+		rvd ? &&op_fcvt_wu_d : &&unhandled,
+		rvd ? &&op_fcvt_d_w : &&unhandled,
+		rvd ? &&op_fcvt_d_wu : &&unhandled,
+		rvd ? &&op_fclass_d : &&unhandled,
+		rvd ? &&op_fcvt_l_d : &&unhandled,
+		rvd ? &&op_fcvt_lu_d : &&unhandled,
+		rvd ? &&op_fmv_x_d : &&unhandled,
+		rvd ? &&op_fcvt_d_l : &&unhandled,
+		rvd ? &&op_fcvt_d_lu : &&unhandled,
+		rvd ? &&op_fmv_d_x : &&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+	};
+
+	size_t i = 0;
+	cur = &insts[0].dec;
+	typename P::ux pc_offset = insts[0].len;
+	goto *dispatch[cur->op];
+	op_lui: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_auipc: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_jal: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + pc_offset; pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_jalr: {
+		T &dec = *cur;
+		ux new_offset = (proc.ireg[dec.rs1] + dec.imm - proc.pc) & ~1; proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + pc_offset; pc_offset = new_offset;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_beq: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.x.val == proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_bne: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.x.val != proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_blt: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.x.val < proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_bge: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.x.val >= proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_bltu: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.xu.val < proc.ireg[dec.rs2].r.xu.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_bgeu: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.xu.val >= proc.ireg[dec.rs2].r.xu.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lb: {
+		T &dec = *cur;
+		s8 t; proc.mmu.template load<P,s8>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lh: {
+		T &dec = *cur;
+		s16 t; proc.mmu.template load<P,s16>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lw: {
+		T &dec = *cur;
+		s32 t; proc.mmu.template load<P,s32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lbu: {
+		T &dec = *cur;
+		u8 t; proc.mmu.template load<P,u8>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lhu: {
+		T &dec = *cur;
+		u16 t; proc.mmu.template load<P,u16>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sb: {
+		T &dec = *cur;
+		proc.mmu.template store<P,s8>(proc, proc.ireg[dec.rs1] + dec.imm, s8(proc.ireg[dec.rs2]));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sh: {
+		T &dec = *cur;
+		proc.mmu.template store<P,s16>(proc, proc.ireg[dec.rs1] + dec.imm, s16(proc.ireg[dec.rs2]));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sw: {
+		T &dec = *cur;
+		proc.mmu.template store<P,s32>(proc, proc.ireg[dec.rs1] + dec.imm, proc.ireg[dec.rs2].r.w.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_addi: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val + sx(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_slti: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val < sx(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sltiu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val < ux(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_xori: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val ^ ux(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_ori: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val | ux(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_andi: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val & ux(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_add: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val + proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sub: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val - proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sll: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val << (proc.ireg[dec.rs2] & 0b1111111);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_slt: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val < proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sltu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val < proc.ireg[dec.rs2].r.xu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_xor: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val ^ proc.ireg[dec.rs2].r.xu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_srl: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val >> (proc.ireg[dec.rs2] & 0b1111111);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sra: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val >> (proc.ireg[dec.rs2] & 0b1111111);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_or: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val | proc.ireg[dec.rs2].r.xu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_and: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val & proc.ireg[dec.rs2].r.xu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lwu: {
+		T &dec = *cur;
+		u32 t; proc.mmu.template load<P,u32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_ld: {
+		T &dec = *cur;
+		s64 t; proc.mmu.template load<P,s64>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sd: {
+		T &dec = *cur;
+		proc.mmu.template store<P,s64>(proc, proc.ireg[dec.rs1] + dec.imm, proc.ireg[dec.rs2].r.l.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_slli: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val << dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_srli: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val >> dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_srai: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val >> dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_addiw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val + dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_slliw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val << dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_srliw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val >> dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sraiw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.w.val >> dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_addw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val + proc.ireg[dec.rs2].r.w.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_subw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val - proc.ireg[dec.rs2].r.w.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sllw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val << (proc.ireg[dec.rs2] & 0b11111));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_srlw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val >> (proc.ireg[dec.rs2] & 0b11111));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sraw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val >> (proc.ireg[dec.rs2] & 0b11111));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_mul: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val * proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_mulh: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulh(proc.ireg[dec.rs1].r.x.val, proc.ireg[dec.rs2].r.x.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_mulhsu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulhsu(proc.ireg[dec.rs1].r.x.val, proc.ireg[dec.rs2].r.xu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_mulhu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulhu(proc.ireg[dec.rs1].r.xu.val, proc.ireg[dec.rs2].r.xu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_div: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val == std::numeric_limits<sx>::min() && proc.ireg[dec.rs2].r.x.val == -1 ? std::numeric_limits<sx>::min() : proc.ireg[dec.rs2].r.x.val == 0 ? -1 : proc.ireg[dec.rs1].r.x.val / proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_divu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? -1 : sx(proc.ireg[dec.rs1].r.xu.val / proc.ireg[dec.rs2].r.xu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_rem: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val == std::numeric_limits<sx>::min() && proc.ireg[dec.rs2].r.x.val == -1 ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? proc.ireg[dec.rs1].r.x.val : proc.ireg[dec.rs1].r.x.val % proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_remu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? proc.ireg[dec.rs1].r.x.val : sx(proc.ireg[dec.rs1].r.xu.val % proc.ireg[dec.rs2].r.xu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_mulw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val * proc.ireg[dec.rs2].r.wu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_divw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.w.val == std::numeric_limits<s32>::min() && proc.ireg[dec.rs2].r.w.val == -1 ? std::numeric_limits<s32>::min() : proc.ireg[dec.rs2].r.w.val == 0 ? -1 : proc.ireg[dec.rs1].r.w.val / proc.ireg[dec.rs2].r.w.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_divuw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.w.val == 0 ? -1 : s32(proc.ireg[dec.rs1].r.wu.val / proc.ireg[dec.rs2].r.wu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_remw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.w.val == std::numeric_limits<s32>::min() && proc.ireg[dec.rs2].r.w.val == -1 ? 0 : proc.ireg[dec.rs2].r.w.val == 0 ? proc.ireg[dec.rs1].r.w.val : proc.ireg[dec.rs1].r.w.val % proc.ireg[dec.rs2].r.w.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_remuw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.w.val == 0 ? proc.ireg[dec.rs1].r.w.val : s32(proc.ireg[dec.rs1].r.wu.val % proc.ireg[dec.rs2].r.wu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lr_w: {
+		T &dec = *cur;
+		s32 t; proc.mmu.template load_reserved<P,s32>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sc_w: {
+		T &dec = *cur;
+		ux res = proc.mmu.template store_conditional<P,s32>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.w.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoswap_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoswap, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoadd_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoadd, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoxor_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoxor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoor_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoand_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoand, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amomin_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomin, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amomax_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomax, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amominu_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amominu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amomaxu_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomaxu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lr_d: {
+		T &dec = *cur;
+		s64 t; proc.mmu.template load_reserved<P,s64>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sc_d: {
+		T &dec = *cur;
+		ux res = proc.mmu.template store_conditional<P,s64>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.l.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoswap_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoswap, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoadd_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoadd, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoxor_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoxor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoor_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoand_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoand, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amomin_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amomin, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amomax_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amomax, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amominu_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amominu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amomaxu_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amomaxu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_flw: {
+		T &dec = *cur;
+		u32 t; proc.mmu.template load<P,u32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.freg[dec.rd].r.wu.val = t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsw: {
+		T &dec = *cur;
+		proc.mmu.template store<P,f32>(proc, proc.ireg[dec.rs1] + dec.imm, proc.freg[dec.rs2].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmadd_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val + proc.freg[dec.rs3].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmsub_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val - proc.freg[dec.rs3].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fnmsub_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * -proc.freg[dec.rs2].r.s.val + proc.freg[dec.rs3].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fnmadd_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * -proc.freg[dec.rs2].r.s.val - proc.freg[dec.rs3].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fadd_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val + proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsub_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val - proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmul_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fdiv_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val / proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnj_s: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.wu.val = (proc.freg[dec.rs1].r.wu.val & u32(~(1U<<31))) | (proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnjn_s: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.wu.val = (proc.freg[dec.rs1].r.wu.val & u32(~(1U<<31))) | (~proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnjx_s: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.wu.val = proc.freg[dec.rs1].r.wu.val ^ (proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmin_s: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.s.val = (proc.freg[dec.rs1].r.s.val < proc.freg[dec.rs2].r.s.val) || std::isnan(proc.freg[dec.rs2].r.s.val) ? proc.freg[dec.rs1].r.s.val : proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmax_s: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.s.val = (proc.freg[dec.rs1].r.s.val > proc.freg[dec.rs2].r.s.val) || std::isnan(proc.freg[dec.rs2].r.s.val) ? proc.freg[dec.rs1].r.s.val : proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsqrt_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = riscv::f32_sqrt(proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fle_s: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val <= proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_flt_s: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val < proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_feq_s: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val == proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_w_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_w(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_wu_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_wu(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_s_w: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.w.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_s_wu: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.wu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmv_x_s: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : std::isnan(proc.freg[dec.rs1].r.s.val) ? s32(0x7fc00000) : proc.freg[dec.rs1].r.w.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fclass_s: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : f32_classify(proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmv_s_x: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.wu.val = proc.ireg[dec.rs1].r.wu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_l_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_l(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_lu_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_lu(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_s_l: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.l.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_s_lu: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.lu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fld: {
+		T &dec = *cur;
+		u64 t; proc.mmu.template load<P,u64>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.freg[dec.rd].r.lu.val = t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsd: {
+		T &dec = *cur;
+		proc.mmu.template store<P,f64>(proc, proc.ireg[dec.rs1] + dec.imm, proc.freg[dec.rs2].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmadd_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val + proc.freg[dec.rs3].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmsub_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val - proc.freg[dec.rs3].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fnmsub_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * -proc.freg[dec.rs2].r.d.val + proc.freg[dec.rs3].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fnmadd_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * -proc.freg[dec.rs2].r.d.val - proc.freg[dec.rs3].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fadd_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val + proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsub_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val - proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmul_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fdiv_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val / proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnj_d: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.lu.val = (proc.freg[dec.rs1].r.lu.val & u64(~(1ULL<<63))) | (proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnjn_d: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.lu.val = (proc.freg[dec.rs1].r.lu.val & u64(~(1ULL<<63))) | (~proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnjx_d: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.lu.val = proc.freg[dec.rs1].r.lu.val ^ (proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmin_d: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.d.val = (proc.freg[dec.rs1].r.d.val < proc.freg[dec.rs2].r.d.val) || std::isnan(proc.freg[dec.rs2].r.d.val) ? proc.freg[dec.rs1].r.d.val : proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmax_d: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.d.val = (proc.freg[dec.rs1].r.d.val > proc.freg[dec.rs2].r.d.val) || std::isnan(proc.freg[dec.rs2].r.d.val) ? proc.freg[dec.rs1].r.d.val : proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_s_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_d_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsqrt_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = riscv::f64_sqrt(proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fle_d: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val <= proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_flt_d: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val < proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_feq_d: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val == proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_w_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_w(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_wu_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_wu(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_d_w: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.w.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_d_wu: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.wu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fclass_d: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : f64_classify(proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_l_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_l(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_lu_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_lu(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmv_x_d: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : std::isnan(proc.freg[dec.rs1].r.d.val) ? s64(0x7ff8000000000000ULL) : proc.freg[dec.rs1].r.l.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_d_l: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.l.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_d_lu: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.lu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmv_d_x: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.lu.val = proc.ireg[dec.rs1].r.lu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	unhandled:
+		return i; /* executed by the runloop */
 }
 
+#else
+
 /* Execute Instruction RV64 */
 
 template <bool rvi, bool rvm, bool rva, bool rvs, bool rvf, bool rvd, bool rvq, bool rvc, typename T, typename P>
@@ -886,12 +5806,12 @@ typename P::ux exec_inst_rv64(T &dec, P &proc, typename P::ux pc_offset)
 			break;
 		case rv_op_lr_w:
 			if (rva) {
-				proc.lr = proc.ireg[dec.rs1]; s32 t; proc.mmu.template load<P,s32>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+				s32 t; proc.mmu.template load_reserved<P,s32>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
 			};
 			break;
 		case rv_op_sc_w:
 			if (rva) {
-				ux res = 0; if (proc.lr != proc.ireg[dec.rs1]) res = 1; else proc.mmu.template store<P,s32>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.w.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
+				ux res = proc.mmu.template store_conditional<P,s32>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.w.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
 			};
 			break;
 		case rv_op_amoswap_w:
@@ -941,12 +5861,12 @@ typename P::ux exec_inst_rv64(T &dec, P &proc, typename P::ux pc_offset)
 			break;
 		case rv_op_lr_d:
 			if (rva) {
-				proc.lr = proc.ireg[dec.rs1]; s64 t; proc.mmu.template load<P,s64>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+				s64 t; proc.mmu.template load_reserved<P,s64>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
 			};
 			break;
 		case rv_op_sc_d:
 			if (rva) {
-				ux res = 0; if (proc.lr != proc.ireg[dec.rs1]) res = 1; else proc.mmu.template store<P,s64>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.l.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
+				ux res = proc.mmu.template store_conditional<P,s64>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.l.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
 			};
 			break;
 		case rv_op_amoswap_d:
@@ -1306,9 +6226,2736 @@ typename P::ux exec_inst_rv64(T &dec, P &proc, typename P::ux pc_offset)
 			break;
 		default: return -1; /* illegal instruction */
 	}
-	return pc_offset;
+	return pc_offset;
+}
+
+#endif
+
+#if defined (ENABLE_THREADED_INTERP)
+
+/* Execute Instruction RV128 (threaded) */
+
+template <bool rvi, bool rvm, bool rva, bool rvs, bool rvf, bool rvd, bool rvq, bool rvc, typename T, typename P>
+typename P::ux exec_inst_rv128(T &dec, P &proc, typename P::ux pc_offset)
+{
+	using namespace riscv;
+	enum { xlen = 128 };
+	typedef s128 sx;
+	typedef u128 ux;
+
+	static const void* dispatch[] = {
+		&&illegal,
+		rvi ? &&op_lui : &&illegal,
+		rvi ? &&op_auipc : &&illegal,
+		rvi ? &&op_jal : &&illegal,
+		rvi ? &&op_jalr : &&illegal,
+		rvi ? &&op_beq : &&illegal,
+		rvi ? &&op_bne : &&illegal,
+		rvi ? &&op_blt : &&illegal,
+		rvi ? &&op_bge : &&illegal,
+		rvi ? &&op_bltu : &&illegal,
+		rvi ? &&op_bgeu : &&illegal,
+		rvi ? &&op_lb : &&illegal,
+		rvi ? &&op_lh : &&illegal,
+		rvi ? &&op_lw : &&illegal,
+		rvi ? &&op_lbu : &&illegal,
+		rvi ? &&op_lhu : &&illegal,
+		rvi ? &&op_sb : &&illegal,
+		rvi ? &&op_sh : &&illegal,
+		rvi ? &&op_sw : &&illegal,
+		rvi ? &&op_addi : &&illegal,
+		rvi ? &&op_slti : &&illegal,
+		rvi ? &&op_sltiu : &&illegal,
+		rvi ? &&op_xori : &&illegal,
+		rvi ? &&op_ori : &&illegal,
+		rvi ? &&op_andi : &&illegal,
+		rvi ? &&op_slli : &&illegal,
+		rvi ? &&op_srli : &&illegal,
+		rvi ? &&op_srai : &&illegal,
+		rvi ? &&op_add : &&illegal,
+		rvi ? &&op_sub : &&illegal,
+		rvi ? &&op_sll : &&illegal,
+		rvi ? &&op_slt : &&illegal,
+		rvi ? &&op_sltu : &&illegal,
+		rvi ? &&op_xor : &&illegal,
+		rvi ? &&op_srl : &&illegal,
+		rvi ? &&op_sra : &&illegal,
+		rvi ? &&op_or : &&illegal,
+		rvi ? &&op_and : &&illegal,
+		&&illegal,
+		&&illegal,
+		rvi ? &&op_lwu : &&illegal,
+		rvi ? &&op_ld : &&illegal,
+		rvi ? &&op_sd : &&illegal,
+		rvi ? &&op_addiw : &&illegal,
+		rvi ? &&op_slliw : &&illegal,
+		rvi ? &&op_srliw : &&illegal,
+		rvi ? &&op_sraiw : &&illegal,
+		rvi ? &&op_addw : &&illegal,
+		rvi ? &&op_subw : &&illegal,
+		rvi ? &&op_sllw : &&illegal,
+		rvi ? &&op_srlw : &&illegal,
+		rvi ? &&op_sraw : &&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		rvm ? &&op_mul : &&illegal,
+		rvm ? &&op_mulh : &&illegal,
+		rvm ? &&op_mulhsu : &&illegal,
+		rvm ? &&op_mulhu : &&illegal,
+		rvm ? &&op_div : &&illegal,
+		rvm ? &&op_divu : &&illegal,
+		rvm ? &&op_rem : &&illegal,
+		rvm ? &&op_remu : &&illegal,
+		rvm ? &&op_mulw : &&illegal,
+		rvm ? &&op_divw : &&illegal,
+		rvm ? &&op_divuw : &&illegal,
+		rvm ? &&op_remw : &&illegal,
+		rvm ? &&op_remuw : &&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		rva ? &&op_lr_w : &&illegal,
+		rva ? &&op_sc_w : &&illegal,
+		rva ? &&op_amoswap_w : &&illegal,
+		rva ? &&op_amoadd_w : &&illegal,
+		rva ? &&op_amoxor_w : &&illegal,
+		rva ? &&op_amoor_w : &&illegal,
+		rva ? &&op_amoand_w : &&illegal,
+		rva ? &&op_amomin_w : &&illegal,
+		rva ? &&op_amomax_w : &&illegal,
+		rva ? &&op_amominu_w : &&illegal,
+		rva ? &&op_amomaxu_w : &&illegal,
+		rva ? &&op_lr_d : &&illegal,
+		rva ? &&op_sc_d : &&illegal,
+		rva ? &&op_amoswap_d : &&illegal,
+		rva ? &&op_amoadd_d : &&illegal,
+		rva ? &&op_amoxor_d : &&illegal,
+		rva ? &&op_amoor_d : &&illegal,
+		rva ? &&op_amoand_d : &&illegal,
+		rva ? &&op_amomin_d : &&illegal,
+		rva ? &&op_amomax_d : &&illegal,
+		rva ? &&op_amominu_d : &&illegal,
+		rva ? &&op_amomaxu_d : &&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		rvf ? &&op_flw : &&illegal,
+		rvf ? &&op_fsw : &&illegal,
+		rvf ? &&op_fmadd_s : &&illegal,
+		rvf ? &&op_fmsub_s : &&illegal,
+		rvf ? &&op_fnmsub_s : &&illegal,
+		rvf ? &&op_fnmadd_s : &&illegal,
+		rvf ? &&op_fadd_s : &&illegal,
+		rvf ? &&op_fsub_s : &&illegal,
+		rvf ? &&op_fmul_s : &&illegal,
+		rvf ? &&op_fdiv_s : &&illegal,
+		rvf ? &&op_fsgnj_s : &&illegal,
+		rvf ? &&op_fsgnjn_s : &&illegal,
+		rvf ? &&op_fsgnjx_s : &&illegal,
+		rvf ? &&op_fmin_s : &&illegal,
+		rvf ? &&op_fmax_s : &&illegal,
+		rvf ? &&op_fsqrt_s : &&illegal,
+		rvf ? &&op_fle_s : &&illegal,
+		rvf ? &&op_flt_s : &&illegal,
+		rvf ? &&op_feq_s : &&illegal,
+		rvf ? &&op_fcvt_w_s : &&illegal,
+		rvf ? &&op_fcvt_wu_s : &&illegal,
+		rvf ? &&op_fcvt_s_w : &&illegal,
+		rvf ? &&op_fcvt_s_wu : &&illegal,
+		rvf ? &&op_fmv_x_s : &&illegal,
+		rvf ? &&op_fclass_s : &&illegal,
+		rvf ? &&op_fmv_s_x : &&illegal,
+		rvf ? &&op_fcvt_l_s : &&illegal,
+		rvf ? &&op_fcvt_lu_s : &&illegal,
+		rvf ? &&op_fcvt_s_l : &&illegal,
+		rvf ? &&op_fcvt_s_lu : &&illegal,
+		rvd ? &&op_fld : &&illegal,
+		rvd ? &&op_fsd : &&illegal,
+		rvd ? &&op_fmadd_d : &&illegal,
+		rvd ? &&op_fmsub_d : &&illegal,
+		rvd ? &&op_fnmsub_d : &&illegal,
+		rvd ? &&op_fnmadd_d : &&illegal,
+		rvd ? &&op_fadd_d : &&illegal,
+		rvd ? &&op_fsub_d : &&illegal,
+		rvd ? &&op_fmul_d : &&illegal,
+		rvd ? &&op_fdiv_d : &&illegal,
+		rvd ? &&op_fsgnj_d : &&illegal,
+		rvd ? &&op_fsgnjn_d : &&illegal,
+		rvd ? &&op_fsgnjx_d : &&illegal,
+		rvd ? &&op_fmin_d : &&illegal,
+		rvd ? &&op_fmax_d : &&illegal,
+		rvd ? &&op_fcvt_s_d : &&illegal,
+		rvd ? &&op_fcvt_d_s : &&illegal,
+		rvd ? &&op_fsqrt_d : &&illegal,
+		rvd ? &&op_fle_d : &&illegal,
+		rvd ? &&op_flt_d : &&illegal,
+		rvd ? &&op_feq_d : &&illegal,
+		rvd ? &&op_fcvt_w_d : &&illegal,
+		rvd ? &&op_fcvt_wu_d : &&illegal,
+		rvd ? &&op_fcvt_d_w : &&illegal,
+		rvd ? &&op_fcvt_d_wu : &&illegal,
+		rvd ? &&op_fclass_d : &&illegal,
+		rvd ? &&op_fcvt_l_d : &&illegal,
+		rvd ? &&op_fcvt_lu_d : &&illegal,
+		rvd ? &&op_fmv_x_d : &&illegal,
+		rvd ? &&op_fcvt_d_l : &&illegal,
+		rvd ? &&op_fcvt_d_lu : &&illegal,
+		rvd ? &&op_fmv_d_x : &&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+		&&illegal,
+	};
+
+	goto *dispatch[dec.op];
+	op_lui: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : dec.imm;
+		return pc_offset;
+	}
+	op_auipc: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + dec.imm;
+		return pc_offset;
+	}
+	op_jal: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + pc_offset; pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_jalr: {
+		ux new_offset = (proc.ireg[dec.rs1] + dec.imm - proc.pc) & ~1; proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + pc_offset; pc_offset = new_offset;
+		return pc_offset;
+	}
+	op_beq: {
+		if (proc.ireg[dec.rs1].r.x.val == proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_bne: {
+		if (proc.ireg[dec.rs1].r.x.val != proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_blt: {
+		if (proc.ireg[dec.rs1].r.x.val < proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_bge: {
+		if (proc.ireg[dec.rs1].r.x.val >= proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_bltu: {
+		if (proc.ireg[dec.rs1].r.xu.val < proc.ireg[dec.rs2].r.xu.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_bgeu: {
+		if (proc.ireg[dec.rs1].r.xu.val >= proc.ireg[dec.rs2].r.xu.val) pc_offset = dec.imm;
+		return pc_offset;
+	}
+	op_lb: {
+		s8 t; proc.mmu.template load<P,s8>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_lh: {
+		s16 t; proc.mmu.template load<P,s16>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_lw: {
+		s32 t; proc.mmu.template load<P,s32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_lbu: {
+		u8 t; proc.mmu.template load<P,u8>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_lhu: {
+		u16 t; proc.mmu.template load<P,u16>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_sb: {
+		proc.mmu.template store<P,s8>(proc, proc.ireg[dec.rs1] + dec.imm, s8(proc.ireg[dec.rs2]));
+		return pc_offset;
+	}
+	op_sh: {
+		proc.mmu.template store<P,s16>(proc, proc.ireg[dec.rs1] + dec.imm, s16(proc.ireg[dec.rs2]));
+		return pc_offset;
+	}
+	op_sw: {
+		proc.mmu.template store<P,s32>(proc, proc.ireg[dec.rs1] + dec.imm, proc.ireg[dec.rs2].r.w.val);
+		return pc_offset;
+	}
+	op_addi: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val + sx(dec.imm);
+		return pc_offset;
+	}
+	op_slti: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val < sx(dec.imm);
+		return pc_offset;
+	}
+	op_sltiu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val < ux(dec.imm);
+		return pc_offset;
+	}
+	op_xori: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val ^ ux(dec.imm);
+		return pc_offset;
+	}
+	op_ori: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val | ux(dec.imm);
+		return pc_offset;
+	}
+	op_andi: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val & ux(dec.imm);
+		return pc_offset;
+	}
+	op_add: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val + proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_sub: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val - proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_sll: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val << (proc.ireg[dec.rs2] & 0b1111111);
+		return pc_offset;
+	}
+	op_slt: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val < proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_sltu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val < proc.ireg[dec.rs2].r.xu.val;
+		return pc_offset;
+	}
+	op_xor: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val ^ proc.ireg[dec.rs2].r.xu.val;
+		return pc_offset;
+	}
+	op_srl: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val >> (proc.ireg[dec.rs2] & 0b1111111);
+		return pc_offset;
+	}
+	op_sra: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val >> (proc.ireg[dec.rs2] & 0b1111111);
+		return pc_offset;
+	}
+	op_or: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val | proc.ireg[dec.rs2].r.xu.val;
+		return pc_offset;
+	}
+	op_and: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val & proc.ireg[dec.rs2].r.xu.val;
+		return pc_offset;
+	}
+	op_lwu: {
+		u32 t; proc.mmu.template load<P,u32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_ld: {
+		s64 t; proc.mmu.template load<P,s64>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_sd: {
+		proc.mmu.template store<P,s64>(proc, proc.ireg[dec.rs1] + dec.imm, proc.ireg[dec.rs2].r.l.val);
+		return pc_offset;
+	}
+	op_addiw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val + dec.imm);
+		return pc_offset;
+	}
+	op_slliw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val << dec.imm);
+		return pc_offset;
+	}
+	op_srliw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val >> dec.imm);
+		return pc_offset;
+	}
+	op_sraiw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.w.val >> dec.imm;
+		return pc_offset;
+	}
+	op_addw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val + proc.ireg[dec.rs2].r.w.val);
+		return pc_offset;
+	}
+	op_subw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val - proc.ireg[dec.rs2].r.w.val);
+		return pc_offset;
+	}
+	op_sllw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val << (proc.ireg[dec.rs2] & 0b11111));
+		return pc_offset;
+	}
+	op_srlw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val >> (proc.ireg[dec.rs2] & 0b11111));
+		return pc_offset;
+	}
+	op_sraw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val >> (proc.ireg[dec.rs2] & 0b11111));
+		return pc_offset;
+	}
+	op_slli: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val << dec.imm;
+		return pc_offset;
+	}
+	op_srli: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val >> dec.imm;
+		return pc_offset;
+	}
+	op_srai: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val >> dec.imm;
+		return pc_offset;
+	}
+	op_mul: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val * proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_mulh: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulh(proc.ireg[dec.rs1].r.x.val, proc.ireg[dec.rs2].r.x.val);
+		return pc_offset;
+	}
+	op_mulhsu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulhsu(proc.ireg[dec.rs1].r.x.val, proc.ireg[dec.rs2].r.xu.val);
+		return pc_offset;
+	}
+	op_mulhu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulhu(proc.ireg[dec.rs1].r.xu.val, proc.ireg[dec.rs2].r.xu.val);
+		return pc_offset;
+	}
+	op_div: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val == std::numeric_limits<sx>::min() && proc.ireg[dec.rs2].r.x.val == -1 ? std::numeric_limits<sx>::min() : proc.ireg[dec.rs2].r.x.val == 0 ? -1 : proc.ireg[dec.rs1].r.x.val / proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_divu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? -1 : sx(proc.ireg[dec.rs1].r.xu.val / proc.ireg[dec.rs2].r.xu.val);
+		return pc_offset;
+	}
+	op_rem: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val == std::numeric_limits<sx>::min() && proc.ireg[dec.rs2].r.x.val == -1 ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? proc.ireg[dec.rs1].r.x.val : proc.ireg[dec.rs1].r.x.val % proc.ireg[dec.rs2].r.x.val;
+		return pc_offset;
+	}
+	op_remu: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? proc.ireg[dec.rs1].r.x.val : sx(proc.ireg[dec.rs1].r.xu.val % proc.ireg[dec.rs2].r.xu.val);
+		return pc_offset;
+	}
+	op_mulw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val * proc.ireg[dec.rs2].r.wu.val);
+		return pc_offset;
+	}
+	op_divw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.w.val == std::numeric_limits<s32>::min() && proc.ireg[dec.rs2].r.w.val == -1 ? std::numeric_limits<s32>::min() : proc.ireg[dec.rs2].r.w.val == 0 ? -1 : proc.ireg[dec.rs1].r.w.val / proc.ireg[dec.rs2].r.w.val;
+		return pc_offset;
+	}
+	op_divuw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.w.val == 0 ? -1 : s32(proc.ireg[dec.rs1].r.wu.val / proc.ireg[dec.rs2].r.wu.val);
+		return pc_offset;
+	}
+	op_remw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.w.val == std::numeric_limits<s32>::min() && proc.ireg[dec.rs2].r.w.val == -1 ? 0 : proc.ireg[dec.rs2].r.w.val == 0 ? proc.ireg[dec.rs1].r.w.val : proc.ireg[dec.rs1].r.w.val % proc.ireg[dec.rs2].r.w.val;
+		return pc_offset;
+	}
+	op_remuw: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.w.val == 0 ? proc.ireg[dec.rs1].r.w.val : s32(proc.ireg[dec.rs1].r.wu.val % proc.ireg[dec.rs2].r.wu.val);
+		return pc_offset;
+	}
+	op_lr_w: {
+		s32 t; proc.mmu.template load_reserved<P,s32>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_sc_w: {
+		ux res = proc.mmu.template store_conditional<P,s32>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.w.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
+		return pc_offset;
+	}
+	op_amoswap_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoswap, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoadd_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoadd, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoxor_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoxor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoor_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoand_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoand, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amomin_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomin, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amomax_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomax, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amominu_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amominu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amomaxu_w: {
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomaxu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_lr_d: {
+		s64 t; proc.mmu.template load_reserved<P,s64>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		return pc_offset;
+	}
+	op_sc_d: {
+		ux res = proc.mmu.template store_conditional<P,s64>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.l.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
+		return pc_offset;
+	}
+	op_amoswap_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoswap, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoadd_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoadd, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoxor_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoxor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoor_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amoand_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoand, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amomin_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amomin, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amomax_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amomax, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amominu_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amominu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_amomaxu_d: {
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amomaxu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		return pc_offset;
+	}
+	op_flw: {
+		u32 t; proc.mmu.template load<P,u32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.freg[dec.rd].r.wu.val = t;
+		return pc_offset;
+	}
+	op_fsw: {
+		proc.mmu.template store<P,f32>(proc, proc.ireg[dec.rs1] + dec.imm, proc.freg[dec.rs2].r.s.val);
+		return pc_offset;
+	}
+	op_fmadd_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val + proc.freg[dec.rs3].r.s.val;
+		return pc_offset;
+	}
+	op_fmsub_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val - proc.freg[dec.rs3].r.s.val;
+		return pc_offset;
+	}
+	op_fnmsub_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * -proc.freg[dec.rs2].r.s.val + proc.freg[dec.rs3].r.s.val;
+		return pc_offset;
+	}
+	op_fnmadd_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * -proc.freg[dec.rs2].r.s.val - proc.freg[dec.rs3].r.s.val;
+		return pc_offset;
+	}
+	op_fadd_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val + proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fsub_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val - proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fmul_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fdiv_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val / proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fsgnj_s: {
+		proc.freg[dec.rd].r.wu.val = (proc.freg[dec.rs1].r.wu.val & u32(~(1U<<31))) | (proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		return pc_offset;
+	}
+	op_fsgnjn_s: {
+		proc.freg[dec.rd].r.wu.val = (proc.freg[dec.rs1].r.wu.val & u32(~(1U<<31))) | (~proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		return pc_offset;
+	}
+	op_fsgnjx_s: {
+		proc.freg[dec.rd].r.wu.val = proc.freg[dec.rs1].r.wu.val ^ (proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		return pc_offset;
+	}
+	op_fmin_s: {
+		proc.freg[dec.rd].r.s.val = (proc.freg[dec.rs1].r.s.val < proc.freg[dec.rs2].r.s.val) || std::isnan(proc.freg[dec.rs2].r.s.val) ? proc.freg[dec.rs1].r.s.val : proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fmax_s: {
+		proc.freg[dec.rd].r.s.val = (proc.freg[dec.rs1].r.s.val > proc.freg[dec.rs2].r.s.val) || std::isnan(proc.freg[dec.rs2].r.s.val) ? proc.freg[dec.rs1].r.s.val : proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fsqrt_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = riscv::f32_sqrt(proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fle_s: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val <= proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_flt_s: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val < proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_feq_s: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val == proc.freg[dec.rs2].r.s.val;
+		return pc_offset;
+	}
+	op_fcvt_w_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_w(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fcvt_wu_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_wu(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fcvt_s_w: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.w.val);
+		return pc_offset;
+	}
+	op_fcvt_s_wu: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.wu.val);
+		return pc_offset;
+	}
+	op_fmv_x_s: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : std::isnan(proc.freg[dec.rs1].r.s.val) ? s32(0x7fc00000) : proc.freg[dec.rs1].r.w.val;
+		return pc_offset;
+	}
+	op_fclass_s: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : f32_classify(proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fmv_s_x: {
+		proc.freg[dec.rd].r.wu.val = proc.ireg[dec.rs1].r.wu.val;
+		return pc_offset;
+	}
+	op_fcvt_l_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_l(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fcvt_lu_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_lu(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fcvt_s_l: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.l.val);
+		return pc_offset;
+	}
+	op_fcvt_s_lu: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.lu.val);
+		return pc_offset;
+	}
+	op_fld: {
+		u64 t; proc.mmu.template load<P,u64>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.freg[dec.rd].r.lu.val = t;
+		return pc_offset;
+	}
+	op_fsd: {
+		proc.mmu.template store<P,f64>(proc, proc.ireg[dec.rs1] + dec.imm, proc.freg[dec.rs2].r.d.val);
+		return pc_offset;
+	}
+	op_fmadd_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val + proc.freg[dec.rs3].r.d.val;
+		return pc_offset;
+	}
+	op_fmsub_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val - proc.freg[dec.rs3].r.d.val;
+		return pc_offset;
+	}
+	op_fnmsub_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * -proc.freg[dec.rs2].r.d.val + proc.freg[dec.rs3].r.d.val;
+		return pc_offset;
+	}
+	op_fnmadd_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * -proc.freg[dec.rs2].r.d.val - proc.freg[dec.rs3].r.d.val;
+		return pc_offset;
+	}
+	op_fadd_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val + proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fsub_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val - proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fmul_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fdiv_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val / proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fsgnj_d: {
+		proc.freg[dec.rd].r.lu.val = (proc.freg[dec.rs1].r.lu.val & u64(~(1ULL<<63))) | (proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		return pc_offset;
+	}
+	op_fsgnjn_d: {
+		proc.freg[dec.rd].r.lu.val = (proc.freg[dec.rs1].r.lu.val & u64(~(1ULL<<63))) | (~proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		return pc_offset;
+	}
+	op_fsgnjx_d: {
+		proc.freg[dec.rd].r.lu.val = proc.freg[dec.rs1].r.lu.val ^ (proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		return pc_offset;
+	}
+	op_fmin_d: {
+		proc.freg[dec.rd].r.d.val = (proc.freg[dec.rs1].r.d.val < proc.freg[dec.rs2].r.d.val) || std::isnan(proc.freg[dec.rs2].r.d.val) ? proc.freg[dec.rs1].r.d.val : proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fmax_d: {
+		proc.freg[dec.rd].r.d.val = (proc.freg[dec.rs1].r.d.val > proc.freg[dec.rs2].r.d.val) || std::isnan(proc.freg[dec.rs2].r.d.val) ? proc.freg[dec.rs1].r.d.val : proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fcvt_s_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fcvt_d_s: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.freg[dec.rs1].r.s.val);
+		return pc_offset;
+	}
+	op_fsqrt_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = riscv::f64_sqrt(proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fle_d: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val <= proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_flt_d: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val < proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_feq_d: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val == proc.freg[dec.rs2].r.d.val;
+		return pc_offset;
+	}
+	op_fcvt_w_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_w(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fcvt_wu_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_wu(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fcvt_d_w: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.w.val);
+		return pc_offset;
+	}
+	op_fcvt_d_wu: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.wu.val);
+		return pc_offset;
+	}
+	op_fclass_d: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : f64_classify(proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fcvt_l_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_l(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fcvt_lu_d: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_lu(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		return pc_offset;
+	}
+	op_fmv_x_d: {
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : std::isnan(proc.freg[dec.rs1].r.d.val) ? s64(0x7ff8000000000000ULL) : proc.freg[dec.rs1].r.l.val;
+		return pc_offset;
+	}
+	op_fcvt_d_l: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.l.val);
+		return pc_offset;
+	}
+	op_fcvt_d_lu: {
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.lu.val);
+		return pc_offset;
+	}
+	op_fmv_d_x: {
+		proc.freg[dec.rd].r.lu.val = proc.ireg[dec.rs1].r.lu.val;
+		return pc_offset;
+	}
+	illegal:
+		return -1; /* illegal instruction */
+}
+
+/* Execute Block RV128 (threaded) */
+
+template <bool rvi, bool rvm, bool rva, bool rvs, bool rvf, bool rvd, bool rvq, bool rvc, typename B, typename T, typename P>
+size_t exec_block_rv128(B *insts, size_t count, T *&cur, P &proc, typename P::ux inststop)
+{
+	using namespace riscv;
+	enum { xlen = 128 };
+	typedef s128 sx;
+	typedef u128 ux;
+
+	static const void* dispatch[] = {
+		&&unhandled,
+		rvi ? &&op_lui : &&unhandled,
+		rvi ? &&op_auipc : &&unhandled,
+		rvi ? &&op_jal : &&unhandled,
+		rvi ? &&op_jalr : &&unhandled,
+		rvi ? &&op_beq : &&unhandled,
+		rvi ? &&op_bne : &&unhandled,
+		rvi ? &&op_blt : &&unhandled,
+		rvi ? &&op_bge : &&unhandled,
+		rvi ? &&op_bltu : &&unhandled,
+		rvi ? &&op_bgeu : &&unhandled,
+		rvi ? &&op_lb : &&unhandled,
+		rvi ? &&op_lh : &&unhandled,
+		rvi ? &&op_lw : &&unhandled,
+		rvi ? &&op_lbu : &&unhandled,
+		rvi ? &&op_lhu : &&unhandled,
+		rvi ? &&op_sb : &&unhandled,
+		rvi ? &&op_sh : &&unhandled,
+		rvi ? &&op_sw : &&unhandled,
+		rvi ? &&op_addi : &&unhandled,
+		rvi ? &&op_slti : &&unhandled,
+		rvi ? &&op_sltiu : &&unhandled,
+		rvi ? &&op_xori : &&unhandled,
+		rvi ? &&op_ori : &&unhandled,
+		rvi ? &&op_andi : &&unhandled,
+		rvi ? &&op_slli : &&unhandled,
+		rvi ? &&op_srli : &&unhandled,
+		rvi ? &&op_srai : &&unhandled,
+		rvi ? &&op_add : &&unhandled,
+		rvi ? &&op_sub : &&unhandled,
+		rvi ? &&op_sll : &&unhandled,
+		rvi ? &&op_slt : &&unhandled,
+		rvi ? &&op_sltu : &&unhandled,
+		rvi ? &&op_xor : &&unhandled,
+		rvi ? &&op_srl : &&unhandled,
+		rvi ? &&op_sra : &&unhandled,
+		rvi ? &&op_or : &&unhandled,
+		rvi ? &&op_and : &&unhandled,
+		&&unhandled,
+		&&unhandled,
+		rvi ? &&op_lwu : &&unhandled,
+		rvi ? &&op_ld : &&unhandled,
+		rvi ? &&op_sd : &&unhandled,
+		rvi ? &&op_addiw : &&unhandled,
+		rvi ? &&op_slliw : &&unhandled,
+		rvi ? &&op_srliw : &&unhandled,
+		rvi ? &&op_sraiw : &&unhandled,
+		rvi ? &&op_addw : &&unhandled,
+		rvi ? &&op_subw : &&unhandled,
+		rvi ? &&op_sllw : &&unhandled,
+		rvi ? &&op_srlw : &&unhandled,
+		rvi ? &&op_sraw : &&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		rvm ? &&op_mul : &&unhandled,
+		rvm ? &&op_mulh : &&unhandled,
+		rvm ? &&op_mulhsu : &&unhandled,
+		rvm ? &&op_mulhu : &&unhandled,
+		rvm ? &&op_div : &&unhandled,
+		rvm ? &&op_divu : &&unhandled,
+		rvm ? &&op_rem : &&unhandled,
+		rvm ? &&op_remu : &&unhandled,
+		rvm ? &&op_mulw : &&unhandled,
+		rvm ? &&op_divw : &&unhandled,
+		rvm ? &&op_divuw : &&unhandled,
+		rvm ? &&op_remw : &&unhandled,
+		rvm ? &&op_remuw : &&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		rva ? &&op_lr_w : &&unhandled,
+		rva ? &&op_sc_w : &&unhandled,
+		rva ? &&op_amoswap_w : &&unhandled,
+		rva ? &&op_amoadd_w : &&unhandled,
+		rva ? &&op_amoxor_w : &&unhandled,
+		rva ? &&op_amoor_w : &&unhandled,
+		rva ? &&op_amoand_w : &&unhandled,
+		rva ? &&op_amomin_w : &&unhandled,
+		rva ? &&op_amomax_w : &&unhandled,
+		rva ? &&op_amominu_w : &&unhandled,
+		rva ? &&op_amomaxu_w : &&unhandled,
+		rva ? &&op_lr_d : &&unhandled,
+		rva ? &&op_sc_d : &&unhandled,
+		rva ? &&op_amoswap_d : &&unhandled,
+		rva ? &&op_amoadd_d : &&unhandled,
+		rva ? &&op_amoxor_d : &&unhandled,
+		rva ? &&op_amoor_d : &&unhandled,
+		rva ? &&op_amoand_d : &&unhandled,
+		rva ? &&op_amomin_d : &&unhandled,
+		rva ? &&op_amomax_d : &&unhandled,
+		rva ? &&op_amominu_d : &&unhandled,
+		rva ? &&op_amomaxu_d : &&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		rvf ? &&op_flw : &&unhandled,
+		rvf ? &&op_fsw : &&unhandled,
+		rvf ? &&op_fmadd_s : &&unhandled,
+		rvf ? &&op_fmsub_s : &&unhandled,
+		rvf ? &&op_fnmsub_s : &&unhandled,
+		rvf ? &&op_fnmadd_s : &&unhandled,
+		rvf ? &&op_fadd_s : &&unhandled,
+		rvf ? &&op_fsub_s : &&unhandled,
+		rvf ? &&op_fmul_s : &&unhandled,
+		rvf ? &&op_fdiv_s : &&unhandled,
+		rvf ? &&op_fsgnj_s : &&unhandled,
+		rvf ? &&op_fsgnjn_s : &&unhandled,
+		rvf ? &&op_fsgnjx_s : &&unhandled,
+		rvf ? &&op_fmin_s : &&unhandled,
+		rvf ? &&op_fmax_s : &&unhandled,
+		rvf ? &&op_fsqrt_s : &&unhandled,
+		rvf ? &&op_fle_s : &&unhandled,
+		rvf ? &&op_flt_s : &&unhandled,
+		rvf ? &&op_feq_s : &&unhandled,
+		rvf ? &&op_fcvt_w_s : &&unhandled,
+		rvf ? &&op_fcvt_wu_s : &&unhandled,
+		rvf ? &&op_fcvt_s_w : &&unhandled,
+		rvf ? &&op_fcvt_s_wu : &&unhandled,
+		rvf ? &&op_fmv_x_s : &&unhandled,
+		rvf ? &&op_fclass_s : &&unhandled,
+		rvf ? &&op_fmv_s_x : &&unhandled,
+		rvf ? &&op_fcvt_l_s : &&unhandled,
+		rvf ? &&op_fcvt_lu_s : &&unhandled,
+		rvf ? &&op_fcvt_s_l : &&unhandled,
+		rvf ? &&op_fcvt_s_lu : &&unhandled,
+		rvd ? &&op_fld : &&unhandled,
+		rvd ? &&op_fsd : &&unhandled,
+		rvd ? &&op_fmadd_d : &&unhandled,
+		rvd ? &&op_fmsub_d : &&unhandled,
+		rvd ? &&op_fnmsub_d : &&unhandled,
+		rvd ? &&op_fnmadd_d : &&unhandled,
+		rvd ? &&op_fadd_d : &&unhandled,
+		rvd ? &&op_fsub_d : &&unhandled,
+		rvd ? &&op_fmul_d : &&unhandled,
+		rvd ? &&op_fdiv_d : &&unhandled,
+		rvd ? &&op_fsgnj_d : &&unhandled,
+		rvd ? &&op_fsgnjn_d : &&unhandled,
+		rvd ? &&op_fsgnjx_d : &&unhandled,
+		rvd ? &&op_fmin_d : &&unhandled,
+		rvd ? &&op_fmax_d : &&unhandled,
+		rvd ? &&op_fcvt_s_d : &&unhandled,
+		rvd ? &&op_fcvt_d_s : &&unhandled,
+		rvd ? &&op_fsqrt_d : &&unhandled,
+		rvd ? &&op_fle_d : &&unhandled,
+		rvd ? &&op_flt_d : &&unhandled,
+		rvd ? &&op_feq_d : &&unhandled,
+		rvd ? &&op_fcvt_w_d : &&unhandled,
+		rvd ? &&op_fcvt_wu_d : &&unhandled,
+		rvd ? &&op_fcvt_d_w : &&unhandled,
+		rvd ? &&op_fcvt_d_wu : &&unhandled,
+		rvd ? &&op_fclass_d : &&unhandled,
+		rvd ? &&op_fcvt_l_d : &&unhandled,
+		rvd ? &&op_fcvt_lu_d : &&unhandled,
+		rvd ? &&op_fmv_x_d : &&unhandled,
+		rvd ? &&op_fcvt_d_l : &&unhandled,
+		rvd ? &&op_fcvt_d_lu : &&unhandled,
+		rvd ? &&op_fmv_d_x : &&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+		&&unhandled,
+	};
+
+	size_t i = 0;
+	cur = &insts[0].dec;
+	typename P::ux pc_offset = insts[0].len;
+	goto *dispatch[cur->op];
+	op_lui: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_auipc: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_jal: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + pc_offset; pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_jalr: {
+		T &dec = *cur;
+		ux new_offset = (proc.ireg[dec.rs1] + dec.imm - proc.pc) & ~1; proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.pc + pc_offset; pc_offset = new_offset;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_beq: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.x.val == proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_bne: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.x.val != proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_blt: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.x.val < proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_bge: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.x.val >= proc.ireg[dec.rs2].r.x.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_bltu: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.xu.val < proc.ireg[dec.rs2].r.xu.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_bgeu: {
+		T &dec = *cur;
+		if (proc.ireg[dec.rs1].r.xu.val >= proc.ireg[dec.rs2].r.xu.val) pc_offset = dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lb: {
+		T &dec = *cur;
+		s8 t; proc.mmu.template load<P,s8>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lh: {
+		T &dec = *cur;
+		s16 t; proc.mmu.template load<P,s16>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lw: {
+		T &dec = *cur;
+		s32 t; proc.mmu.template load<P,s32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lbu: {
+		T &dec = *cur;
+		u8 t; proc.mmu.template load<P,u8>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lhu: {
+		T &dec = *cur;
+		u16 t; proc.mmu.template load<P,u16>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sb: {
+		T &dec = *cur;
+		proc.mmu.template store<P,s8>(proc, proc.ireg[dec.rs1] + dec.imm, s8(proc.ireg[dec.rs2]));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sh: {
+		T &dec = *cur;
+		proc.mmu.template store<P,s16>(proc, proc.ireg[dec.rs1] + dec.imm, s16(proc.ireg[dec.rs2]));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sw: {
+		T &dec = *cur;
+		proc.mmu.template store<P,s32>(proc, proc.ireg[dec.rs1] + dec.imm, proc.ireg[dec.rs2].r.w.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_addi: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val + sx(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_slti: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val < sx(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sltiu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val < ux(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_xori: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val ^ ux(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_ori: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val | ux(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_andi: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val & ux(dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_add: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val + proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sub: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val - proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sll: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val << (proc.ireg[dec.rs2] & 0b1111111);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_slt: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val < proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sltu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val < proc.ireg[dec.rs2].r.xu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_xor: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val ^ proc.ireg[dec.rs2].r.xu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_srl: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val >> (proc.ireg[dec.rs2] & 0b1111111);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sra: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val >> (proc.ireg[dec.rs2] & 0b1111111);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_or: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val | proc.ireg[dec.rs2].r.xu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_and: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val & proc.ireg[dec.rs2].r.xu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lwu: {
+		T &dec = *cur;
+		u32 t; proc.mmu.template load<P,u32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_ld: {
+		T &dec = *cur;
+		s64 t; proc.mmu.template load<P,s64>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sd: {
+		T &dec = *cur;
+		proc.mmu.template store<P,s64>(proc, proc.ireg[dec.rs1] + dec.imm, proc.ireg[dec.rs2].r.l.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_addiw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val + dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_slliw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val << dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_srliw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val >> dec.imm);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sraiw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.w.val >> dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_addw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val + proc.ireg[dec.rs2].r.w.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_subw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val - proc.ireg[dec.rs2].r.w.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sllw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val << (proc.ireg[dec.rs2] & 0b11111));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_srlw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val >> (proc.ireg[dec.rs2] & 0b11111));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sraw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.w.val >> (proc.ireg[dec.rs2] & 0b11111));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_slli: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val << dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_srli: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.xu.val >> dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_srai: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val >> dec.imm;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_mul: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val * proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_mulh: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulh(proc.ireg[dec.rs1].r.x.val, proc.ireg[dec.rs2].r.x.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_mulhsu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulhsu(proc.ireg[dec.rs1].r.x.val, proc.ireg[dec.rs2].r.xu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_mulhu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::mulhu(proc.ireg[dec.rs1].r.xu.val, proc.ireg[dec.rs2].r.xu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_div: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val == std::numeric_limits<sx>::min() && proc.ireg[dec.rs2].r.x.val == -1 ? std::numeric_limits<sx>::min() : proc.ireg[dec.rs2].r.x.val == 0 ? -1 : proc.ireg[dec.rs1].r.x.val / proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_divu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? -1 : sx(proc.ireg[dec.rs1].r.xu.val / proc.ireg[dec.rs2].r.xu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_rem: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.x.val == std::numeric_limits<sx>::min() && proc.ireg[dec.rs2].r.x.val == -1 ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? proc.ireg[dec.rs1].r.x.val : proc.ireg[dec.rs1].r.x.val % proc.ireg[dec.rs2].r.x.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_remu: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.x.val == 0 ? proc.ireg[dec.rs1].r.x.val : sx(proc.ireg[dec.rs1].r.xu.val % proc.ireg[dec.rs2].r.xu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_mulw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : s32(proc.ireg[dec.rs1].r.wu.val * proc.ireg[dec.rs2].r.wu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_divw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.w.val == std::numeric_limits<s32>::min() && proc.ireg[dec.rs2].r.w.val == -1 ? std::numeric_limits<s32>::min() : proc.ireg[dec.rs2].r.w.val == 0 ? -1 : proc.ireg[dec.rs1].r.w.val / proc.ireg[dec.rs2].r.w.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_divuw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.w.val == 0 ? -1 : s32(proc.ireg[dec.rs1].r.wu.val / proc.ireg[dec.rs2].r.wu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_remw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs1].r.w.val == std::numeric_limits<s32>::min() && proc.ireg[dec.rs2].r.w.val == -1 ? 0 : proc.ireg[dec.rs2].r.w.val == 0 ? proc.ireg[dec.rs1].r.w.val : proc.ireg[dec.rs1].r.w.val % proc.ireg[dec.rs2].r.w.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_remuw: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.ireg[dec.rs2].r.w.val == 0 ? proc.ireg[dec.rs1].r.w.val : s32(proc.ireg[dec.rs1].r.wu.val % proc.ireg[dec.rs2].r.wu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lr_w: {
+		T &dec = *cur;
+		s32 t; proc.mmu.template load_reserved<P,s32>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sc_w: {
+		T &dec = *cur;
+		ux res = proc.mmu.template store_conditional<P,s32>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.w.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoswap_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoswap, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoadd_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoadd, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoxor_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoxor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoor_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoand_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amoand, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amomin_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomin, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amomax_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomax, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amominu_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amominu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amomaxu_w: {
+		T &dec = *cur;
+		s32 t1, t2 = proc.ireg[dec.rs2].r.w.val; proc.mmu.template amo<P,s32>(proc, amomaxu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_lr_d: {
+		T &dec = *cur;
+		s64 t; proc.mmu.template load_reserved<P,s64>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_sc_d: {
+		T &dec = *cur;
+		ux res = proc.mmu.template store_conditional<P,s64>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.l.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoswap_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoswap, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoadd_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoadd, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoxor_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoxor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoor_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoor, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amoand_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amoand, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amomin_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amomin, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amomax_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amomax, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amominu_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amominu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_amomaxu_d: {
+		T &dec = *cur;
+		s64 t1, t2 = proc.ireg[dec.rs2].r.l.val; proc.mmu.template amo<P,s64>(proc, amomaxu, proc.ireg[dec.rs1], t1, t2); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t1;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_flw: {
+		T &dec = *cur;
+		u32 t; proc.mmu.template load<P,u32>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.freg[dec.rd].r.wu.val = t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsw: {
+		T &dec = *cur;
+		proc.mmu.template store<P,f32>(proc, proc.ireg[dec.rs1] + dec.imm, proc.freg[dec.rs2].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmadd_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val + proc.freg[dec.rs3].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmsub_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val - proc.freg[dec.rs3].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fnmsub_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * -proc.freg[dec.rs2].r.s.val + proc.freg[dec.rs3].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fnmadd_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * -proc.freg[dec.rs2].r.s.val - proc.freg[dec.rs3].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fadd_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val + proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsub_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val - proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmul_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val * proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fdiv_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = proc.freg[dec.rs1].r.s.val / proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnj_s: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.wu.val = (proc.freg[dec.rs1].r.wu.val & u32(~(1U<<31))) | (proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnjn_s: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.wu.val = (proc.freg[dec.rs1].r.wu.val & u32(~(1U<<31))) | (~proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnjx_s: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.wu.val = proc.freg[dec.rs1].r.wu.val ^ (proc.freg[dec.rs2].r.wu.val & u32(1U<<31));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmin_s: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.s.val = (proc.freg[dec.rs1].r.s.val < proc.freg[dec.rs2].r.s.val) || std::isnan(proc.freg[dec.rs2].r.s.val) ? proc.freg[dec.rs1].r.s.val : proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmax_s: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.s.val = (proc.freg[dec.rs1].r.s.val > proc.freg[dec.rs2].r.s.val) || std::isnan(proc.freg[dec.rs2].r.s.val) ? proc.freg[dec.rs1].r.s.val : proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsqrt_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = riscv::f32_sqrt(proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fle_s: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val <= proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_flt_s: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val < proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_feq_s: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.s.val == proc.freg[dec.rs2].r.s.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_w_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_w(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_wu_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_wu(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_s_w: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.w.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_s_wu: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.wu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmv_x_s: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : std::isnan(proc.freg[dec.rs1].r.s.val) ? s32(0x7fc00000) : proc.freg[dec.rs1].r.w.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fclass_s: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : f32_classify(proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmv_s_x: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.wu.val = proc.ireg[dec.rs1].r.wu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_l_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_l(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_lu_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_lu(proc.fcsr, proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_s_l: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.l.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_s_lu: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.ireg[dec.rs1].r.lu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fld: {
+		T &dec = *cur;
+		u64 t; proc.mmu.template load<P,u64>(proc, proc.ireg[dec.rs1] + dec.imm, t); proc.freg[dec.rd].r.lu.val = t;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsd: {
+		T &dec = *cur;
+		proc.mmu.template store<P,f64>(proc, proc.ireg[dec.rs1] + dec.imm, proc.freg[dec.rs2].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmadd_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val + proc.freg[dec.rs3].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmsub_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val - proc.freg[dec.rs3].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fnmsub_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * -proc.freg[dec.rs2].r.d.val + proc.freg[dec.rs3].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fnmadd_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * -proc.freg[dec.rs2].r.d.val - proc.freg[dec.rs3].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fadd_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val + proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsub_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val - proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmul_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val * proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fdiv_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = proc.freg[dec.rs1].r.d.val / proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnj_d: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.lu.val = (proc.freg[dec.rs1].r.lu.val & u64(~(1ULL<<63))) | (proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnjn_d: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.lu.val = (proc.freg[dec.rs1].r.lu.val & u64(~(1ULL<<63))) | (~proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsgnjx_d: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.lu.val = proc.freg[dec.rs1].r.lu.val ^ (proc.freg[dec.rs2].r.lu.val & u64(1ULL<<63));
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmin_d: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.d.val = (proc.freg[dec.rs1].r.d.val < proc.freg[dec.rs2].r.d.val) || std::isnan(proc.freg[dec.rs2].r.d.val) ? proc.freg[dec.rs1].r.d.val : proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmax_d: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.d.val = (proc.freg[dec.rs1].r.d.val > proc.freg[dec.rs2].r.d.val) || std::isnan(proc.freg[dec.rs2].r.d.val) ? proc.freg[dec.rs1].r.d.val : proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_s_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.s.val = f32(proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_d_s: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.freg[dec.rs1].r.s.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fsqrt_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = riscv::f64_sqrt(proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fle_d: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val <= proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_flt_d: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val < proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_feq_d: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : proc.freg[dec.rs1].r.d.val == proc.freg[dec.rs2].r.d.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_w_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_w(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_wu_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_wu(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_d_w: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.w.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_d_wu: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.wu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fclass_d: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : f64_classify(proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_l_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_l(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_lu_d: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : riscv::fcvt_lu(proc.fcsr, proc.freg[dec.rs1].r.d.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmv_x_d: {
+		T &dec = *cur;
+		proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : std::isnan(proc.freg[dec.rs1].r.d.val) ? s64(0x7ff8000000000000ULL) : proc.freg[dec.rs1].r.l.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_d_l: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.l.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fcvt_d_lu: {
+		T &dec = *cur;
+		fenv_setrm((proc.fcsr >> 5) & 0b111); proc.freg[dec.rd].r.d.val = f64(proc.ireg[dec.rs1].r.lu.val);
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	op_fmv_d_x: {
+		T &dec = *cur;
+		proc.freg[dec.rd].r.lu.val = proc.ireg[dec.rs1].r.lu.val;
+		proc.pc += pc_offset;
+		proc.instret++;
+		if (++i == count || proc.instret == inststop) return i;
+		cur = &insts[i].dec;
+		pc_offset = insts[i].len;
+		goto *dispatch[cur->op];
+	}
+	unhandled:
+		return i; /* executed by the runloop */
 }
 
+#else
+
 /* Execute Instruction RV128 */
 
 template <bool rvi, bool rvm, bool rva, bool rvs, bool rvf, bool rvd, bool rvq, bool rvc, typename T, typename P>
@@ -1632,12 +9279,12 @@ typename P::ux exec_inst_rv128(T &dec, P &proc, typename P::ux pc_offset)
 			break;
 		case rv_op_lr_w:
 			if (rva) {
-				proc.lr = proc.ireg[dec.rs1]; s32 t; proc.mmu.template load<P,s32>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+				s32 t; proc.mmu.template load_reserved<P,s32>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
 			};
 			break;
 		case rv_op_sc_w:
 			if (rva) {
-				ux res = 0; if (proc.lr != proc.ireg[dec.rs1]) res = 1; else proc.mmu.template store<P,s32>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.w.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
+				ux res = proc.mmu.template store_conditional<P,s32>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.w.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
 			};
 			break;
 		case rv_op_amoswap_w:
@@ -1687,12 +9334,12 @@ typename P::ux exec_inst_rv128(T &dec, P &proc, typename P::ux pc_offset)
 			break;
 		case rv_op_lr_d:
 			if (rva) {
-				proc.lr = proc.ireg[dec.rs1]; s64 t; proc.mmu.template load<P,s64>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
+				s64 t; proc.mmu.template load_reserved<P,s64>(proc, proc.ireg[dec.rs1], t); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : t;
 			};
 			break;
 		case rv_op_sc_d:
 			if (rva) {
-				ux res = 0; if (proc.lr != proc.ireg[dec.rs1]) res = 1; else proc.mmu.template store<P,s64>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.l.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
+				ux res = proc.mmu.template store_conditional<P,s64>(proc, proc.ireg[dec.rs1], proc.ireg[dec.rs2].r.l.val); proc.ireg[dec.rd] = (dec.rd == 0) ? 0 : res;
 			};
 			break;
 		case rv_op_amoswap_d:
@@ -2056,3 +9703,5 @@ typename P::ux exec_inst_rv128(T &dec, P &proc, typename P::ux pc_offset)
 }
 
 #endif
+
+#endif
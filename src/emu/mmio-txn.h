@@ -0,0 +1,38 @@
+//
+//  mmio-txn.h
+//
+
+#ifndef rv_mmio_txn_h
+#define rv_mmio_txn_h
+
+namespace riscv {
+
+	/*
+	 * External MMIO transaction
+	 *
+	 * Scalar accesses of 1, 2, 4 or 8 bytes carry their value in val and
+	 * bursts carry size bytes in data. The model completes a read by
+	 * setting val (or filling data) and result; a non zero result is a
+	 * bus error. Writes are posted so their result is only counted.
+	 */
+
+	enum mmio_txn_type : u8 {
+		mmio_txn_read,
+		mmio_txn_write
+	};
+
+	struct mmio_txn
+	{
+		u64 addr;          /* offset within the device */
+		u64 val;           /* scalar value */
+		u8  *data;         /* burst data, null for scalar accesses */
+		u32 size;          /* access size in bytes */
+		u8  type;          /* mmio_txn_read or mmio_txn_write */
+		int result;        /* bus error if non zero */
+	};
+
+	typedef std::function<void (mmio_txn *const *txns, size_t count)> mmio_txn_batch_fn;
+
+}
+
+#endif
@@ -83,7 +83,7 @@ namespace riscv {
 		virtual buserror_t load_32(addr_t va, u32 &val) { val = *static_cast<u32*>((void*)va); return 0; }
 		virtual buserror_t load_64(addr_t va, u64 &val) { val = *static_cast<u64*>((void*)va); return 0; }
 		virtual buserror_t load_bytes(addr_t va, char *bytes, size_t len)
-		{return memcpy(bytes, (void *) va, len) != NULL; }
+		{ memcpy(bytes, (void*)va, len); return 0; }
 
 
 		virtual buserror_t store_8 (addr_t va, u8  val) { *static_cast<u8*>((void*)va) = val; return 0; }
@@ -91,7 +91,7 @@ namespace riscv {
 		virtual buserror_t store_32(addr_t va, u32 val) { *static_cast<u32*>((void*)va) = val; return 0; }
 		virtual buserror_t store_64(addr_t va, u64 val) { *static_cast<u64*>((void*)va) = val; return 0; }
 		virtual buserror_t store_bytes(addr_t va, char *bytes, size_t len) 
-		{return memcpy((void *) va, bytes, len) != NULL; }
+		{ memcpy((void*)va, bytes, len); return 0; }
 	};
 
 
@@ -102,10 +102,26 @@ namespace riscv {
 	{
 		typedef std::shared_ptr<memory_segment<UX>> memory_segment_type;
 
+		/*  segment index entry maps the inclusive machine physical address
+		    range [mpa, end] to a user virtual address. The end is inclusive
+		    so that a segment at the top of the address space does not wrap */
+		struct segment_index_ent
+		{
+			UX mpa;                  /* first machine physical address */
+			UX end;                  /* last machine physical address */
+			addr_t uva;              /* user virtual address of mpa */
+			pma_t flags;             /* segment PMA flags */
+			memory_segment<UX> *seg; /* segment owning the range */
+			bool host;               /* main memory backed by host memory */
+		};
+
 		std::vector<memory_segment_type> segments;
+		std::vector<segment_index_ent> segment_index;
+		std::atomic<size_t> segment_last;
+		std::mutex io_mutex;     /* serializes device access between harts */
 		bool log;
 
-		user_memory() : log(false) {}
+		user_memory() : segment_last(0), log(false) {}
 		~user_memory() { clear_segments(); }
 
 		/* print memory */
@@ -134,6 +150,7 @@ namespace riscv {
 		void add_segment(memory_segment_type seg)
 		{
 			segments.push_back(seg);
+			rebuild_segment_index();
 			if (log) {
 				print_memory_segment(seg);
 			}
@@ -159,24 +176,192 @@ namespace riscv {
 		/* Unmap memory segments */
 		void clear_segments()
 		{
+			segment_index.clear();
+			segment_last.store(0, std::memory_order_relaxed);
 			segments.clear();
 		}
 
+		/* ROM devices are main memory without a host mapping (uva is 0) */
+		static bool host_backed(memory_segment<UX> *seg)
+		{
+			return (seg->flags & pma_type_main) && seg->uva != 0;
+		}
+
+		/*
+		 * rebuild the sorted segment index
+		 *
+		 * segments are visited in insertion order and earlier segments take
+		 * precedence where they overlap (e.g. ELF segments mapped over RAM)
+		 * so each segment only contributes the gaps left by earlier segments.
+		 * The result is a sorted array of non-overlapping address ranges.
+		 */
+		void rebuild_segment_index()
+		{
+			std::vector<segment_index_ent> index, pieces;
+			for (auto &seg : segments) {
+				if (seg->size == 0) continue;
+				UX lo = seg->mpa;
+				UX end = (seg->size - 1 > size_t(UX(~seg->mpa))) ?
+					UX(-1) : UX(seg->mpa + seg->size - 1);
+				bool covered = false;
+				pieces.clear();
+				for (auto &ent : index) {
+					if (ent.end < lo) continue;
+					if (ent.mpa > end) break;
+					if (ent.mpa > lo) {
+						pieces.push_back(segment_index_ent{lo, UX(ent.mpa - 1),
+							seg->uva + (lo - seg->mpa), seg->flags, seg.get(), host_backed(seg.get())});
+					}
+					if (ent.end >= end) {
+						covered = true;
+						break;
+					}
+					lo = ent.end + 1;
+				}
+				if (!covered) {
+					pieces.push_back(segment_index_ent{lo, end,
+						seg->uva + (lo - seg->mpa), seg->flags, seg.get(), host_backed(seg.get())});
+				}
+				index.insert(index.end(), pieces.begin(), pieces.end());
+				std::sort(index.begin(), index.end(),
+					[](const segment_index_ent &a, const segment_index_ent &b) {
+						return a.mpa < b.mpa;
+					});
+			}
+			segment_index = std::move(index);
+			segment_last.store(0, std::memory_order_relaxed);
+		}
+
+		/* find the segment index entry containing a machine physical address */
+		segment_index_ent* lookup_segment(UX mpa)
+		{
+			/* check the last hit before searching the index */
+			size_t n = segment_index.size();
+			size_t last = segment_last.load(std::memory_order_relaxed);
+			if (likely(last < n)) {
+				segment_index_ent *ent = &segment_index[last];
+				if (likely(UX(mpa - ent->mpa) <= UX(ent->end - ent->mpa))) {
+					return ent;
+				}
+			}
+
+			/* binary search for the first range that ends at or above mpa */
+			size_t lo = 0, hi = n;
+			while (lo < hi) {
+				size_t mid = (lo + hi) >> 1;
+				if (segment_index[mid].end < mpa) lo = mid + 1;
+				else hi = mid;
+			}
+			if (lo < n && segment_index[lo].mpa <= mpa) {
+				segment_last.store(lo, std::memory_order_relaxed);
+				return &segment_index[lo];
+			}
+			return nullptr;
+		}
+
 		/* convert machine physical address to user virtual address */
 		addr_t mpa_to_uva(memory_segment<UX>* &out_seg, UX mpa)
 		{
-			for (auto &seg : segments) {
-				if (mpa >= seg->mpa && /* note the upper limit may wrap to 0 */
-					((mpa < seg->mpa + seg->size) || (seg->mpa + seg->size == 0))) {
-					out_seg = seg.get();
-					return seg->uva + (mpa - seg->mpa);
+			segment_index_ent *ent = lookup_segment(mpa);
+			if (unlikely(!ent)) return 0;
+			out_seg = ent->seg;
+			return ent->uva + UX(mpa - ent->mpa);
+		}
+
+		/* convert machine physical address range to a host pointer if it is host backed main memory */
+		void* mpa_to_host(UX mpa, size_t len)
+		{
+			segment_index_ent *ent = lookup_segment(mpa);
+			if (likely(ent && ent->host &&
+				UX(ent->end - mpa) >= len - 1))
+			{
+				return reinterpret_cast<void*>(ent->uva + UX(mpa - ent->mpa));
+			}
+			return nullptr;
+		}
+
+		template <typename T> T* mpa_to_host(UX mpa)
+		{
+			return static_cast<T*>(mpa_to_host(mpa, sizeof(T)));
+		}
+
+		/*
+		 * visit the host ranges backing a machine physical address range
+		 *
+		 * fn(host, offset, len) is called for each index entry covering the
+		 * range in address order. Returns false, stopping early, if any part
+		 * of the range is not main memory or the range wraps.
+		 */
+		template <typename F>
+		bool walk_host_ranges(UX mpa, size_t len, F fn)
+		{
+			for (size_t offset = 0; offset < len; ) {
+				segment_index_ent *ent = lookup_segment(mpa);
+				if (!ent || !ent->host) return false;
+				UX rem = UX(ent->end - mpa);
+				size_t chunk = (len - offset - 1 <= rem) ? len - offset : size_t(rem) + 1;
+				if (!fn(reinterpret_cast<u8*>(ent->uva + UX(mpa - ent->mpa)), offset, chunk)) {
+					return false;
 				}
+				offset += chunk;
+				if (offset < len && ent->end == UX(-1)) return false;
+				mpa += UX(chunk);
 			}
+			return true;
+		}
+
+		/*
+		 * convert machine physical address range to host iovecs
+		 *
+		 * returns the number of iovecs, or -1 if any part of the range is
+		 * not main memory or more than iovcnt iovecs are needed. Ranges
+		 * that are contiguous in the host are merged.
+		 */
+		int mpa_to_iovec(UX mpa, size_t len, struct iovec *iov, int iovcnt)
+		{
+			int n = 0;
+			bool ok = walk_host_ranges(mpa, len, [&](u8 *host, size_t offset, size_t chunk) {
+				if (n > 0 && static_cast<u8*>(iov[n - 1].iov_base) + iov[n - 1].iov_len == host) {
+					iov[n - 1].iov_len += chunk;
+				} else if (n < iovcnt) {
+					iov[n].iov_base = host;
+					iov[n].iov_len = chunk;
+					n++;
+				} else {
+					return false;
+				}
+				return true;
+			});
+			return ok ? n : -1;
+		}
+
+		/* copy between main memory and a host buffer, the range is checked
+		   before copying so a failed copy does not partially complete */
+		buserror_t copy_from_mpa(void *dst, UX mpa, size_t len)
+		{
+			auto check = [](u8*, size_t, size_t) { return true; };
+			if (!walk_host_ranges(mpa, len, check)) return -1;
+			walk_host_ranges(mpa, len, [&](u8 *host, size_t offset, size_t chunk) {
+				memcpy(static_cast<u8*>(dst) + offset, host, chunk);
+				return true;
+			});
+			return 0;
+		}
+
+		buserror_t copy_to_mpa(UX mpa, const void *src, size_t len)
+		{
+			auto check = [](u8*, size_t, size_t) { return true; };
+			if (!walk_host_ranges(mpa, len, check)) return -1;
+			walk_host_ranges(mpa, len, [&](u8 *host, size_t offset, size_t chunk) {
+				memcpy(host, static_cast<const u8*>(src) + offset, chunk);
+				return true;
+			});
 			return 0;
 		}
 
 		virtual buserror_t load_8(addr_t va, u8 &val)
 		{
+			std::lock_guard<std::mutex> lock(io_mutex);
 			memory_segment<UX> *segment = nullptr;
 			addr_t uva = mpa_to_uva(segment, va);
 			if (unlikely(!segment)) return -1;
@@ -185,6 +370,7 @@ namespace riscv {
 
 		virtual buserror_t load_16(addr_t va, u16 &val)
 		{
+			std::lock_guard<std::mutex> lock(io_mutex);
 			memory_segment<UX> *segment = nullptr;
 			addr_t uva = mpa_to_uva(segment, va);
 			if (unlikely(!segment)) return -1;
@@ -193,6 +379,7 @@ namespace riscv {
 
 		virtual buserror_t load_32(addr_t va, u32 &val)
 		{
+			std::lock_guard<std::mutex> lock(io_mutex);
 			memory_segment<UX> *segment = nullptr;
 			addr_t uva = mpa_to_uva(segment, va);
 			if (unlikely(!segment)) return -1;
@@ -201,22 +388,26 @@ namespace riscv {
 
 		virtual buserror_t load_64(addr_t va, u64 &val)
 		{
+			std::lock_guard<std::mutex> lock(io_mutex);
 			memory_segment<UX> *segment = nullptr;
 			addr_t uva = mpa_to_uva(segment, va);
 			if (unlikely(!segment)) return -1;
 			return segment->load_64(uva, val);
 		}
 
-  	        virtual buserror_t load_bytes(addr_t va, char *bytes, size_t len)
+		/* bursts copy main memory or go to a device if one segment holds the range */
+		virtual buserror_t load_bytes(addr_t va, char *bytes, size_t len)
 		{
-		    memory_segment<UX> *segment = nullptr;
-		    addr_t uva = mpa_to_uva(segment, va);
-		    if (unlikely(!segment)) return -1;
-		    return segment->load_bytes(uva, bytes, len);
+			if (copy_from_mpa(bytes, va, len) == 0) return 0;
+			std::lock_guard<std::mutex> lock(io_mutex);
+			segment_index_ent *ent = lookup_segment(va);
+			if (!ent || len == 0 || len - 1 > UX(ent->end - va)) return -1;
+			return ent->seg->load_bytes(ent->uva + UX(va - ent->mpa), bytes, len);
 		}
 
 		virtual buserror_t store_8 (addr_t va, u8  val)
 		{
+			std::lock_guard<std::mutex> lock(io_mutex);
 			memory_segment<UX> *segment = nullptr;
 			addr_t uva = mpa_to_uva(segment, va);
 			if (unlikely(!segment)) return -1;
@@ -225,6 +416,7 @@ namespace riscv {
 
 		virtual buserror_t store_16(addr_t va, u16 val)
 		{
+			std::lock_guard<std::mutex> lock(io_mutex);
 			memory_segment<UX> *segment = nullptr;
 			addr_t uva = mpa_to_uva(segment, va);
 			if (unlikely(!segment)) return -1;
@@ -233,6 +425,7 @@ namespace riscv {
 
 		virtual buserror_t store_32(addr_t va, u32 val)
 		{
+			std::lock_guard<std::mutex> lock(io_mutex);
 			memory_segment<UX> *segment = nullptr;
 			addr_t uva = mpa_to_uva(segment, va);
 			if (unlikely(!segment)) return -1;
@@ -241,18 +434,20 @@ namespace riscv {
 
 		virtual buserror_t store_64(addr_t va, u64 val)
 		{
+			std::lock_guard<std::mutex> lock(io_mutex);
 			memory_segment<UX> *segment = nullptr;
 			addr_t uva = mpa_to_uva(segment, va);
 			if (unlikely(!segment)) return -1;
 			return segment->store_64(uva, val);
 		}
 
-  	        virtual buserror_t store_bytes(addr_t va, char *bytes, size_t len)
+		virtual buserror_t store_bytes(addr_t va, char *bytes, size_t len)
 		{
-		    memory_segment<UX> *segment = nullptr;
-		    addr_t uva = mpa_to_uva(segment, va);
-		    if (unlikely(!segment)) return -1;
-		    return segment->store_bytes(uva, bytes, len);
+			if (copy_to_mpa(va, bytes, len) == 0) return 0;
+			std::lock_guard<std::mutex> lock(io_mutex);
+			segment_index_ent *ent = lookup_segment(va);
+			if (!ent || len == 0 || len - 1 > UX(ent->end - va)) return -1;
+			return ent->seg->store_bytes(ent->uva + UX(va - ent->mpa), bytes, len);
 		}
 	};
 };
@@ -96,22 +96,24 @@ namespace riscv {
 		}
 		    
 
+		/* host address of the instruction at pc for the decoded block cache
+		 * (returns 0 if the fetch needs the slow path) */
+		template <typename P> addr_t inst_host(P &proc, UX pc)
+		{
+			if (proc.log & proc_log_hist_pc) return 0;
+			return (pc & (sizeof(u16) - 1)) == 0 && inst_addr_check(proc, pc) ? addr_t(pc) : 0;
+		}
+
+		/* user code is only made coherent with fence.i */
+		template <typename P> void inst_code_page(P &proc, UX pc, addr_t host) {}
+
+		static const u64 code_gen = 0;
+
 		template <typename P> inst_t inst_fetch(P &proc, UX pc, typename P::ux &pc_offset)
 		{
 			/* record pc histogram using machine physical address */
 			if (proc.log & proc_log_hist_pc) {
-				size_t iters = proc.histogram_add_pc(pc);
-				if (proc.log & proc_log_jit_trap) {
-					switch (iters) {
-						case P::hostspot_trace_skip:
-							break;
-						default:
-							if (iters >= proc.trace_iters) {
-								proc.raise(P::internal_cause_hotspot, pc);
-							}
-							break;
-					}
-				}
+				proc.histogram_add_pc(pc);
 			}
 			if (!inst_addr_check(proc, pc)) {
 			        proc.raise(rv_cause_fault_fetch, pc_offset);
@@ -143,6 +145,20 @@ namespace riscv {
 			*((T*)addr_t(va & (memory_top - 1))) = val2;
 		}
 
+		/* the reservation is the address held in proc.lr, shared with the JIT */
+		template <typename P, typename T> void load_reserved(P &proc, UX va, T &val)
+		{
+			proc.lr = va;
+			load<P,T>(proc, va, val);
+		}
+
+		template <typename P, typename T> UX store_conditional(P &proc, UX va, T val)
+		{
+			if (UX(proc.lr) != va) return 1;
+			store<P,T>(proc, va, val);
+			return 0;
+		}
+
 		template <typename P, typename T> void load(P &proc, UX va, T &val)
 		{
    		        if (!rw_addr_check(proc, va) && !ro_addr_check(proc, va)) {
@@ -7,10 +7,11 @@
 
 namespace riscv {
 
-	template <typename UX, typename TLB, typename PMA, typename MEMORY = user_memory<UX>>
+	template <typename UX, typename TLB, typename STLB, typename PMA, typename MEMORY = user_memory<UX>>
 	struct mmu_soft
 	{
 		typedef TLB    tlb_type;
+		typedef STLB   stlb_type;
 		typedef PMA    pma_type;
 
 		typedef std::shared_ptr<MEMORY> memory_type;
@@ -25,16 +26,154 @@ namespace riscv {
 
 		tlb_type       l1_itlb;     /* L1 Instruction TLB */
 		tlb_type       l1_dtlb;     /* L1 Data TLB */
+		stlb_type      l2_stlb;     /* L2 Superpage TLB (shared) */
 		pma_type       pma;         /* PMA table */
 		memory_type    mem;         /* memory device */
 
+		/* decoded instruction coherence */
+
+		enum { code_filter_bits = 65536 };
+
+		u64            code_gen;    /* bumped by stores to code pages */
+		u64            code_filter[code_filter_bits >> 6]; /* physical pages holding decoded code */
+
 		/* MMU constructor */
 
-		mmu_soft() : mem(std::make_shared<MEMORY>()) {}
-		mmu_soft(memory_type mem) : mem(mem) {}
+		mmu_soft() : mem(std::make_shared<MEMORY>()), code_gen(0), code_filter() {}
+		mmu_soft(memory_type mem) : mem(mem), code_gen(0), code_filter() {}
 
 		/* MMU methods */
 
+		/* save or restore the TLBs, host pointers are not valid across runs */
+		template <typename S>
+		void snapshot(S &s)
+		{
+			s.io(l1_itlb);
+			s.io(l1_dtlb);
+			s.io(l2_stlb);
+			if (S::reading) {
+				l1_itlb.clear_host();
+				l1_dtlb.clear_host();
+				code_gen++;
+				memset(code_filter, 0, sizeof(code_filter));
+			}
+		}
+
+		/* main memory is accessed directly via a host pointer, IO via the memory bus */
+		template <typename T> buserror_t mem_load(addr_t mpa, T &val)
+		{
+			T *host = mem->template mpa_to_host<T>(mpa);
+			if (likely(host != nullptr)) {
+				val = *host;
+				return 0;
+			}
+			return mem->load(mpa, val);
+		}
+
+		template <typename T> buserror_t mem_store(addr_t mpa, T val)
+		{
+			T *host = mem->template mpa_to_host<T>(mpa);
+			if (likely(host != nullptr)) {
+				*host = val;
+				return 0;
+			}
+			return mem->store(mpa, val);
+		}
+
+		/* code pages are tracked in a filter indexed by physical page number */
+		bool code_page(addr_t mpa)
+		{
+			size_t bit = (mpa >> page_shift) & (code_filter_bits - 1);
+			return (code_filter[bit >> 6] >> (bit & 63)) & 1;
+		}
+
+		/* a store hit a page with decoded code so invalidate the decoded caches */
+		void code_store()
+		{
+			code_gen++;
+			memset(code_filter, 0, sizeof(code_filter));
+		}
+
+		/* host address of the instruction at pc for the decoded block cache
+		 * (returns 0 if the fetch needs the slow path, including fetches
+		 * from ROM devices and IO, which are only reachable via the bus) */
+		template <typename P> addr_t inst_host(P &proc, UX pc)
+		{
+			if (proc.log & proc_log_hist_pc) return 0;
+			u16 *host = translate_host<P,u16,op_fetch>(proc, pc);
+			if (likely(host != nullptr)) return addr_t(host);
+			if ((effective_mode(proc, op_fetch) >= rv_mode_M || proc.mstatus.r.vm == rv_vm_mbare) &&
+				!misaligned<u16>(pc)) {
+				return addr_t(mem->template mpa_to_host<u16>(pc));
+			}
+			return 0;
+		}
+
+		/* mark the page holding pc as code, stores to it then take the slow path */
+		template <typename P> void inst_code_page(P &proc, UX pc, addr_t host)
+		{
+			typename tlb_type::tlb_entry_t* tlb_ent = nullptr;
+			addr_t mpa = translate_addr<P,op_fetch>(proc, pc, tlb_ent);
+			size_t bit = (mpa >> page_shift) & (code_filter_bits - 1);
+			code_filter[bit >> 6] |= (1ULL << (bit & 63));
+			l1_dtlb.clear_wtag(host - (pc & ~page_mask));
+		}
+
+		/* flush TLB entries for the current address space */
+		template <typename P> void flush_tlb(P &proc)
+		{
+			UX asid = proc.sptbr >> tlb_type::ppn_bits;
+			l1_itlb.flush(proc.pdid, asid);
+			l1_dtlb.flush(proc.pdid, asid);
+			l2_stlb.flush(proc.pdid, asid);
+		}
+
+		/* flush TLB entries for a virtual address in the current address space */
+		template <typename P> void flush_tlb(P &proc, UX va)
+		{
+			UX asid = proc.sptbr >> tlb_type::ppn_bits;
+			l1_itlb.flush(proc.pdid, asid, va);
+			l1_dtlb.flush(proc.pdid, asid, va);
+			l2_stlb.flush(proc.pdid, asid, va);
+		}
+
+		/* privilege context folded into the TLB access tags */
+		template <typename P> constexpr UX tlb_context(P &proc, UX privilege_level)
+		{
+			return privilege_level | (proc.mstatus.r.pum << 2) | (proc.mstatus.r.mxr << 3);
+		}
+
+		/* translate to a host pointer using the TLB access tags
+		 * (returns nullptr if the access needs to take the slow path) */
+		template <typename P, typename T, const mmu_op op> T* translate_host(P &proc, UX va)
+		{
+			UX effective_privilege_level = effective_mode(proc, op);
+			if (effective_privilege_level >= rv_mode_M ||
+				proc.mstatus.r.vm == rv_vm_mbare || misaligned<T>(va)) {
+				return nullptr;
+			}
+			tlb_type &tlb = op == op_fetch ? l1_itlb : l1_dtlb;
+			return reinterpret_cast<T*>(tlb.lookup_host(proc.pdid,
+				proc.sptbr >> tlb_type::ppn_bits, va,
+				tlb_context(proc, effective_privilege_level), op == op_store));
+		}
+
+		/* cache the host page and access tag after a permitted access to main memory */
+		template <typename P, const mmu_op op> void tlb_fill_host(
+			P &proc, UX va, addr_t mpa, typename tlb_type::tlb_entry_t* tlb_ent)
+		{
+			if (!tlb_ent || (op == op_store && code_page(mpa))) return;
+			addr_t uva = addr_t(mem->mpa_to_host(mpa & page_mask, page_size));
+			if (!uva) return;
+			UX tag = tlb_type::access_tag(va, tlb_context(proc, effective_mode(proc, op)));
+			tlb_ent->uva = uva;
+			if (op == op_store) {
+				tlb_ent->wtag = tag;
+			} else {
+				tlb_ent->rtag = tag;
+			}
+		}
+
 		template <typename T> constexpr bool misaligned(UX va)
 		{
 			return (va & (sizeof(T) - 1)) != 0;
@@ -105,6 +244,21 @@ namespace riscv {
 			inst_t inst = 0;
 			u16 inst_16;
 
+			/* fast path for ITLB hits on main memory pages (histogram needs the mpa) */
+			u16 *host = translate_host<P,u16,op>(proc, pc);
+			if (likely(host != nullptr && !(proc.log & proc_log_hist_pc))) {
+				inst = htole16(host[0]);
+				size_t len = inst_length(inst);
+				if (likely(len != 0 && (pc & ~page_mask) + len <= page_size)) {
+					for (size_t i = 1; i < (len >> 1); i++) {
+						inst |= inst_t(htole16(host[i])) << (i << 4);
+					}
+					pc_offset = len;
+					return inst;
+				}
+				inst = 0;
+			}
+
 			/* raise exception if address is misalligned */
 			if (unlikely(misaligned<u16>(pc))) {
 				proc.raise(rv_cause_misaligned_fetch, pc);
@@ -116,10 +270,11 @@ namespace riscv {
 			if (!mpa) return 0;
 
 			/* check execute permissions and fetch first 16 bits */
-			if (unlikely(fetch_access_fault(proc, proc.mode, tlb_ent) || mem->load(mpa, inst_16))) {
+			if (unlikely(fetch_access_fault(proc, proc.mode, tlb_ent) || mem_load(mpa, inst_16))) {
 				proc.raise(rv_cause_fault_fetch, pc);
 				return 0;
 			}
+			tlb_fill_host<P,op>(proc, pc, mpa, tlb_ent);
 
 			/* record pc histogram using machine physical address */
 			if (proc.log & proc_log_hist_pc) {
@@ -131,36 +286,36 @@ namespace riscv {
 			if ((inst & 0b11) != 0b11) {
 				pc_offset = 2;
 			} else if ((inst & 0b11100) != 0b11100) {
-				if (unlikely(mem->load(mpa + 2, inst_16))) {
+				if (unlikely(mem_load(mpa + 2, inst_16))) {
 					proc.raise(rv_cause_fault_fetch, pc);
 					return 0;
 				}
 				inst |= inst_t(htole16(inst_16)) << 16;
 				pc_offset = 4;
 			} else if ((inst & 0b111111) == 0b011111) {
-				if (unlikely(mem->load(mpa + 2, inst_16))) {
+				if (unlikely(mem_load(mpa + 2, inst_16))) {
 					proc.raise(rv_cause_fault_fetch, pc);
 					return 0;
 				}
 				inst |= inst_t(htole16(inst_16)) << 16;
-				if (unlikely(mem->load(mpa + 4, inst_16))) {
+				if (unlikely(mem_load(mpa + 4, inst_16))) {
 					proc.raise(rv_cause_fault_fetch, pc);
 					return 0;
 				}
 				inst |= inst_t(htole16(inst_16)) << 32;
 				pc_offset = 6;
 			} else if ((inst & 0b1111111) == 0b0111111) {
-				if (unlikely(mem->load(mpa + 2, inst_16))) {
+				if (unlikely(mem_load(mpa + 2, inst_16))) {
 					proc.raise(rv_cause_fault_fetch, pc);
 					return 0;
 				}
 				inst |= inst_t(htole16(inst_16)) << 16;
-				if (unlikely(mem->load(mpa + 4, inst_16))) {
+				if (unlikely(mem_load(mpa + 4, inst_16))) {
 					proc.raise(rv_cause_fault_fetch, pc);
 					return 0;
 				}
 				inst |= inst_t(htole16(inst_16)) << 32;
-				if (unlikely(mem->load(mpa + 6, inst_16))) {
+				if (unlikely(mem_load(mpa + 6, inst_16))) {
 					proc.raise(rv_cause_fault_fetch, pc);
 					return 0;
 				}
@@ -189,21 +344,83 @@ namespace riscv {
 			addr_t mpa = translate_addr<P,op>(proc, va, tlb_ent);
 			if (!mpa) return;
 
-			/* TODO - plumb amo interface into the memory bus */
-
-			/* Check read permissions and perform load */
-			if (unlikely(load_access_fault(proc, proc.mode, tlb_ent) || mem->load(mpa, val1))) {
+			/* check read and write permissions */
+			if (unlikely(load_access_fault(proc, proc.mode, tlb_ent) ||
+				store_access_fault(proc, proc.mode, tlb_ent))) {
 				proc.raise(rv_cause_fault_store, va);
 				return;
 			}
 
-			/* execute atomic op */
-			val2 = amo_fn<UX>(a_op, val1, val2);
+			/* main memory uses host atomics as other harts may access it concurrently */
+			T *host = mem->template mpa_to_host<T>(mpa);
+			if (likely(host != nullptr)) {
+				val1 = amo_atomic<T>(a_op, host, val2);
+			} else {
+				if (unlikely(mem_load(mpa, val1))) {
+					proc.raise(rv_cause_fault_store, va);
+					return;
+				}
+				val2 = amo_fn<UX>(a_op, val1, val2);
+				if (unlikely(mem_store(mpa, val2))) {
+					proc.raise(rv_cause_fault_store, va);
+					return;
+				}
+			}
+			if (unlikely(code_page(mpa))) code_store();
+		}
+
+		/* load reserved, the reservation holds the address and the loaded value */
+		template <typename P, typename T>
+		void load_reserved(P &proc, UX va, T &val)
+		{
+			load<P,T>(proc, va, val);
+			proc.lr = va;
+			proc.lr_val = val;
+		}
+
+		/*
+		 * store conditional, returns 0 on success
+		 *
+		 * The store is a host compare and swap against the value loaded by LR,
+		 * so it fails if another hart changed the reserved word in between.
+		 * A store of the same value by another hart does not break the
+		 * reservation. Any SC invalidates the reservation.
+		 */
+		template <typename P, typename T, const mmu_op op = op_store>
+		UX store_conditional(P &proc, UX va, T val)
+		{
+			typename tlb_type::tlb_entry_t* tlb_ent = nullptr;
+
+			bool reserved = (proc.lr == typename P::sx(va));
+			proc.lr = -1;
+			if (!reserved) return 1;
 
-			/* Check write permissions and perform store */
-			if (unlikely(store_access_fault(proc, proc.mode, tlb_ent) || mem->store(mpa, val2))) {
+			/* raise exception if address is misalligned */
+			if (unlikely(misaligned<T>(va))) {
+				proc.raise(rv_cause_misaligned_store, va);
+				return 1;
+			}
+
+			/* translate to physical (raises exception on fault) */
+			addr_t mpa = translate_addr<P,op>(proc, va, tlb_ent);
+			if (!mpa) return 1;
+
+			/* check write permissions and perform store */
+			if (unlikely(store_access_fault(proc, proc.mode, tlb_ent))) {
 				proc.raise(rv_cause_fault_store, va);
+				return 1;
 			}
+			T *host = mem->template mpa_to_host<T>(mpa);
+			if (likely(host != nullptr)) {
+				T expect = T(proc.lr_val);
+				if (!__atomic_compare_exchange_n(host, &expect, val, false,
+					__ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) return 1;
+			} else if (unlikely(mem_store(mpa, val))) {
+				proc.raise(rv_cause_fault_store, va);
+				return 1;
+			}
+			if (unlikely(code_page(mpa))) code_store();
+			return 0;
 		}
 
 		/* load */
@@ -212,6 +429,13 @@ namespace riscv {
 		{
 			typename tlb_type::tlb_entry_t* tlb_ent = nullptr;
 
+			/* fast path for DTLB hits on main memory pages */
+			T *host = translate_host<P,T,op>(proc, va);
+			if (likely(host != nullptr)) {
+				val = *host;
+				return;
+			}
+
 			/* raise exception if address is misalligned */
 			if (unlikely(misaligned<T>(va))) {
 				proc.raise(rv_cause_misaligned_load, va);
@@ -223,9 +447,11 @@ namespace riscv {
 			if (!mpa) return;
 
 			/* check read permissions and perform load */
-			if (unlikely(load_access_fault(proc, proc.mode, tlb_ent)|| mem->load(mpa, val))) {
+			if (unlikely(load_access_fault(proc, proc.mode, tlb_ent)|| mem_load(mpa, val))) {
 				proc.raise(rv_cause_fault_load, va);
+				return;
 			}
+			tlb_fill_host<P,op>(proc, va, mpa, tlb_ent);
 		}
 
 		/* store */
@@ -234,6 +460,13 @@ namespace riscv {
 		{
 			typename tlb_type::tlb_entry_t* tlb_ent = nullptr;
 
+			/* fast path for DTLB hits on main memory pages */
+			T *host = translate_host<P,T,op>(proc, va);
+			if (likely(host != nullptr)) {
+				*host = val;
+				return;
+			}
+
 			/* raise exception if address is misalligned */
 			if (unlikely(misaligned<T>(va))) {
 				proc.raise(rv_cause_misaligned_store, va);
@@ -245,9 +478,12 @@ namespace riscv {
 			if (!mpa) return;
 
 			/* check write permissions and perform store */
-			if (unlikely(store_access_fault(proc, proc.mode, tlb_ent) || mem->store(mpa, val))) {
+			if (unlikely(store_access_fault(proc, proc.mode, tlb_ent) || mem_store(mpa, val))) {
 				proc.raise(rv_cause_fault_store, va);
+				return;
 			}
+			if (unlikely(code_page(mpa))) code_store();
+			tlb_fill_host<P,op>(proc, va, mpa, tlb_ent);
 		}
 
 		template <typename P> constexpr UX effective_mode(P &proc, const mmu_op op)
@@ -307,10 +543,10 @@ namespace riscv {
 		{
 			tlb_ent = tlb.lookup(proc.pdid, proc.sptbr >> tlb_type::ppn_bits, va);
 			if (tlb_ent) {
-				/* check if accessed and dirty flags are up-to-date */
+				/* check if accessed and dirty flags are up-to-date, otherwise
+				 * rewalk the page table to find the PTE address and update flags */
 				uintptr_t ad_flags = pte_flag_A | (op == op_store ? pte_flag_D : 0);
-				if ((tlb_ent->pteb & ad_flags) != ad_flags) {
-					/* rewalk the page table to find the PTE address and update flags */
+				if ((tlb_ent->pteb & ad_flags) == ad_flags) {
 					return page_translate_offset<PTM>(tlb_ent->ppn, va, tlb_ent->ptel);
 				}
 			}
@@ -324,16 +560,27 @@ namespace riscv {
 			tlb_type &tlb, typename tlb_type::tlb_entry_t* &tlb_ent)
 		{
 			/*
-			 * The simple direct mapped TLB implementation currently maps page_size
-			 * entries so as a byproduct, the code will rewalk the page table every
-			 * page_size interval, even if the PTE points to a megapage or gigapage.
-			 * Can be solved by adding a secondary TLB with larger scoped entries.
+			 * The direct mapped L1 TLBs map page_size entries so megapages and
+			 * gigapages are cached in the secondary superpage TLB, which is
+			 * consulted before walking the page table. A hit refills the L1
+			 * entry for this page_size interval of the superpage.
 			 */
 
 			typename PTM::pte_type pte;
+			UX asid = proc.sptbr >> tlb_type::ppn_bits;
 			UX level;
 
-			/* TODO: TLB statistics */
+			/* Lookup the superpage TLB (accessed and dirty flags must be up-to-date) */
+			typename stlb_type::tlb_entry_t *stlb_ent = l2_stlb.lookup(proc.pdid, asid, va);
+			if (stlb_ent) {
+				uintptr_t ad_flags = pte_flag_A | (op == op_store ? pte_flag_D : 0);
+				if ((stlb_ent->pteb & ad_flags) == ad_flags) {
+					tlb_ent = tlb.insert(proc.pdid, asid, va,
+						stlb_ent->ptel, stlb_ent->pteb, stlb_ent->ppn);
+					tlb.add_superpage(proc.pdid, va, stlb_ent->shift);
+					return page_translate_offset<PTM>(stlb_ent->ppn, va, stlb_ent->ptel);
+				}
+			}
 
 			/* Walk the page table to find a leaf PTE entry
 			 * (access fault is raised if leaf PTE is not found) */
@@ -341,9 +588,16 @@ namespace riscv {
 			if (!pa) return 0;
 
 			/* Insert the virtual to physical mapping into the TLB */
-			tlb_ent = tlb.insert(proc.pdid, proc.sptbr >> tlb_type::ppn_bits,
+			tlb_ent = tlb.insert(proc.pdid, asid,
 				va, level, pte.val.flags, pte.val.ppn);
 
+			/* Insert megapage and gigapage mappings into the superpage TLB */
+			if (level > 0) {
+				UX shift = PTM::bits * level + page_shift;
+				l2_stlb.insert(proc.pdid, asid, va, shift, level, pte.val.flags, pte.val.ppn);
+				tlb.add_superpage(proc.pdid, va, shift);
+			}
+
 			return pa;
 		}
 
@@ -372,7 +626,7 @@ namespace riscv {
 				pte_mpa = ppn + vpn * sizeof(pte_type);
 
 				/* load the PTE from memory */
-				if (unlikely(mem->load(pte_mpa, *(typename PTM::size_type*)&pte))) goto fault;
+				if (unlikely(mem_load(pte_mpa, *(typename PTM::size_type*)&pte))) goto fault;
 
 				/* check if this is a pointer PTE */
 				if ((((pte.xu.val >> pte_shift_R) |
@@ -398,7 +652,7 @@ namespace riscv {
 					if ((pte.val.flags & ad_flags) != ad_flags) {
 						pte.val.flags |= ad_flags;
 						/* update PTE (note this reall needs to be atomic) */
-						if (unlikely(mem->store(pte_mpa, *(typename PTM::size_type*)&pte))) goto fault;
+						if (unlikely(mem_store(pte_mpa, *(typename PTM::size_type*)&pte))) goto fault;
 					}
 
 					if (proc.log & proc_log_pagewalk) {
@@ -435,11 +689,14 @@ namespace riscv {
 	typedef tagged_tlb_rv32<128> tlb_type_rv32;
 	typedef tagged_tlb_rv64<128> tlb_type_rv64;
 
+	typedef superpage_tlb_rv32<16> stlb_type_rv32;
+	typedef superpage_tlb_rv64<16> stlb_type_rv64;
+
 	typedef pma_table<u32,8> pma_table_rv32;
 	typedef pma_table<u64,8> pma_table_rv64;
 
-	using mmu_soft_rv32 = mmu_soft<u32,tlb_type_rv32,pma_table_rv32>;
-	using mmu_soft_rv64 = mmu_soft<u64,tlb_type_rv64,pma_table_rv64>;
+	using mmu_soft_rv32 = mmu_soft<u32,tlb_type_rv32,stlb_type_rv32,pma_table_rv32>;
+	using mmu_soft_rv64 = mmu_soft<u64,tlb_type_rv64,stlb_type_rv64,pma_table_rv64>;
 
 }
 
@@ -163,7 +163,8 @@ namespace riscv {
 		u16 node_id;                  /* Node Identifier */
 		u16 hart_id;                  /* Hardware Thread Identifier */
 		u32 log;                      /* Log flags */
-		SX lr;                        /* Load Reservation (TODO - global) */
+		SX lr;                        /* Load Reservation address */
+		SX lr_val;                    /* Load Reservation value */
 		SX cause;                     /* Fault cause */
 		SX badaddr;                   /* Fault address */
 		jmp_buf env;                  /* Fault handler */
@@ -175,10 +176,19 @@ namespace riscv {
 		UX memory_registers : 1;      /* Memory backed registers (JIT) */
 		UX breakpoint;                /* Breakpoint */
 		UX trace_iters;               /* Trace iterations (JIT) */
+		UX trace_spill;               /* Host register spill slot (JIT) */
+		size_t trace_cache_limit;     /* Trace cache size limit in bytes, 0 is unbounded (JIT) */
 
 		u64 trace_pc[trace_l1_size];
 		u64 trace_fn[trace_l1_size];
 
+		/* Trace cache statistics (JIT) */
+
+		u64 trace_cache_bytes;        /* Trace cache occupancy in bytes */
+		u64 trace_cache_traces;       /* Trace cache occupancy in traces */
+		u64 trace_evictions;          /* Traces evicted from the trace cache */
+		u64 trace_retranslations;     /* Evicted traces that were translated again */
+
 		/* Base ISA Control and Status Registers */
 
 		u64 time;                     /* User Time Register */
@@ -186,10 +196,11 @@ namespace riscv {
 		u32 fcsr;                     /* Floating-Point Control and Status Register */
 
 		processor_base() : pc(0), ireg(), freg(),
-			node_id(0), hart_id(0), log(0), lr(0), cause(0), badaddr(0), env(),
+			node_id(0), hart_id(0), log(0), lr(0), lr_val(0), cause(0), badaddr(0), env(),
 			running(true), debugging(false), exceptions(true),
 			update_instret(false), memory_registers(false),
-			breakpoint(0), trace_iters(0), trace_pc(), trace_fn(),
+			breakpoint(0), trace_iters(0), trace_spill(0), trace_cache_limit(0), trace_pc(), trace_fn(),
+			trace_cache_bytes(0), trace_cache_traces(0), trace_evictions(0), trace_retranslations(0),
 			time(0), instret(0), fcsr(0) {}
 
 		/* Internal setjmp/longjump causes */
@@ -200,14 +211,12 @@ namespace riscv {
 			internal_cause_reset    = 0x1000,
 			internal_cause_cli      = 0x1001,
 			internal_cause_poweroff = 0x1002,
-			internal_cause_fatal    = 0x1003,
-			internal_cause_hotspot  = 0x1004
+			internal_cause_fatal    = 0x1003
 		};
 
-		/* program counter histogram sentinels */
+		/* program counter histogram saturation limit */
 		enum : size_t {
-			hostspot_trace_limit = std::numeric_limits<size_t>::max() - 1,
-			hostspot_trace_skip = std::numeric_limits<size_t>::max()
+			hostspot_trace_limit = std::numeric_limits<size_t>::max() - 1
 		};
 
 		void raise(int ex_cause, ux ex_addr)
@@ -0,0 +1,127 @@
+//
+//  processor-block-cache.h
+//
+
+#ifndef rv_processor_block_cache_h
+#define rv_processor_block_cache_h
+
+namespace riscv {
+
+	/*
+	 * block_cache
+	 *
+	 * Decoded basic block cache indexed by the host address of the first
+	 * instruction, which for main memory stands in for the physical address.
+	 *
+	 * Blocks end after a control transfer or system instruction, or at the
+	 * end of the page, so the runloop executes them without per instruction
+	 * fetch, TLB lookup or decode. The cache is invalidated by bumping the
+	 * generation (fence.i, or stores to code pages via the MMU code_gen).
+	 *
+	 * block[host] = gen:count:{dec,inst,len}[count]
+	 */
+
+	template <typename DEC, const size_t cache_size = 4096, const size_t block_max = 32>
+	struct block_cache
+	{
+		static_assert(ispow2(cache_size), "cache_size must be a power of 2");
+
+		struct block_inst
+		{
+			DEC     dec;                   /* decoded instruction */
+			inst_t  inst;                  /* source instruction (logging) */
+			u8      len;                   /* instruction length */
+		};
+
+		struct block_ent
+		{
+			addr_t  key;                   /* host address of the first instruction */
+			u64     gen;                   /* cache generation */
+			size_t  count;                 /* number of instructions */
+			block_inst inst[block_max];
+		};
+
+		std::vector<block_ent> blocks;
+		u64 gen;                           /* current generation, 0 never matches */
+		u64 code_gen;                      /* last seen MMU code store generation */
+
+		block_cache() : blocks(cache_size), gen(1), code_gen(0) {}
+
+		void flush()
+		{
+			gen++;
+		}
+
+		/* control transfer and system instructions end a block */
+		static bool is_terminator(DEC &dec)
+		{
+			switch (dec.op) {
+				case rv_op_jal:
+				case rv_op_jalr:
+				case rv_op_beq:
+				case rv_op_bne:
+				case rv_op_blt:
+				case rv_op_bge:
+				case rv_op_bltu:
+				case rv_op_bgeu:
+				case rv_op_fence_i:
+				case rv_op_ecall:
+				case rv_op_ebreak:
+				case rv_op_uret:
+				case rv_op_sret:
+				case rv_op_hret:
+				case rv_op_mret:
+				case rv_op_dret:
+				case rv_op_sfence_vm:
+				case rv_op_sfence_vma:
+				case rv_op_wfi:
+				case rv_op_csrrw:
+				case rv_op_csrrs:
+				case rv_op_csrrc:
+				case rv_op_csrrwi:
+				case rv_op_csrrsi:
+				case rv_op_csrrci:
+					return true;
+				default:
+					return false;
+			}
+		}
+
+		block_ent* lookup(addr_t key)
+		{
+			block_ent &ent = blocks[(key >> 1) & (cache_size - 1)];
+			return ent.key == key && ent.gen == gen ? &ent : nullptr;
+		}
+
+		/* decode a block from host memory, stopping at the end of the guest page */
+		template <typename P>
+		block_ent* fill(P &proc, addr_t key, addr_t pc)
+		{
+			block_ent &ent = blocks[(key >> 1) & (cache_size - 1)];
+			size_t remaining = page_size - (pc & ~page_mask);
+			addr_t addr = key;
+			ent.key = key;
+			ent.gen = gen;
+			ent.count = 0;
+			while (ent.count < block_max) {
+				inst_t inst = htole16(*(u16*)addr);
+				size_t len = inst_length(inst);
+				if (len == 0 || len > remaining) break;
+				for (size_t i = 1; i < (len >> 1); i++) {
+					inst |= inst_t(htole16(*(u16*)(addr + (i << 1)))) << (i << 4);
+				}
+				block_inst &bi = ent.inst[ent.count++];
+				proc.inst_decode(bi.dec, inst);
+				bi.inst = inst;
+				bi.len = len;
+				if (is_terminator(bi.dec)) break;
+				addr += len;
+				remaining -= len;
+			}
+			return &ent;
+		}
+	};
+
+}
+
+#endif
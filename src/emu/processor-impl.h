@@ -57,6 +57,7 @@ namespace riscv {
 		hist_inst_map_t hist_inst;
 		std::function<const char*(addr_t)> symlookup;
 		ext_pins pins;
+		std::shared_ptr<trace_writer> trace_out;
 		
 		processor_impl() : P()
 		{
@@ -242,11 +243,85 @@ namespace riscv {
 			return operands;
 		}
 
+		void trace_open(std::string filename)
+		{
+			trace_out = std::make_shared<trace_writer>(filename, P::xlen);
+		}
+
+		void trace_close()
+		{
+			if (trace_out) trace_out->close();
+		}
+
+		void trace_log(decode_type &dec, inst_t inst)
+		{
+			trace_record rec = trace_record();
+			rec.instret = P::instret;
+			rec.pc = P::pc;
+			rec.inst = inst;
+
+			/* register write, values are read after execution */
+			const rv_operand_data *operand_data = rv_inst_operand_data[dec.op];
+			for (; operand_data->type != rv_type_none; operand_data++) {
+				if (operand_data->operand_name == rv_operand_name_rd && dec.rd != rv_ireg_x0) {
+					rec.flags |= trace_flag_ireg;
+					rec.rd = dec.rd;
+					rec.rd_val = P::ireg[dec.rd].r.xu.val;
+				} else if (operand_data->operand_name == rv_operand_name_frd) {
+					rec.flags |= trace_flag_freg;
+					rec.rd = dec.rd;
+					rec.rd_val = P::freg[dec.rd].r.xu.val;
+				}
+			}
+
+			/* memory access, loaded values are the register write,
+			 * AMOs are recorded as a load of the old value */
+			switch (dec.op) {
+				case rv_op_lb: case rv_op_lbu: rec.width = 0; rec.flags |= trace_flag_load; break;
+				case rv_op_lh: case rv_op_lhu: rec.width = 1; rec.flags |= trace_flag_load; break;
+				case rv_op_lw: case rv_op_lwu: case rv_op_flw:
+				case rv_op_lr_w: rec.width = 2; rec.flags |= trace_flag_load; break;
+				case rv_op_ld: case rv_op_fld:
+				case rv_op_lr_d: rec.width = 3; rec.flags |= trace_flag_load; break;
+				case rv_op_sb: rec.width = 0; rec.flags |= trace_flag_store; break;
+				case rv_op_sh: rec.width = 1; rec.flags |= trace_flag_store; break;
+				case rv_op_sw: case rv_op_fsw: case rv_op_sc_w: rec.width = 2; rec.flags |= trace_flag_store; break;
+				case rv_op_sd: case rv_op_fsd: case rv_op_sc_d: rec.width = 3; rec.flags |= trace_flag_store; break;
+				case rv_op_amoswap_w: case rv_op_amoadd_w: case rv_op_amoxor_w:
+				case rv_op_amoor_w: case rv_op_amoand_w: case rv_op_amomin_w:
+				case rv_op_amomax_w: case rv_op_amominu_w: case rv_op_amomaxu_w:
+					rec.width = 2; rec.flags |= trace_flag_load; break;
+				case rv_op_amoswap_d: case rv_op_amoadd_d: case rv_op_amoxor_d:
+				case rv_op_amoor_d: case rv_op_amoand_d: case rv_op_amomin_d:
+				case rv_op_amomax_d: case rv_op_amominu_d: case rv_op_amomaxu_d:
+					rec.width = 3; rec.flags |= trace_flag_load; break;
+				default: break;
+			}
+			if (rec.flags & (trace_flag_load | trace_flag_store)) {
+				if ((rec.flags & trace_flag_ireg) && dec.rd == dec.rs1) {
+					rec.flags |= trace_flag_noaddr;
+				} else {
+					rec.mem_addr = P::ireg[dec.rs1].r.xu.val + dec.imm;
+				}
+				if (rec.flags & trace_flag_store) {
+					if (dec.op == rv_op_fsw || dec.op == rv_op_fsd) {
+						rec.mem_val = P::freg[dec.rs2].r.xu.val;
+					} else if ((rec.flags & trace_flag_ireg) && dec.rd == dec.rs2) {
+						rec.flags &= ~trace_flag_store; /* sc overwrote its source */
+					} else {
+						rec.mem_val = P::ireg[dec.rs2].r.xu.val;
+					}
+				}
+			}
+			trace_out->append(rec);
+		}
+
 		void print_log(decode_type &dec, inst_t inst)
 		{
 			static const char *fmt_32 = "%019llu core-%-4zu:%08llx (%s) %-30s %s\n";
 			static const char *fmt_64 = "%019llu core-%-4zu:%016llx (%s) %-30s %s\n";
 			static const char *fmt_128 = "%019llu core-%-4zu:%032llx (%s) %-30s %s\n";
+			if ((P::log & proc_log_trace) && inst) trace_log(dec, inst); /* traps log with inst 0 */
 			if (P::log & proc_log_hist_reg) histogram_add_regs(dec);
 			if (P::log & proc_log_hist_inst) histogram_add_inst(dec);
 			if (P::log & proc_log_inst) {
@@ -42,6 +42,13 @@ namespace riscv {
 		addr_t inst_exec(T &dec, addr_t pc_offset) {
 			return exec_inst_rv32<RV_I>(dec, *this, pc_offset);
 		}
+
+#if defined (ENABLE_THREADED_INTERP)
+		template <typename BI>
+		size_t inst_block(BI *insts, size_t count, T *&cur, typename P::ux inststop) {
+			return exec_block_rv32<RV_I>(insts, count, cur, *this, inststop);
+		}
+#endif
 	};
 
 	template <typename T, typename P, typename M, typename B = processor_impl<T,P,M>>
@@ -61,6 +68,13 @@ namespace riscv {
 		addr_t inst_exec(T &dec, addr_t pc_offset) {
 			return exec_inst_rv32<RV_IMA>(dec, *this, pc_offset);
 		}
+
+#if defined (ENABLE_THREADED_INTERP)
+		template <typename BI>
+		size_t inst_block(BI *insts, size_t count, T *&cur, typename P::ux inststop) {
+			return exec_block_rv32<RV_IMA>(insts, count, cur, *this, inststop);
+		}
+#endif
 	};
 
 	template <typename T, typename P, typename M, typename B = processor_impl<T,P,M>>
@@ -81,6 +95,13 @@ namespace riscv {
 		addr_t inst_exec(T &dec, addr_t pc_offset) {
 			return exec_inst_rv32<RV_IMAC>(dec, *this, pc_offset);
 		}
+
+#if defined (ENABLE_THREADED_INTERP)
+		template <typename BI>
+		size_t inst_block(BI *insts, size_t count, T *&cur, typename P::ux inststop) {
+			return exec_block_rv32<RV_IMAC>(insts, count, cur, *this, inststop);
+		}
+#endif
 	};
 
 	template <typename T, typename P, typename M, typename B = processor_impl<T,P,M>>
@@ -100,6 +121,13 @@ namespace riscv {
 		addr_t inst_exec(T &dec, addr_t pc_offset) {
 			return exec_inst_rv32<RV_IMAFD>(dec, *this, pc_offset);
 		}
+
+#if defined (ENABLE_THREADED_INTERP)
+		template <typename BI>
+		size_t inst_block(BI *insts, size_t count, T *&cur, typename P::ux inststop) {
+			return exec_block_rv32<RV_IMAFD>(insts, count, cur, *this, inststop);
+		}
+#endif
 	};
 
 	template <typename T, typename P, typename M, typename B = processor_impl<T,P,M>>
@@ -120,6 +148,13 @@ namespace riscv {
 		addr_t inst_exec(T &dec, addr_t pc_offset) {
 			return exec_inst_rv32<RV_IMAFDC>(dec, *this, pc_offset);
 		}
+
+#if defined (ENABLE_THREADED_INTERP)
+		template <typename BI>
+		size_t inst_block(BI *insts, size_t count, T *&cur, typename P::ux inststop) {
+			return exec_block_rv32<RV_IMAFDC>(insts, count, cur, *this, inststop);
+		}
+#endif
 	};
 
 
@@ -142,6 +177,13 @@ namespace riscv {
 		addr_t inst_exec(T &dec, addr_t pc_offset) {
 			return exec_inst_rv64<RV_I>(dec, *this, pc_offset);
 		}
+
+#if defined (ENABLE_THREADED_INTERP)
+		template <typename BI>
+		size_t inst_block(BI *insts, size_t count, T *&cur, typename P::ux inststop) {
+			return exec_block_rv64<RV_I>(insts, count, cur, *this, inststop);
+		}
+#endif
 	};
 
 	template <typename T, typename P, typename M, typename B = processor_impl<T,P,M>>
@@ -161,6 +203,13 @@ namespace riscv {
 		addr_t inst_exec(T &dec, addr_t pc_offset) {
 			return exec_inst_rv64<RV_IMA>(dec, *this, pc_offset);
 		}
+
+#if defined (ENABLE_THREADED_INTERP)
+		template <typename BI>
+		size_t inst_block(BI *insts, size_t count, T *&cur, typename P::ux inststop) {
+			return exec_block_rv64<RV_IMA>(insts, count, cur, *this, inststop);
+		}
+#endif
 	};
 
 	template <typename T, typename P, typename M, typename B = processor_impl<T,P,M>>
@@ -181,6 +230,13 @@ namespace riscv {
 		addr_t inst_exec(T &dec, addr_t pc_offset) {
 			return exec_inst_rv64<RV_IMAC>(dec, *this, pc_offset);
 		}
+
+#if defined (ENABLE_THREADED_INTERP)
+		template <typename BI>
+		size_t inst_block(BI *insts, size_t count, T *&cur, typename P::ux inststop) {
+			return exec_block_rv64<RV_IMAC>(insts, count, cur, *this, inststop);
+		}
+#endif
 	};
 
 	template <typename T, typename P, typename M, typename B = processor_impl<T,P,M>>
@@ -200,6 +256,13 @@ namespace riscv {
 		addr_t inst_exec(T &dec, addr_t pc_offset) {
 			return exec_inst_rv64<RV_IMAFD>(dec, *this, pc_offset);
 		}
+
+#if defined (ENABLE_THREADED_INTERP)
+		template <typename BI>
+		size_t inst_block(BI *insts, size_t count, T *&cur, typename P::ux inststop) {
+			return exec_block_rv64<RV_IMAFD>(insts, count, cur, *this, inststop);
+		}
+#endif
 	};
 
 	template <typename T, typename P, typename M, typename B = processor_impl<T,P,M>>
@@ -220,6 +283,13 @@ namespace riscv {
 		addr_t inst_exec(T &dec, addr_t pc_offset) {
 			return exec_inst_rv64<RV_IMAFDC>(dec, *this, pc_offset);
 		}
+
+#if defined (ENABLE_THREADED_INTERP)
+		template <typename BI>
+		size_t inst_block(BI *insts, size_t count, T *&cur, typename P::ux inststop) {
+			return exec_block_rv64<RV_IMAFDC>(insts, count, cur, *this, inststop);
+		}
+#endif
 	};
 
 
@@ -242,6 +312,13 @@ namespace riscv {
 		addr_t inst_exec(T &dec, addr_t pc_offset) {
 			return exec_inst_rv128<RV_I>(dec, *this, pc_offset);
 		}
+
+#if defined (ENABLE_THREADED_INTERP)
+		template <typename BI>
+		size_t inst_block(BI *insts, size_t count, T *&cur, typename P::ux inststop) {
+			return exec_block_rv128<RV_I>(insts, count, cur, *this, inststop);
+		}
+#endif
 	};
 
 	template <typename T, typename P, typename M, typename B = processor_impl<T,P,M>>
@@ -261,6 +338,13 @@ namespace riscv {
 		addr_t inst_exec(T &dec, addr_t pc_offset) {
 			return exec_inst_rv128<RV_IMA>(dec, *this, pc_offset);
 		}
+
+#if defined (ENABLE_THREADED_INTERP)
+		template <typename BI>
+		size_t inst_block(BI *insts, size_t count, T *&cur, typename P::ux inststop) {
+			return exec_block_rv128<RV_IMA>(insts, count, cur, *this, inststop);
+		}
+#endif
 	};
 
 	template <typename T, typename P, typename M, typename B = processor_impl<T,P,M>>
@@ -281,6 +365,13 @@ namespace riscv {
 		addr_t inst_exec(T &dec, addr_t pc_offset) {
 			return exec_inst_rv128<RV_IMAC>(dec, *this, pc_offset);
 		}
+
+#if defined (ENABLE_THREADED_INTERP)
+		template <typename BI>
+		size_t inst_block(BI *insts, size_t count, T *&cur, typename P::ux inststop) {
+			return exec_block_rv128<RV_IMAC>(insts, count, cur, *this, inststop);
+		}
+#endif
 	};
 
 	template <typename T, typename P, typename M, typename B = processor_impl<T,P,M>>
@@ -300,6 +391,13 @@ namespace riscv {
 		addr_t inst_exec(T &dec, addr_t pc_offset) {
 			return exec_inst_rv128<RV_IMAFD>(dec, *this, pc_offset);
 		}
+
+#if defined (ENABLE_THREADED_INTERP)
+		template <typename BI>
+		size_t inst_block(BI *insts, size_t count, T *&cur, typename P::ux inststop) {
+			return exec_block_rv128<RV_IMAFD>(insts, count, cur, *this, inststop);
+		}
+#endif
 	};
 
 	template <typename T, typename P, typename M, typename B = processor_impl<T,P,M>>
@@ -320,6 +418,13 @@ namespace riscv {
 		addr_t inst_exec(T &dec, addr_t pc_offset) {
 			return exec_inst_rv128<RV_IMAFDC>(dec, *this, pc_offset);
 		}
+
+#if defined (ENABLE_THREADED_INTERP)
+		template <typename BI>
+		size_t inst_block(BI *insts, size_t count, T *&cur, typename P::ux inststop) {
+			return exec_block_rv128<RV_IMAFDC>(insts, count, cur, *this, inststop);
+		}
+#endif
 	};
 
 }
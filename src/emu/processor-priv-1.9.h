@@ -233,6 +233,55 @@ namespace riscv {
 		inline bool mie_seie() { return (mie.xu.val >> se_shift) & 1; }
 		inline bool mie_heie() { return (mie.xu.val >> he_shift) & 1; }
 		inline bool mie_meie() { return (mie.xu.val >> me_shift) & 1; }
+
+		/* save or restore architectural state (processor-snapshot.h) */
+		template <typename S>
+		void snapshot(S &s)
+		{
+			s.io(processor_type::pc);
+			s.io(processor_type::ireg);
+			s.io(processor_type::freg);
+			s.io(processor_type::fcsr);
+			s.io(processor_type::time);
+			s.io(processor_type::instret);
+			s.io(processor_type::lr);
+			s.io(processor_type::lr_val);
+			s.io(pdid);
+			s.io(mode);
+			s.io(resetvec);
+			s.io(misa);
+			s.io(mvendorid);
+			s.io(marchid);
+			s.io(mimpid);
+			s.io(mhartid);
+			s.io(mstatus);
+			s.io(mtvec);
+			s.io(medeleg);
+			s.io(mideleg);
+			s.io(mip);
+			s.io(mie);
+			s.io(mhcounteren);
+			s.io(mscounteren);
+			s.io(mucounteren);
+			s.io(mscratch);
+			s.io(mepc);
+			s.io(mcause);
+			s.io(mbadaddr);
+			s.io(mbase);
+			s.io(mbound);
+			s.io(mibase);
+			s.io(mibound);
+			s.io(mdbase);
+			s.io(mdbound);
+			s.io(stvec);
+			s.io(sedeleg);
+			s.io(sideleg);
+			s.io(sscratch);
+			s.io(sepc);
+			s.io(scause);
+			s.io(sbadaddr);
+			s.io(sptbr);
+		}
 	};
 
 	using processor_priv_rv32imafd = processor_priv<s32,u32,ireg_rv32,32,freg_fp64,32>;
@@ -264,6 +313,20 @@ namespace riscv {
 		std::mutex intr_mutex;
 		std::condition_variable intr_cond;
 
+		/*
+		 * harts share the boot hart's memory and devices and each run on
+		 * their own host thread. devices hold a reference to the boot hart
+		 * so hart() is used to find the hart running on the calling thread
+		 */
+		processor_privileged *boot_hart;
+		std::vector<processor_privileged*> harts;
+		size_t num_harts;
+		std::atomic<bool> poweroff_req;
+		static thread_local processor_privileged *hart_self;
+
+		bool virtual_time;            /* time is instret plus time skipped by wfi */
+		u64 time_skip;
+
 		std::string stats_dirname;
 
 		const char* name() { return "rv-sys"; }
@@ -275,10 +338,16 @@ namespace riscv {
 		const u64 POWERDOWN_DELAY_DEFAULT = 10000;
 		const u64 POWERDOWN_SLEEP_DEFAULT = 1000000;
 
-		processor_privileged() : intr_sleep_time(0), intr_powerdown_delay(1000), pollfds() {}
+		processor_privileged() : intr_sleep_time(0), intr_powerdown_delay(1000), pollfds(),
+			boot_hart(this), num_harts(1), poweroff_req(false),
+			virtual_time(false), time_skip(0) {}
+
+		processor_privileged& hart() { return hart_self ? *hart_self : *this; }
 
 		u64 get_time()
 		{
+			if (virtual_time) return clock_time();
+
 			/*
 			 * TODO - add hz to config string
 			 * 10MHz is currently hardcoded in BBL
@@ -286,6 +355,32 @@ namespace riscv {
 			return host_cpu::get_instance().get_time_ns() / RTC_DIV;
 		}
 
+		/* time base for the RTC and timer */
+		u64 clock_time()
+		{
+			return virtual_time ? P::instret + time_skip : cpu_cycle_clock();
+		}
+
+		/* with virtual time, stop the step at the next timer deadline */
+		size_t step_limit(size_t count)
+		{
+			if (!virtual_time) return count;
+			u64 deadline = device_timer->next_deadline(P::hart_id);
+			u64 now = clock_time();
+			return deadline > now ? size_t(std::min<u64>(count, deadline - now)) : count;
+		}
+
+		/* with virtual time, wfi skips ahead to the next timer deadline */
+		bool skip_idle()
+		{
+			if (!virtual_time) return false;
+			u64 deadline = device_timer->next_deadline(P::hart_id);
+			if (deadline == std::numeric_limits<u64>::max()) return false;
+			u64 now = clock_time();
+			if (deadline > now) time_skip += deadline - now;
+			return true;
+		}
+
 		std::string create_config_string()
 		{
 			typename P::ux ram_base = 0;
@@ -320,14 +415,24 @@ ram {
   };
 };
 core {
-  0 {
+%s};)CONFIG";
+			static const char* kCoreFormat =
+R"CONFIG(  %d {
     0 {
       isa rv64imafd;
       ipi 0x%x;
       timecmp 0x%x;
     };
   };
-};)CONFIG";
+)CONFIG";
+			std::string core_str;
+			for (size_t i = 0; i < num_harts; i++) {
+				std::string hart_str;
+				sprintf(hart_str, kCoreFormat, i,
+					device_mipi->mpa + sizeof(u32) * i,
+					device_timer->mpa + sizeof(u64) * i);
+				core_str.append(hart_str);
+			}
 			std::string cfg_str;
 			sprintf(cfg_str, kConfigFormat,
 				device_rtc->mpa,
@@ -336,8 +441,7 @@ core {
 				device_htif->mpa,
 				device_htif->mpa + 8,
 				ram_base, ram_size,
-				device_mipi->mpa,
-				device_timer->mpa);
+				core_str);
 			return cfg_str;
 		}
 
@@ -381,6 +485,72 @@ core {
 			P::mmu.mem->add_segment(device_config);
 			P::mmu.mem->add_segment(device_string);
 			P::mmu.mem->add_segment(device_external);
+
+			harts.push_back(this);
+			hart_self = this;
+		}
+
+		/* initialize a secondary hart sharing memory and devices with the boot hart */
+		void init_hart(processor_privileged &boot, size_t id)
+		{
+			P::misa = P::misa_default;
+			P::hart_id = P::mhartid = id;
+			P::mmu.mem = boot.mmu.mem;
+			boot_hart = &boot;
+			boot.harts.push_back(this);
+
+			console = boot.console;
+			device_sbi = boot.device_sbi;
+			device_boot = boot.device_boot;
+			device_rtc = boot.device_rtc;
+			device_mipi = boot.device_mipi;
+			device_plic = boot.device_plic;
+			device_uart = boot.device_uart;
+			device_timer = boot.device_timer;
+			device_gpio = boot.device_gpio;
+			device_rand = boot.device_rand;
+			device_htif = boot.device_htif;
+			device_config = boot.device_config;
+			device_string = boot.device_string;
+			device_external = boot.device_external;
+		}
+
+		/* make this the hart on the calling thread */
+		void bind_thread()
+		{
+			hart_self = this;
+		}
+
+		/* called on a secondary hart's thread before it runs */
+		void hart_thread_init()
+		{
+			sigset_t set;
+			sigfillset(&set);
+			if (pthread_sigmask(SIG_BLOCK, &set, NULL) != 0) {
+				panic("can't set thread signal mask: %s", strerror(errno));
+			}
+			hart_self = this;
+		}
+
+		/* wake harts sleeping in wfi */
+		void wake_harts()
+		{
+			for (auto h : boot_hart->harts) {
+				std::lock_guard<std::mutex> lock(h->intr_mutex);
+				h->intr_cond.notify_one();
+			}
+		}
+
+		/*
+		 * power off request from a device, called from MMIO with io_mutex held.
+		 * other harts stop at their next isr and the calling hart unwinds now
+		 */
+		void poweroff()
+		{
+			boot_hart->poweroff_req = true;
+			wake_harts();
+			P::mmu.mem->io_mutex.unlock();
+			hart().raise(P::internal_cause_poweroff, hart().pc);
 		}
 
 		void exit(int rc)
@@ -405,6 +575,13 @@ core {
 				printf("~~~~~~~~~~~~~~~~~~~\n");
 				print_device_registers();
 
+				/* superpage tlb statistics */
+				printf("\n");
+				printf("superpage tlb statistics\n");
+				printf("~~~~~~~~~~~~~~~~~~~~~~~~\n");
+				printf("%-10s %llu\n", "hits", (unsigned long long)P::mmu.l2_stlb.hits);
+				printf("%-10s %llu\n", "misses", (unsigned long long)P::mmu.l2_stlb.misses);
+
 				/* print program counter histogram */
 				if (P::log & proc_log_hist_pc) {
 					printf("\n");
@@ -474,6 +651,25 @@ core {
 			intr_sleep_time = cpu.get_time_ns();
 		}
 
+		/* save or restore processor, TLB and device state */
+		template <typename S>
+		void snapshot(S &s)
+		{
+			s.section("cpu ");
+			P::snapshot(s);
+			s.io(time_skip);
+			s.section("mmu ");
+			P::mmu.snapshot(s);
+			s.section("dev ");
+			device_rtc->snapshot(s);
+			device_mipi->snapshot(s);
+			device_plic->snapshot(s);
+			device_uart->snapshot(s);
+			device_timer->snapshot(s);
+			device_gpio->snapshot(s);
+			device_htif->snapshot(s);
+		}
+
 		void print_device_registers()
 		{
 			device_rtc->print_registers();
@@ -767,16 +963,29 @@ core {
 					}
 				case rv_op_sfence_vm:
 					if (P::mode >= rv_mode_S) {
-						P::mmu.l1_itlb.flush(P::pdid, P::sptbr >> P::mmu_type::tlb_type::ppn_bits);
-						P::mmu.l1_dtlb.flush(P::pdid, P::sptbr >> P::mmu_type::tlb_type::ppn_bits);
+						if (dec.rs1 == 0) {
+							P::mmu.flush_tlb(*this);
+						} else {
+							P::mmu.flush_tlb(*this, P::ireg[dec.rs1]);
+						}
 						return pc_offset;
 					} else {
 						return -1; /* illegal instruction */
 					}
 				case rv_op_wfi:
 					if (P::mode >= rv_mode_S) {
-						wait_for_interrupt();
-						return pc_offset;
+						/* take interrupts now so they return to the next instruction */
+						auto pc = P::pc;
+						P::pc += pc_offset;
+						if (!skip_idle()) wait_for_interrupt();
+						P::time = clock_time();
+						isr();
+						if (!P::running) {
+							P::raise(P::internal_cause_poweroff, pc);
+						}
+						auto next = P::pc;
+						P::pc = pc;
+						return next - pc;
 					} else {
 						return -1; /* illegal instruction */
 					}
@@ -819,17 +1028,35 @@ core {
 
 		void isr()
 		{
-			/* service all external devices connected to the PLIC */
+			/* stop if another hart has powered off */
+			if (unlikely(boot_hart->poweroff_req)) {
+				P::running = false;
+				return;
+			}
 
-			device_uart->service();
-			device_gpio->service();
+			/*
+			 * service all external devices connected to the PLIC
+			 *
+			 * devices are serviced and external interrupts are routed to
+			 * the boot hart, other harts only take timer and software
+			 * interrupts
+			 */
+			bool boot = (boot_hart == this);
+			bool eip = false, cip = false;
+			if (boot) {
+				std::lock_guard<std::mutex> lock(P::mmu.mem->io_mutex);
+				device_uart->service();
+				device_gpio->service();
+				device_rtc->update_time(P::time);
+				eip = device_plic->irq_pending();
+				cip = console->has_char();
+			}
 
 			/*
 			 * service external interrupts from the PLIC if enabled
 			 */
 
 			/* NOTE: delegation is implicit based on enable bits in this model */
-			bool eip = device_plic->irq_pending();
 			if (eip) {
 				P::mip.r.meip = 1;
 				P::mip.r.seip = 1;
@@ -850,7 +1077,6 @@ core {
 			 */
 
 			/* NOTE: delegation is implicit based on enable bits in this model */
-			device_rtc->update_time(P::time);
 			bool tip = device_timer->timer_pending(P::hart_id, P::time);
 			if (tip) {
 				P::mip.r.mtip = 1;
@@ -872,7 +1098,7 @@ core {
 			 */
 
 			/* NOTE: delegation is implicit based on enable bits in this model */
-			bool sip = device_mipi->ipi_pending(P::hart_id) || console->has_char();
+			bool sip = device_mipi->ipi_pending(P::hart_id) || cip;
 			if (sip) {
 				P::mip.r.msip = 1;
 				P::mip.r.ssip = 1;
@@ -958,6 +1184,8 @@ core {
 			if (terminate) {
 				exit(0);
 				P::running = false;
+				boot_hart->poweroff_req = true;
+				wake_harts();
 				return;
 			}
 
@@ -1021,6 +1249,9 @@ core {
 
 	};
 
+	template <typename P>
+	thread_local processor_privileged<P>* processor_privileged<P>::hart_self = nullptr;
+
 }
 
 #endif
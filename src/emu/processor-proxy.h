@@ -26,6 +26,8 @@ namespace riscv {
 			P::ireg[rv_ireg_a0].r.xu.val = 0;
 		}
 
+		void bind_thread() {}
+
 		void destroy()
 		{
 			/* Unmap memory segments */
@@ -36,6 +38,9 @@ namespace riscv {
 
 		void exit(int rc)
 		{
+			/* flush the instruction trace, destructors don't run */
+			P::trace_close();
+
 			if (P::log & proc_log_exit_log_stats) {
 
 				/* reopen console if necessary */
@@ -59,6 +64,17 @@ namespace riscv {
 				printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
 				P::print_csr_registers();
 
+				/* print trace cache statistics */
+				if (P::log & proc_log_jit_trap) {
+					printf("\n");
+					printf("trace cache statistics\n");
+					printf("~~~~~~~~~~~~~~~~~~~~~~\n");
+					printf("%-16s %llu\n", "bytes", (unsigned long long)P::trace_cache_bytes);
+					printf("%-16s %llu\n", "traces", (unsigned long long)P::trace_cache_traces);
+					printf("%-16s %llu\n", "evictions", (unsigned long long)P::trace_evictions);
+					printf("%-16s %llu\n", "retranslations", (unsigned long long)P::trace_retranslations);
+				}
+
 				/* print program counter histogram */
 				if ((P::log & proc_log_hist_pc) && !(P::log & proc_log_jit_trap)) {
 					printf("\n");
@@ -422,6 +438,8 @@ namespace riscv {
 		}
 
 		void isr() {}
+		u64 clock_time() { return cpu_cycle_clock(); }
+		size_t step_limit(size_t count) { return count; }
 		void debug_enter() {}
 		void debug_leave() {}
 
@@ -19,14 +19,22 @@
 
 namespace riscv {
 
-	/* Simple processor stepper with instruction cache */
+	/* Simple processor stepper with instruction and decoded block caches */
 
+	/* processor running on this thread, so one process can run many machines */
 	struct processor_singleton
 	{
-		static processor_singleton *current;
+		static thread_local processor_singleton *current;
+
+		/* signals on threads without a processor take the default action */
+		static void signal_unowned(int signum)
+		{
+			signal(signum, SIG_DFL);
+			if (signum != SIGSEGV && signum != SIGBUS) raise(signum);
+		}
 	};
 
-	processor_singleton* processor_singleton::current = nullptr;
+	thread_local processor_singleton* processor_singleton::current = nullptr;
 
 	template <typename P>
 	struct processor_runloop : processor_singleton, P
@@ -46,23 +54,50 @@ namespace riscv {
 			typename P::decode_type dec;
 		};
 
+		typedef block_cache<typename P::decode_type> block_cache_type;
+		typedef typename block_cache_type::block_ent block_ent;
+
 		rv_inst_cache_ent inst_cache[inst_cache_size];
+		block_cache_type blocks;
+		typename P::decode_type *block_dec;
+
+		processor_runloop() : cli(std::make_shared<debug_cli<P>>()), inst_cache(), block_dec(nullptr) {}
+		processor_runloop(std::shared_ptr<debug_cli<P>> cli) : cli(cli), inst_cache(), block_dec(nullptr) {}
 
-		processor_runloop() : cli(std::make_shared<debug_cli<P>>()), inst_cache() {}
-		processor_runloop(std::shared_ptr<debug_cli<P>> cli) : cli(cli), inst_cache() {}
+		~processor_runloop()
+		{
+			if (processor_singleton::current == this) {
+				processor_singleton::current = nullptr;
+			}
+		}
 
 		static void signal_handler(int signum, siginfo_t *info, void *)
 		{
+			if (!processor_singleton::current) {
+				processor_singleton::signal_unowned(signum);
+				return;
+			}
 			static_cast<processor_runloop<P>*>
 				(processor_singleton::current)->signal_dispatch(signum, info);
 		}
 
 		static void signal_handler_sev(int signum, siginfo_t *info, void *)
 		{
+			if (!processor_singleton::current) {
+				processor_singleton::signal_unowned(signum);
+				return;
+			}
 			static_cast<processor_runloop<P>*>
 				(processor_singleton::current)->signal_dispatch(signum, info);
 		}
 
+		/* bind this processor to the calling thread */
+		void make_current()
+		{
+			processor_singleton::current = this;
+			P::bind_thread();
+		}
+
 		void signal_dispatch(int signum, siginfo_t *info)
 		{
 			printf("SIGNAL   :%s pc:0x%0llx si_addr:0x%0llx\n",
@@ -109,7 +144,7 @@ namespace riscv {
 			sigaction(SIGINT, &sigaction_handler, nullptr);
 			sigaction(SIGHUP, &sigaction_handler, nullptr);
 			sigaction(SIGUSR1, &sigaction_handler, nullptr);
-			processor_singleton::current = this;
+			make_current();
 
 			/* unblock signals */
 			if (pthread_sigmask(SIG_UNBLOCK, &set, NULL) != 0) {
@@ -142,7 +177,7 @@ namespace riscv {
 					case exit_cause_poweroff:
 						return;
 				}
-				ex = step(count);
+				ex = step(P::step_limit(count));
 				if (P::debugging && ex == exit_cause_continue) {
 					ex = exit_cause_cli;
 				}
@@ -188,21 +223,84 @@ namespace riscv {
 			server->listen("localhost", server_port);
 		}
 
+		block_ent* block_lookup(addr_t host)
+		{
+			if (unlikely(blocks.code_gen != P::mmu.code_gen)) {
+				blocks.code_gen = P::mmu.code_gen;
+				blocks.flush();
+			}
+			block_ent *ent = blocks.lookup(host);
+			if (!ent) {
+				P::mmu.inst_code_page(*this, P::pc, host);
+				ent = blocks.fill(*this, host, P::pc);
+			}
+			return ent->count > 0 ? ent : nullptr;
+		}
+
+		bool step_block(block_ent *ent, typename P::ux inststop)
+		{
+			typename P::ux new_offset;
+			for (size_t i = 0; i < ent->count && P::instret != inststop; i++) {
+#if defined (ENABLE_THREADED_INTERP)
+				/* thread through the block, stopping at opcodes the interpreter does not handle */
+				if (!P::log && P::breakpoint == 0) {
+					i += P::inst_block(ent->inst + i, ent->count - i, block_dec, inststop);
+					if (i == ent->count || P::instret == inststop) break;
+				}
+#endif
+				auto &bi = ent->inst[i];
+				block_dec = &bi.dec;
+				if ((new_offset = P::inst_exec(bi.dec, bi.len)) != typename P::ux(-1)  ||
+					(new_offset = P::inst_priv(bi.dec, bi.len)) != typename P::ux(-1))
+				{
+					if (P::log) {
+						typename P::decode_type dec = bi.dec; /* logging rewrites pseudo ops */
+						P::print_log(dec, bi.inst);
+					}
+					P::pc += new_offset;
+					P::instret++;
+				} else {
+					P::raise(rv_cause_illegal_instruction, P::pc);
+				}
+				if (bi.dec.op == rv_op_fence_i) {
+					blocks.flush();
+				}
+				if (P::pc == P::breakpoint && P::breakpoint != 0) {
+					block_dec = nullptr;
+					return false;
+				}
+			}
+			block_dec = nullptr;
+			return true;
+		}
+
 		exit_cause step(size_t count)
 		{
 			typename P::decode_type dec;
+			block_ent *ent;
+			addr_t host;
 			typename P::ux inststop = P::instret + count;
 			typename P::ux pc_offset, new_offset;
 			inst_t inst = 0, inst_cache_key;
 
+			/* machines may be stepped from any thread */
+			make_current();
+
 			/* interrupt service routine */
-			P::time = cpu_cycle_clock();
+			P::time = P::clock_time();
 			P::isr();
+			if (unlikely(!P::running)) {
+				return exit_cause_poweroff;
+			}
 
 			/* trap return path */
 			int cause;
 			if (unlikely((cause = setjmp(P::env)) > 0)) {
 				cause -= P::internal_cause_offset;
+				if (block_dec) {
+					dec = *block_dec;
+					block_dec = nullptr;
+				}
 				switch(cause) {
 					case P::internal_cause_cli:
 						return exit_cause_cli;
@@ -222,6 +320,13 @@ namespace riscv {
 
 			/* step the processor */
 			while (P::instret != inststop) {
+				/* run decoded blocks, falling back to fetch and decode */
+				if ((host = P::mmu.inst_host(*this, P::pc)) && (ent = block_lookup(host))) {
+					if (!step_block(ent, inststop)) {
+						return exit_cause_cli;
+					}
+					continue;
+				}
 				inst = P::mmu.inst_fetch(*this, P::pc, pc_offset);
 				inst_cache_key = inst % inst_cache_size;
 				if (inst_cache[inst_cache_key].inst == inst) {
@@ -0,0 +1,228 @@
+//
+//  processor-snapshot.h
+//
+
+#ifndef rv_processor_snapshot_h
+#define rv_processor_snapshot_h
+
+namespace riscv {
+
+	/*
+	 * Machine snapshot
+	 *
+	 * Processor, TLB and device state is serialized by snapshot(S &s)
+	 * methods that pass each field to s.io(), so one method both saves
+	 * and restores. Main memory follows as a table of non-zero pages and
+	 * page aligned page data, so restore maps the file copy-on-write
+	 * with one mmap per run of consecutive pages.
+	 *
+	 * file    = header:state:segment[count]:pad:page_data
+	 * header  = magic:version:xlen:count
+	 * segment = mpa:size:npages:page_index[npages]
+	 */
+
+	struct snapshot_header
+	{
+		u32 magic;
+		u32 version;
+		u32 xlen;
+		u32 count;
+	};
+
+	enum : u32 {
+		snapshot_magic = 0x6e737672,   /* "rvsn" */
+		snapshot_version = 1
+	};
+
+	struct snapshot_writer
+	{
+		static const bool reading = false;
+
+		FILE *file;
+
+		snapshot_writer(FILE *file) : file(file) {}
+
+		template <typename T> void io(T &val)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "snapshot of non trivial type");
+			fwrite(&val, sizeof(T), 1, file);
+		}
+
+		void section(const char tag[4])
+		{
+			fwrite(tag, 4, 1, file);
+		}
+	};
+
+	struct snapshot_reader
+	{
+		static const bool reading = true;
+
+		FILE *file;
+		bool ok;
+
+		snapshot_reader(FILE *file) : file(file), ok(true) {}
+
+		template <typename T> void io(T &val)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "snapshot of non trivial type");
+			ok = ok && fread(&val, sizeof(T), 1, file) == 1;
+		}
+
+		void section(const char tag[4])
+		{
+			char buf[4];
+			ok = ok && fread(buf, 4, 1, file) == 1 && memcmp(buf, tag, 4) == 0;
+		}
+	};
+
+	/* page aligned main memory segments are saved, IO segments and ROMs (no uva) are devices */
+	template <typename UX>
+	bool snapshot_segment(memory_segment<UX> *seg)
+	{
+		return (seg->flags & pma_type_main) && seg->uva != 0 && seg->size > 0 &&
+			((seg->uva | seg->size) & (page_size - 1)) == 0;
+	}
+
+	template <typename P>
+	void snapshot_save(P &proc, std::string filename)
+	{
+		FILE *file;
+		if ((file = fopen(filename.c_str(), "w")) == nullptr) {
+			panic("snapshot: unable to open: %s: %s", filename.c_str(), strerror(errno));
+		}
+
+		/* find non-zero pages */
+		std::vector<memory_segment<typename P::ux>*> segs;
+		std::vector<std::vector<u64>> pages;
+		for (auto &seg : proc.mmu.mem->segments) {
+			if (!snapshot_segment(seg.get())) continue;
+			std::vector<u64> index;
+			for (u64 i = 0, n = seg->size >> page_shift; i < n; i++) {
+				const u64 *p = (const u64*)(seg->uva + (i << page_shift));
+				if (std::any_of(p, p + page_size / sizeof(u64), [](u64 w) { return w != 0; })) {
+					index.push_back(i);
+				}
+			}
+			segs.push_back(seg.get());
+			pages.push_back(std::move(index));
+		}
+
+		/* state and page tables, with the accrued flags still held by the host FPU */
+		fenv_getflags(proc.fcsr);
+		snapshot_header hdr = { snapshot_magic, snapshot_version, P::xlen, u32(segs.size()) };
+		fwrite(&hdr, sizeof(hdr), 1, file);
+		snapshot_writer s(file);
+		proc.snapshot(s);
+		s.section("mem ");
+		for (size_t i = 0; i < segs.size(); i++) {
+			u64 mpa = segs[i]->mpa, size = segs[i]->size, npages = pages[i].size();
+			s.io(mpa);
+			s.io(size);
+			s.io(npages);
+			fwrite(pages[i].data(), sizeof(u64), npages, file);
+		}
+
+		/* page data */
+		long pos = ftell(file);
+		for (long pad = round_up(pos, page_size) - pos; pad > 0; pad--) fputc(0, file);
+		for (size_t i = 0; i < segs.size(); i++) {
+			for (auto page : pages[i]) {
+				fwrite((const void*)(segs[i]->uva + (page << page_shift)), page_size, 1, file);
+			}
+		}
+
+		bool ok = !ferror(file);
+		if (fclose(file) != 0 || !ok) {
+			panic("snapshot: unable to write: %s", filename.c_str());
+		}
+	}
+
+	template <typename P>
+	void snapshot_restore(P &proc, std::string filename)
+	{
+		FILE *file;
+		snapshot_header hdr;
+		if ((file = fopen(filename.c_str(), "r")) == nullptr) {
+			panic("snapshot: unable to open: %s: %s", filename.c_str(), strerror(errno));
+		}
+		if (fread(&hdr, sizeof(hdr), 1, file) != 1 || hdr.magic != snapshot_magic ||
+			hdr.version != snapshot_version || hdr.xlen != P::xlen)
+		{
+			panic("snapshot: invalid snapshot: %s", filename.c_str());
+		}
+		snapshot_reader s(file);
+		proc.snapshot(s);
+		s.section("mem ");
+
+		/* page tables, segments must match the current memory map */
+		std::vector<memory_segment<typename P::ux>*> segs;
+		std::vector<std::vector<u64>> pages;
+		for (u32 i = 0; s.ok && i < hdr.count; i++) {
+			u64 mpa, size, npages;
+			s.io(mpa);
+			s.io(size);
+			s.io(npages);
+			if (!s.ok || npages > (size >> page_shift)) break;
+			std::vector<u64> index(npages);
+			s.ok = fread(index.data(), sizeof(u64), npages, file) == npages;
+			/* pages are mapped MAP_FIXED so they must lie within the segment in order */
+			for (size_t j = 0; s.ok && j < npages; j++) {
+				s.ok = index[j] < (size >> page_shift) && (j == 0 || index[j] > index[j - 1]);
+			}
+			auto ent = std::find_if(proc.mmu.mem->segments.begin(), proc.mmu.mem->segments.end(),
+				[&](auto &seg) {
+					return snapshot_segment(seg.get()) && seg->mpa == mpa && seg->size == size;
+				});
+			if (ent == proc.mmu.mem->segments.end()) {
+				panic("snapshot: memory segment 0x%llx-0x%llx not present", mpa, mpa + size);
+			}
+			segs.push_back(ent->get());
+			pages.push_back(std::move(index));
+		}
+		if (!s.ok) {
+			panic("snapshot: invalid snapshot: %s", filename.c_str());
+		}
+
+		/* the page data must be present in the file before anything is mapped */
+		int fd = fileno(file);
+		off_t offset = round_up(ftell(file), page_size);
+		u64 npages = 0;
+		for (auto &index : pages) {
+			npages += index.size();
+		}
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size < offset ||
+			npages > u64(st.st_size - offset) >> page_shift)
+		{
+			panic("snapshot: truncated snapshot: %s", filename.c_str());
+		}
+
+		/* zero each segment and map runs of saved pages copy-on-write */
+		for (size_t i = 0; i < segs.size(); i++) {
+			auto seg = segs[i];
+			int prot = PROT_READ | ((seg->flags & pma_prot_write) ? PROT_WRITE : 0);
+			if (mmap((void*)seg->uva, seg->size, prot,
+				MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) == MAP_FAILED)
+			{
+				panic("snapshot: mmap: %s", strerror(errno));
+			}
+			auto &index = pages[i];
+			for (size_t j = 0; j < index.size(); ) {
+				size_t k = j + 1;
+				while (k < index.size() && index[k] == index[k - 1] + 1) k++;
+				if (mmap((void*)(seg->uva + (index[j] << page_shift)), (k - j) << page_shift,
+					prot, MAP_FIXED | MAP_PRIVATE, fd, offset) == MAP_FAILED)
+				{
+					panic("snapshot: mmap: %s", strerror(errno));
+				}
+				offset += (k - j) << page_shift;
+				j = k;
+			}
+		}
+		fclose(file);
+	}
+
+}
+
+#endif
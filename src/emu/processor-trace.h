@@ -0,0 +1,380 @@
+//
+//  processor-trace.h
+//
+
+#ifndef rv_processor_trace_h
+#define rv_processor_trace_h
+
+namespace riscv {
+
+	/*
+	 * Binary instruction trace
+	 *
+	 * The trace is a file header followed by independently decodable
+	 * blocks of records. Records are delta and varint packed against the
+	 * previous record in the same block, so a sequential instruction with
+	 * one register write typically takes 6 to 10 bytes.
+	 *
+	 * file   = magic:version:xlen:reserved
+	 * block  = magic:size:count:reserved:instret:pc:record[count]
+	 * record = flags:[instret_delta]:[pc_delta]:inst:[rd:value]:[width:[addr_delta]:[value]]
+	 */
+
+	enum trace_flag : u8 {
+		trace_flag_pc =       1<<0,    /* pc is not sequential */
+		trace_flag_ireg =     1<<1,    /* integer register write */
+		trace_flag_freg =     1<<2,    /* floating point register write */
+		trace_flag_load =     1<<3,    /* memory read */
+		trace_flag_store =    1<<4,    /* memory write */
+		trace_flag_noaddr =   1<<5,    /* address base register was overwritten */
+		trace_flag_instret =  1<<6,    /* instret is not sequential */
+	};
+
+	struct trace_record
+	{
+		u64 instret;
+		u64 pc;
+		u64 inst;
+		u8  flags;
+		u8  rd;
+		u8  width;                     /* log2 of memory access size */
+		u64 rd_val;
+		u64 mem_addr;
+		u64 mem_val;
+	};
+
+	struct trace_file_header
+	{
+		u32 magic;
+		u32 version;
+		u32 xlen;
+		u32 reserved;
+	};
+
+	struct trace_block_header
+	{
+		u32 magic;
+		u32 size;
+		u32 count;
+		u32 reserved;
+		u64 instret;
+		u64 pc;
+	};
+
+	struct trace_codec
+	{
+		enum : u32 {
+			file_magic = 0x63727472,       /* "rtrc" */
+			block_magic = 0x6b6c6274,      /* "tblk" */
+			version = 1
+		};
+
+		u64 instret;
+		u64 next_pc;
+		u64 mem_addr;
+
+		void reset(u64 base_instret, u64 base_pc)
+		{
+			instret = base_instret - 1;    /* first record is sequential */
+			next_pc = base_pc;
+			mem_addr = 0;
+		}
+
+		static u8* put_varint(u8 *p, u64 v)
+		{
+			while (v >= 0x80) {
+				*p++ = u8(v) | 0x80;
+				v >>= 7;
+			}
+			*p++ = u8(v);
+			return p;
+		}
+
+		static const u8* get_varint(const u8 *p, const u8 *end, u64 &v)
+		{
+			v = 0;
+			for (int shift = 0; p < end && shift < 64; shift += 7) {
+				u8 b = *p++;
+				v |= u64(b & 0x7f) << shift;
+				if (!(b & 0x80)) return p;
+			}
+			return nullptr;
+		}
+
+		static u64 zigzag(s64 v) { return (u64(v) << 1) ^ u64(v >> 63); }
+		static s64 unzigzag(u64 v) { return s64(v >> 1) ^ -s64(v & 1); }
+
+		/* encode one record, returns the end of the record */
+		u8* encode(u8 *p, const trace_record &rec)
+		{
+			u8 flags = rec.flags & ~(trace_flag_pc | trace_flag_instret);
+			if (rec.pc != next_pc) flags |= trace_flag_pc;
+			if (rec.instret != instret + 1) flags |= trace_flag_instret;
+			*p++ = flags;
+			if (flags & trace_flag_instret) p = put_varint(p, rec.instret - instret);
+			if (flags & trace_flag_pc) p = put_varint(p, zigzag(s64(rec.pc - next_pc)));
+			for (size_t i = 0, len = inst_length(rec.inst); i < len; i++) {
+				*p++ = u8(rec.inst >> (i << 3));
+			}
+			if (flags & (trace_flag_ireg | trace_flag_freg)) {
+				*p++ = rec.rd;
+				p = put_varint(p, rec.rd_val);
+			}
+			if (flags & (trace_flag_load | trace_flag_store)) {
+				*p++ = rec.width;
+				if (!(flags & trace_flag_noaddr)) {
+					p = put_varint(p, zigzag(s64(rec.mem_addr - mem_addr)));
+					mem_addr = rec.mem_addr;
+				}
+				if (flags & trace_flag_store) p = put_varint(p, rec.mem_val);
+			}
+			instret = rec.instret;
+			next_pc = rec.pc + inst_length(rec.inst);
+			return p;
+		}
+
+		/* decode one record, returns nullptr if the record is truncated */
+		const u8* decode(const u8 *p, const u8 *end, trace_record &rec)
+		{
+			u64 v;
+			if (p >= end) return nullptr;
+			rec = trace_record();
+			rec.flags = *p++;
+			rec.instret = instret + 1;
+			if (rec.flags & trace_flag_instret) {
+				if (!(p = get_varint(p, end, v))) return nullptr;
+				rec.instret = instret + v;
+			}
+			rec.pc = next_pc;
+			if (rec.flags & trace_flag_pc) {
+				if (!(p = get_varint(p, end, v))) return nullptr;
+				rec.pc += unzigzag(v);
+			}
+			if (end - p < 2) return nullptr;
+			rec.inst = u64(p[0]) | u64(p[1]) << 8;
+			size_t len = inst_length(rec.inst);
+			if (len < 2 || size_t(end - p) < len) return nullptr;
+			for (size_t i = 2; i < len; i++) {
+				rec.inst |= u64(p[i]) << (i << 3);
+			}
+			p += len;
+			if (rec.flags & (trace_flag_ireg | trace_flag_freg)) {
+				if (p >= end) return nullptr;
+				rec.rd = *p++;
+				if (!(p = get_varint(p, end, rec.rd_val))) return nullptr;
+			}
+			if (rec.flags & (trace_flag_load | trace_flag_store)) {
+				if (p >= end) return nullptr;
+				rec.width = *p++;
+				if (!(rec.flags & trace_flag_noaddr)) {
+					if (!(p = get_varint(p, end, v))) return nullptr;
+					mem_addr = rec.mem_addr = mem_addr + unzigzag(v);
+				}
+				if (rec.flags & trace_flag_store) {
+					if (!(p = get_varint(p, end, rec.mem_val))) return nullptr;
+				}
+			}
+			instret = rec.instret;
+			next_pc = rec.pc + inst_length(rec.inst);
+			return p;
+		}
+	};
+
+	/*
+	 * trace_writer
+	 *
+	 * Records are packed into blocks on the processor thread and full
+	 * blocks are handed to a writer thread through a queue_atomic. Written
+	 * blocks are recycled; when the writer falls behind by block_limit
+	 * blocks the processor waits for it.
+	 */
+
+	struct trace_writer
+	{
+		static const size_t block_size = 1 << 16;
+		static const size_t record_max = 64;
+		static const size_t block_limit = 256;
+
+		struct trace_block
+		{
+			trace_block_header hdr;
+			u8 data[block_size];
+		};
+
+		FILE *file;
+		trace_codec codec;
+		trace_block *block;
+		u8 *ptr;
+		size_t blocks_allocated;
+		queue_atomic<trace_block*> full_queue;
+		queue_atomic<trace_block*> free_queue;
+		std::mutex mutex;
+		std::condition_variable cond;
+		std::atomic<bool> running;
+		std::thread thread;
+
+		trace_writer(std::string filename, u32 xlen) :
+			file(nullptr), block(nullptr), ptr(nullptr), blocks_allocated(0),
+			full_queue(block_limit), free_queue(block_limit), running(true)
+		{
+			if ((file = fopen(filename.c_str(), "w")) == nullptr) {
+				panic("trace_writer: unable to open: %s: %s",
+					filename.c_str(), strerror(errno));
+			}
+			trace_file_header hdr = { trace_codec::file_magic, trace_codec::version, xlen, 0 };
+			fwrite(&hdr, sizeof(hdr), 1, file);
+			thread = std::thread(&trace_writer::mainloop, this);
+		}
+
+		~trace_writer()
+		{
+			close();
+		}
+
+		trace_block* alloc_block()
+		{
+			trace_block *b;
+			while (!(b = free_queue.pop_front())) {
+				if (blocks_allocated < block_limit) {
+					blocks_allocated++;
+					return new trace_block();
+				}
+				std::this_thread::yield();
+			}
+			return b;
+		}
+
+		void submit_block()
+		{
+			if (!block) return;
+			block->hdr.size = u32(ptr - block->data);
+			full_queue.push_back(block);
+			block = nullptr;
+			std::lock_guard<std::mutex> lock(mutex);
+			cond.notify_one();
+		}
+
+		void append(const trace_record &rec)
+		{
+			if (block && ptr + record_max > block->data + block_size) {
+				submit_block();
+			}
+			if (!block) {
+				block = alloc_block();
+				block->hdr = trace_block_header{ trace_codec::block_magic, 0, 0, 0, rec.instret, rec.pc };
+				codec.reset(rec.instret, rec.pc);
+				ptr = block->data;
+			}
+			ptr = codec.encode(ptr, rec);
+			block->hdr.count++;
+		}
+
+		void write_blocks()
+		{
+			trace_block *b;
+			while ((b = full_queue.pop_front())) {
+				fwrite(&b->hdr, sizeof(b->hdr), 1, file);
+				fwrite(b->data, b->hdr.size, 1, file);
+				free_queue.push_back(b);
+			}
+		}
+
+		void mainloop()
+		{
+			sigset_t set;
+			sigfillset(&set);
+			if (pthread_sigmask(SIG_BLOCK, &set, NULL) != 0) {
+				panic("trace_writer: can't set thread signal mask: %s", strerror(errno));
+			}
+			while (running.load(std::memory_order_acquire)) {
+				write_blocks();
+				std::unique_lock<std::mutex> lock(mutex);
+				cond.wait(lock, [&] { return !running.load(std::memory_order_acquire) || !full_queue.empty(); });
+			}
+			write_blocks();
+		}
+
+		void close()
+		{
+			if (!file) return;
+			submit_block();
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				running.store(false, std::memory_order_release);
+				cond.notify_one();
+			}
+			thread.join();
+			fclose(file);
+			file = nullptr;
+			trace_block *b;
+			while ((b = free_queue.pop_front())) delete b;
+		}
+	};
+
+	/*
+	 * trace_reader
+	 */
+
+	struct trace_reader
+	{
+		FILE *file;
+		trace_file_header hdr;
+		trace_block_header block_hdr;
+		trace_codec codec;
+		std::vector<u8> data;
+		const u8 *ptr;
+		u32 remaining;
+
+		trace_reader() : file(nullptr), ptr(nullptr), remaining(0) {}
+
+		~trace_reader()
+		{
+			if (file) fclose(file);
+		}
+
+		bool open(std::string filename)
+		{
+			if ((file = fopen(filename.c_str(), "r")) == nullptr) return false;
+			return fread(&hdr, sizeof(hdr), 1, file) == 1 &&
+				hdr.magic == trace_codec::file_magic && hdr.version == trace_codec::version;
+		}
+
+		bool next_block()
+		{
+			if (fread(&block_hdr, sizeof(block_hdr), 1, file) != 1 ||
+				block_hdr.magic != trace_codec::block_magic ||
+				block_hdr.size > trace_writer::block_size) return false;
+			data.resize(block_hdr.size);
+			if (fread(data.data(), block_hdr.size, 1, file) != 1) return false;
+			codec.reset(block_hdr.instret, block_hdr.pc);
+			ptr = data.data();
+			remaining = block_hdr.count;
+			return true;
+		}
+
+		/* skip blocks that start at or before instret */
+		void seek(u64 instret)
+		{
+			trace_block_header peek;
+			for (;;) {
+				long pos = ftell(file);
+				bool ok = fread(&peek, sizeof(peek), 1, file) == 1;
+				fseek(file, pos, SEEK_SET);
+				if (!ok || peek.instret > instret || !next_block()) return;
+			}
+		}
+
+		bool next(trace_record &rec)
+		{
+			while (remaining == 0) {
+				if (!next_block()) return false;
+			}
+			if (!(ptr = codec.decode(ptr, data.data() + data.size(), rec))) return false;
+			remaining--;
+			return true;
+		}
+	};
+
+}
+
+#endif
@@ -28,7 +28,9 @@ namespace riscv {
 			pteb_bits =   page_shift - 2,
 			ppn_limit =   (1ULL<<ppn_bits)-1,
 			asid_limit =  (1ULL<<asid_bits)-1,
-			vpn_limit =   (1ULL<<vpn_bits)-1
+			vpn_limit =   (1ULL<<vpn_bits)-1,
+			tag_ctx_bits = 4,
+			tag_invalid = UX(-1)
 		};
 
 		static_assert(asid_bits + ppn_bits == 32 || asid_bits + ppn_bits == 64 ||
@@ -43,6 +45,10 @@ namespace riscv {
 		UX      pteb : pteb_bits;      /* PTE Bits */
 		pdid_t  pdid;                  /* Protection Domain Identifier */
 		pma_t   pma;                   /* Physical Memory Attributes copy */
+		u32     gen;                   /* PDID + ASID flush generation */
+		UX      rtag;                  /* Read (ITLB: fetch) Access Tag */
+		UX      wtag;                  /* Write Access Tag */
+		addr_t  uva;                   /* Host address of the translated page */
 
 		tagged_tlb_entry() :
 			ppn(ppn_limit),
@@ -51,16 +57,24 @@ namespace riscv {
 			ptel(0),
 			pteb(0),
 			pdid(0),
-			pma(0) {}
+			pma(0),
+			gen(0),
+			rtag(tag_invalid),
+			wtag(tag_invalid),
+			uva(0) {}
 
-		tagged_tlb_entry(UX pdid, UX asid, UX vpn, UX ptel, UX pteb, UX ppn) :
+		tagged_tlb_entry(UX pdid, UX asid, UX vpn, UX ptel, UX pteb, UX ppn, u32 gen) :
 			ppn(ppn),
 			asid(asid),
 			vpn(vpn),
 			ptel(ptel),
 			pteb(pteb),
 			pdid(pdid),
-			pma(0) {}
+			pma(0),
+			gen(gen),
+			rtag(tag_invalid),
+			wtag(tag_invalid),
+			uva(0) {}
 	};
 
 
@@ -70,6 +84,14 @@ namespace riscv {
 	 * protection domain and address space tagged direct mapped tlb
 	 *
 	 * tlb[PDID:ASID:VPN] = PPN:PTE.bits:PMA
+	 *
+	 * PDID and ASID flushes are O(1): each entry records the sum of the
+	 * PDID and ASID bucket generations at insert time and is only valid
+	 * while it matches. Generations only increase so a flushed entry can
+	 * never become valid again (buckets are shared so flushes are
+	 * conservative). VA flushes invalidate one slot unless the VA lies in
+	 * the range spanned by superpage entries, which are replicated across
+	 * slots, in which case the PDID is flushed.
 	 */
 
 	template <const size_t tlb_size, typename PARAM>
@@ -86,38 +108,141 @@ namespace riscv {
 			mask = (1ULL << shift) - 1,
 			key_size = sizeof(tlb_entry_t),
 			asid_bits = PARAM::asid_bits,
-			ppn_bits = PARAM::ppn_bits
+			ppn_bits = PARAM::ppn_bits,
+			pdid_gen_size = 16,
+			asid_gen_size = 256
 		};
 
 		// TODO - map TLB to machine address space with user_memory::add_segment
 
 		tlb_entry_t tlb[size];
+		u32 pdid_gen[pdid_gen_size];   /* PDID bucket flush generations */
+		u32 asid_gen[asid_gen_size];   /* ASID bucket flush generations */
+		UX sp_base;                    /* VA range spanned by superpage entries */
+		UX sp_mask;                    /* (sp_base is 1 when there are none) */
+		pdid_t sp_pdid;                /* PDID of the superpage entries (-1 if mixed) */
 
-		tagged_tlb() : tlb() {}
+		tagged_tlb() : tlb(), pdid_gen(), asid_gen(), sp_base(1), sp_mask(0), sp_pdid(0) {}
 
-		void flush(UX pdid)
+		u32 gen(UX pdid, UX asid)
+		{
+			return pdid_gen[pdid & (pdid_gen_size - 1)] + asid_gen[asid & (asid_gen_size - 1)];
+		}
+
+		void bump(u32 &g)
+		{
+			/* reset everything on wrap so stale generations can not match */
+			if (unlikely(++g == 0)) reset();
+		}
+
+		void reset()
 		{
 			for (size_t i = 0; i < size; i++) {
-				if (tlb[i].pdid != pdid) continue;
 				tlb[i] = tlb_entry_t();
 			}
+			memset(pdid_gen, 0, sizeof(pdid_gen));
+			memset(asid_gen, 0, sizeof(asid_gen));
+			sp_base = 1;
+			sp_mask = 0;
+		}
+
+		// flush all entries for the given PDID
+		void flush(UX pdid)
+		{
+			bump(pdid_gen[pdid & (pdid_gen_size - 1)]);
+			if (sp_pdid == pdid) {
+				sp_base = 1;
+				sp_mask = 0;
+			}
 		}
 
+		// flush all entries for the given PDID + ASID (ASID 0 flushes the PDID)
 		void flush(UX pdid, UX asid)
 		{
-			for (size_t i = 0; i < size; i++) {
-				if (asid != 0 && tlb[i].pdid != pdid && tlb[i].asid != asid) continue;
+			if (asid == 0) {
+				flush(pdid);
+			} else {
+				bump(asid_gen[asid & (asid_gen_size - 1)]);
+			}
+		}
+
+		// flush the entry for the given PDID + ASID + VA
+		void flush(UX pdid, UX asid, UX va)
+		{
+			if ((va & sp_mask) == sp_base) {
+				flush(pdid);
+				return;
+			}
+			UX vpn = va >> page_shift;
+			size_t i = vpn & mask;
+			if (tlb[i].pdid == pdid && tlb[i].vpn == vpn &&
+				(asid == 0 || tlb[i].asid == asid)) {
 				tlb[i] = tlb_entry_t();
 			}
 		}
 
+		// record a superpage mapping so that VA flushes within it flush the PDID
+		void add_superpage(UX pdid, UX va, UX shift)
+		{
+			UX sp_va_mask = ~((UX(1) << shift) - 1);
+			if (sp_base & 1) {
+				sp_base = va & sp_va_mask;
+				sp_mask = sp_va_mask;
+				sp_pdid = pdid;
+				return;
+			}
+			if (sp_pdid != pdid) sp_pdid = pdid_t(-1);
+			/* widen the range to cover both mappings */
+			sp_mask &= sp_va_mask;
+			while ((sp_base ^ va) & sp_mask) {
+				sp_mask <<= 1;
+			}
+			sp_base &= sp_mask;
+		}
+
 		// lookup TLB entry for the given PDID + ASID + X:12[VA] + 11:0[PTE.bits] -> PPN]
 		tlb_entry_t* lookup(UX pdid, UX asid, UX va)
 		{
 			UX vpn = va >> page_shift;
 			size_t i = vpn & mask;
-			return tlb[i].pdid == pdid && tlb[i].asid == asid && tlb[i].vpn == vpn ?
-				tlb + i : nullptr;
+			return tlb[i].pdid == pdid && tlb[i].asid == asid && tlb[i].vpn == vpn &&
+				tlb[i].gen == gen(pdid, asid) ? tlb + i : nullptr;
+		}
+
+		// access tag for VPN + privilege context (mode, PUM, MXR)
+		static constexpr UX access_tag(UX va, UX ctx)
+		{
+			return ((va >> page_shift) << tlb_entry_t::tag_ctx_bits) | ctx;
+		}
+
+		// lookup host address for the given PDID + ASID + VA + privilege context
+		// (the access tags are only set once permission and A/D checks have passed)
+		addr_t lookup_host(UX pdid, UX asid, UX va, UX ctx, bool write)
+		{
+			UX vpn = va >> page_shift;
+			size_t i = vpn & mask;
+			UX tag = access_tag(va, ctx);
+			return (write ? tlb[i].wtag : tlb[i].rtag) == tag &&
+				tlb[i].asid == asid && tlb[i].pdid == pdid &&
+				tlb[i].gen == gen(pdid, asid) ?
+				tlb[i].uva + (va & ~page_mask) : 0;
+		}
+
+		// drop the write access tags for a host page so stores take the slow path
+		void clear_wtag(addr_t uva)
+		{
+			for (size_t i = 0; i < size; i++) {
+				if (tlb[i].uva == uva) tlb[i].wtag = tlb_entry_t::tag_invalid;
+			}
+		}
+
+		// drop all host addresses and access tags so lookups take the slow path
+		void clear_host()
+		{
+			for (size_t i = 0; i < size; i++) {
+				tlb[i].rtag = tlb[i].wtag = tlb_entry_t::tag_invalid;
+				tlb[i].uva = 0;
+			}
 		}
 
 		// insert TLB entry for the given PDID + ASID + X:12[VA] + 11:0[PTE.bits] <- PPN]
@@ -126,7 +251,7 @@ namespace riscv {
 			UX vpn = va >> page_shift;
 			size_t i = vpn & mask;
 			// we are implicitly evicting an entry by overwriting it
-			tlb[i] = tlb_entry_t(pdid, asid, vpn, ptel, pteb, ppn);
+			tlb[i] = tlb_entry_t(pdid, asid, vpn, ptel, pteb, ppn, gen(pdid, asid));
 			return &tlb[i];
 		}
 	};
@@ -134,6 +259,127 @@ namespace riscv {
 	template <const size_t tlb_size> using tagged_tlb_rv32 = tagged_tlb<tlb_size,param_rv32>;
 	template <const size_t tlb_size> using tagged_tlb_rv64 = tagged_tlb<tlb_size,param_rv64>;
 
+
+	/*
+	 * superpage_tlb_entry
+	 *
+	 * protection domain and address space tagged megapage or gigapage mapping
+	 *
+	 * stlb[PDID:ASID:VA>>shift] = PPN:PTE.level:PTE.bits
+	 */
+
+	template <typename PARAM>
+	struct superpage_tlb_entry
+	{
+		typedef typename PARAM::UX UX;
+
+		UX      vpn;                   /* Virtual Page Number (VA >> shift) */
+		UX      ppn;                   /* Physical Page Number (superpage base) */
+		UX      asid;                  /* Address Space Identifier */
+		pdid_t  pdid;                  /* Protection Domain Identifier */
+		u8      shift;                 /* Superpage shift (0 = invalid entry) */
+		u8      ptel;                  /* PTE Level */
+		u16     pteb;                  /* PTE Bits */
+
+		superpage_tlb_entry() :
+			vpn(0), ppn(0), asid(0), pdid(0), shift(0), ptel(0), pteb(0) {}
+
+		superpage_tlb_entry(UX pdid, UX asid, UX vpn, UX shift, UX ptel, UX pteb, UX ppn) :
+			vpn(vpn), ppn(ppn), asid(asid), pdid(pdid), shift(shift), ptel(ptel), pteb(pteb) {}
+	};
+
+
+	/*
+	 * superpage_tlb
+	 *
+	 * protection domain and address space tagged fully associative tlb
+	 * holding level 1 and level 2 leaf PTEs (megapages and gigapages).
+	 * consulted on a 4 KiB tlb miss before walking the page table.
+	 *
+	 * stlb[PDID:ASID:VA>>shift] = PPN:PTE.level:PTE.bits
+	 */
+
+	template <const size_t tlb_size, typename PARAM>
+	struct superpage_tlb
+	{
+		static_assert(tlb_size > 0 && tlb_size <= 64, "tlb_size must be between 1 and 64");
+
+		typedef typename PARAM::UX UX;
+		typedef superpage_tlb_entry<PARAM> tlb_entry_t;
+
+		enum : UX {
+			size = tlb_size
+		};
+
+		tlb_entry_t tlb[size];
+		size_t next;                   /* round robin replacement index */
+		u64 hits;                      /* lookup statistics */
+		u64 misses;
+
+		superpage_tlb() : tlb(), next(0), hits(0), misses(0) {}
+
+		void flush(UX pdid)
+		{
+			for (size_t i = 0; i < size; i++) {
+				if (tlb[i].pdid != pdid) continue;
+				tlb[i] = tlb_entry_t();
+			}
+		}
+
+		void flush(UX pdid, UX asid)
+		{
+			for (size_t i = 0; i < size; i++) {
+				if (tlb[i].pdid != pdid || (asid != 0 && tlb[i].asid != asid)) continue;
+				tlb[i] = tlb_entry_t();
+			}
+		}
+
+		void flush(UX pdid, UX asid, UX va)
+		{
+			for (size_t i = 0; i < size; i++) {
+				if (tlb[i].pdid != pdid || (asid != 0 && tlb[i].asid != asid) ||
+					!tlb[i].shift || (va >> tlb[i].shift) != tlb[i].vpn) continue;
+				tlb[i] = tlb_entry_t();
+			}
+		}
+
+		// lookup superpage entry for the given PDID + ASID + VA
+		tlb_entry_t* lookup(UX pdid, UX asid, UX va)
+		{
+			for (size_t i = 0; i < size; i++) {
+				tlb_entry_t &ent = tlb[i];
+				if (ent.shift && ent.pdid == pdid && ent.asid == asid &&
+					(va >> ent.shift) == ent.vpn)
+				{
+					hits++;
+					return &ent;
+				}
+			}
+			misses++;
+			return nullptr;
+		}
+
+		// insert superpage entry, replacing any entry for the same superpage
+		tlb_entry_t* insert(UX pdid, UX asid, UX va, UX shift, UX ptel, UX pteb, UX ppn)
+		{
+			UX vpn = va >> shift;
+			size_t i;
+			for (i = 0; i < size; i++) {
+				if (tlb[i].shift == shift && tlb[i].pdid == pdid &&
+					tlb[i].asid == asid && tlb[i].vpn == vpn) break;
+			}
+			if (i == size) {
+				i = next;
+				next = (next + 1) % size;
+			}
+			tlb[i] = tlb_entry_t(pdid, asid, vpn, shift, ptel, pteb, ppn);
+			return &tlb[i];
+		}
+	};
+
+	template <const size_t tlb_size> using superpage_tlb_rv32 = superpage_tlb<tlb_size,param_rv32>;
+	template <const size_t tlb_size> using superpage_tlb_rv64 = superpage_tlb<tlb_size,param_rv64>;
+
 }
 
 #endif
@@ -94,6 +94,15 @@ namespace riscv {
 		sw_fn sw;
 		sd_fn sd;
 	};
+
+	/* processor settings read by the emitter, copied when a trace is
+	 * queued so the JIT thread never reads the processor */
+	struct jit_options
+	{
+		u32  log;
+		bool update_instret;
+		bool memory_registers;
+	};
 }
 
 #endif
@@ -78,6 +78,76 @@ namespace riscv {
 				rv_op_sh,
 				rv_op_sb,
 				rv_op_lui,
+				rv_op_lr_w,
+				rv_op_lr_d,
+				rv_op_sc_w,
+				rv_op_sc_d,
+				rv_op_amoswap_w,
+				rv_op_amoadd_w,
+				rv_op_amoxor_w,
+				rv_op_amoor_w,
+				rv_op_amoand_w,
+				rv_op_amomin_w,
+				rv_op_amomax_w,
+				rv_op_amominu_w,
+				rv_op_amomaxu_w,
+				rv_op_amoswap_d,
+				rv_op_amoadd_d,
+				rv_op_amoxor_d,
+				rv_op_amoor_d,
+				rv_op_amoand_d,
+				rv_op_amomin_d,
+				rv_op_amomax_d,
+				rv_op_amominu_d,
+				rv_op_amomaxu_d,
+				rv_op_fld,
+				rv_op_flw,
+				rv_op_fsd,
+				rv_op_fsw,
+				rv_op_fadd_d,
+				rv_op_fsub_d,
+				rv_op_fmul_d,
+				rv_op_fdiv_d,
+				rv_op_fsqrt_d,
+				rv_op_fadd_s,
+				rv_op_fsub_s,
+				rv_op_fmul_s,
+				rv_op_fdiv_s,
+				rv_op_fsqrt_s,
+				rv_op_fmadd_d,
+				rv_op_fmsub_d,
+				rv_op_fnmsub_d,
+				rv_op_fnmadd_d,
+				rv_op_fmadd_s,
+				rv_op_fmsub_s,
+				rv_op_fnmsub_s,
+				rv_op_fnmadd_s,
+				rv_op_fsgnj_d,
+				rv_op_fsgnjn_d,
+				rv_op_fsgnjx_d,
+				rv_op_fsgnj_s,
+				rv_op_fsgnjn_s,
+				rv_op_fsgnjx_s,
+				rv_op_feq_d,
+				rv_op_flt_d,
+				rv_op_fle_d,
+				rv_op_feq_s,
+				rv_op_flt_s,
+				rv_op_fle_s,
+				rv_op_fcvt_w_d,
+				rv_op_fcvt_l_d,
+				rv_op_fcvt_w_s,
+				rv_op_fcvt_l_s,
+				rv_op_fcvt_d_w,
+				rv_op_fcvt_d_wu,
+				rv_op_fcvt_d_l,
+				rv_op_fcvt_s_w,
+				rv_op_fcvt_s_wu,
+				rv_op_fcvt_s_l,
+				rv_op_fcvt_s_d,
+				rv_op_fcvt_d_s,
+				rv_op_fmv_d_x,
+				rv_op_fmv_s_x,
 				rv_op_jal,
 				rv_op_jalr,
 				jit_op_la,
@@ -105,32 +175,40 @@ namespace riscv {
 
 		#define proc_offset(member) offsetof(typename P::processor_type, member)
 
-		P &proc;
+		jit_options opts;
 		X86Assembler as;
 		CodeHolder &code;
 		mmu_ops ops, ops_wrap;
 		TraceLookup lookup_trace_slow;
 		TraceLookup lookup_trace_fast;
+		TraceLookup lookup_trace_ic;
 		std::map<addr_t,Label> labels;
 		std::map<addr_t,Label> jmp_tramp_labels;
 		std::map<addr_t,Label> exit_tramp_labels;
 		std::map<addr_t,std::vector<Label>> jmp_fixup_labels;
+		std::vector<Label> jmp_cache_labels;
 		std::vector<addr_t> callstack;
 		u64 term_pc;
 		int instret;
 		bool use_mmu;
 		Label start, term;
+		int regmap[P::ireg_count];
+		u32 reg_load, reg_dirty;
 
-		jit_emitter_rv64(P &proc, CodeHolder &code, mmu_ops &ops, TraceLookup lookup_trace_slow, TraceLookup lookup_trace_fast)
-			: proc(proc), as(&code), code(code), ops(ops),
+		jit_emitter_rv64(jit_options opts, CodeHolder &code, mmu_ops &ops, TraceLookup lookup_trace_slow,
+			TraceLookup lookup_trace_fast, TraceLookup lookup_trace_ic)
+			: opts(opts), as(&code), code(code), ops(ops),
 			  lookup_trace_slow(lookup_trace_slow),
 			  lookup_trace_fast(lookup_trace_fast),
+			  lookup_trace_ic(lookup_trace_ic),
 			  term_pc(0), instret(0), use_mmu(false)
-		{}
+		{
+			set_regmap(fixed_regmap(), ~0U, ~0U);
+		}
 
 		void log_trace(const char* fmt, ...)
 		{
-			if (proc.log & proc_log_jit_trace) {
+			if (opts.log & proc_log_jit_trace) {
 				char buf[128];
 				va_list arg;
 				va_start(arg, fmt);
@@ -145,27 +223,82 @@ namespace riscv {
 			return false;
 		}
 
+		/* host registers available to the register allocator */
+		enum { host_reg_count = 12 };
+
+		static const int* host_regs()
+		{
+			static const int regs[host_reg_count] = {
+				2,  /* rdx */
+				3,  /* rbx */
+				6,  /* rsi */
+				7,  /* rdi */
+				8,  /* r8  */
+				9,  /* r9  */
+				10, /* r10 */
+				11, /* r11 */
+				12, /* r12 */
+				13, /* r13 */
+				14, /* r14 */
+				15  /* r15 */
+			};
+			return regs;
+		}
+
+		/* register mapping for traces without an allocation (audit) */
+		static const int* fixed_regmap()
+		{
+			/* built once by the static initializer, emitters on other threads only read it */
+			static const struct fixed_map {
+				int map[P::ireg_count];
+				fixed_map() {
+					static const int fixed[] = {
+						rv_ireg_ra, rv_ireg_sp, rv_ireg_t0, rv_ireg_t1,
+						rv_ireg_a0, rv_ireg_a1, rv_ireg_a2, rv_ireg_a3,
+						rv_ireg_a4, rv_ireg_a5, rv_ireg_a6, rv_ireg_a7
+					};
+					for (size_t r = 0; r < P::ireg_count; r++) map[r] = -1;
+					map[rv_ireg_zero] = 0;
+					for (size_t i = 0; i < host_reg_count; i++) map[fixed[i]] = host_regs()[i];
+				}
+			} table;
+			return table.map;
+		}
+
+		/* install the trace register allocation, loaded on entry and spilled on exit */
+		void set_regmap(const int *map, u32 load, u32 dirty)
+		{
+			for (size_t r = 0; r < P::ireg_count; r++) regmap[r] = map[r];
+			reg_load = load;
+			reg_dirty = dirty;
+		}
+
 		int x86_reg(int rd)
 		{
-			if (proc.memory_registers) {
+			if (opts.memory_registers) {
 				return -1; /* all registers are memory backed */
 			}
-			switch (rd) {
-				case rv_ireg_zero: return 0;
-				case rv_ireg_ra: return 2;  /* rdx */
-				case rv_ireg_sp: return 3;  /* rbx */
-				case rv_ireg_t0: return 6;  /* rsi */
-				case rv_ireg_t1: return 7;  /* rdi */
-				case rv_ireg_a0: return 8;  /* r8  */
-				case rv_ireg_a1: return 9;  /* r9  */
-				case rv_ireg_a2: return 10; /* r10 */
-				case rv_ireg_a3: return 11; /* r11 */
-				case rv_ireg_a4: return 12; /* r12 */
-				case rv_ireg_a5: return 13; /* r13 */
-				case rv_ireg_a6: return 14; /* r14 */
-				case rv_ireg_a7: return 15; /* r15 */
+			return regmap[rd];
+		}
+
+		void emit_reg_load()
+		{
+			for (size_t r = 1; r < P::ireg_count; r++) {
+				int rx = x86_reg(r);
+				if (rx > 0 && (reg_load & (1U << r))) {
+					as.mov(x86::gpq(rx), rbp_reg_q(r));
+				}
+			}
+		}
+
+		void emit_reg_spill()
+		{
+			for (size_t r = 1; r < P::ireg_count; r++) {
+				int rx = x86_reg(r);
+				if (rx > 0 && (reg_dirty & (1U << r))) {
+					as.mov(rbp_reg_q(r), x86::gpq(rx));
+				}
 			}
-			return -1;
 		}
 
 		const char* rbp_reg_str_d(int reg)
@@ -194,7 +327,7 @@ namespace riscv {
 
 		void commit_instret()
 		{
-			if (proc.update_instret && instret > 0) {
+			if (opts.update_instret && instret > 0) {
 				as.add(x86::qword_ptr(x86::rbp, proc_offset(instret)), Imm(instret));
 				instret = 0;
 			}
@@ -202,7 +335,7 @@ namespace riscv {
 
 		void emit_prolog()
 		{
-			if (!proc.memory_registers) {
+			if (!opts.memory_registers) {
 				as.push(x86::r12);
 				as.push(x86::r13);
 				as.push(x86::r14);
@@ -211,20 +344,6 @@ namespace riscv {
 			}
 			as.push(x86::rbp);
 			as.mov(x86::rbp, x86::rdi);
-			if (!proc.memory_registers) {
-				as.mov(x86::rdx, rbp_reg_q(rv_ireg_ra));
-				as.mov(x86::rbx, rbp_reg_q(rv_ireg_sp));
-				as.mov(x86::rsi, rbp_reg_q(rv_ireg_t0));
-				as.mov(x86::rdi, rbp_reg_q(rv_ireg_t1));
-				as.mov(x86::r8,  rbp_reg_q(rv_ireg_a0));
-				as.mov(x86::r9,  rbp_reg_q(rv_ireg_a1));
-				as.mov(x86::r10, rbp_reg_q(rv_ireg_a2));
-				as.mov(x86::r11, rbp_reg_q(rv_ireg_a3));
-				as.mov(x86::r12, rbp_reg_q(rv_ireg_a4));
-				as.mov(x86::r13, rbp_reg_q(rv_ireg_a5));
-				as.mov(x86::r14, rbp_reg_q(rv_ireg_a6));
-				as.mov(x86::r15, rbp_reg_q(rv_ireg_a7));
-			}
 
 			instret = 0;
 		}
@@ -232,23 +351,9 @@ namespace riscv {
 		void emit_epilog()
 		{
 			commit_instret();
-
-			if (!proc.memory_registers) {
-				as.mov(rbp_reg_q(rv_ireg_ra), x86::rdx);
-				as.mov(rbp_reg_q(rv_ireg_sp), x86::rbx);
-				as.mov(rbp_reg_q(rv_ireg_t0), x86::rsi);
-				as.mov(rbp_reg_q(rv_ireg_t1), x86::rdi);
-				as.mov(rbp_reg_q(rv_ireg_a0), x86::r8);
-				as.mov(rbp_reg_q(rv_ireg_a1), x86::r9);
-				as.mov(rbp_reg_q(rv_ireg_a2), x86::r10);
-				as.mov(rbp_reg_q(rv_ireg_a3), x86::r11);
-				as.mov(rbp_reg_q(rv_ireg_a4), x86::r12);
-				as.mov(rbp_reg_q(rv_ireg_a5), x86::r13);
-				as.mov(rbp_reg_q(rv_ireg_a6), x86::r14);
-				as.mov(rbp_reg_q(rv_ireg_a7), x86::r15);
-			}
+			emit_reg_spill();
 			as.pop(x86::rbp);
-			if (!proc.memory_registers) {
+			if (!opts.memory_registers) {
 				as.pop(x86::rbx);
 				as.pop(x86::r15);
 				as.pop(x86::r14);
@@ -257,9 +362,19 @@ namespace riscv {
 			}
 			as.ret();
 
+			/*
+			 * jump trampolines spill the trace registers then jump to the
+			 * trace lookup. The rel32 jump at the fixup label is linked to
+			 * the target trace entry once it is translated.
+			 */
 			for (auto &jtl : jmp_tramp_labels) {
 				as.align(kAlignCode, 16);
 				as.bind(jtl.second);
+				emit_reg_spill();
+				Label fixup = as.newLabel();
+				as.jmp(fixup);
+				as.bind(fixup);
+				create_jump_fixup(jtl.first)->second.push_back(fixup);
 				emit_pc(jtl.first);
 				as.jmp(Imm(func_address(lookup_trace_fast)));
 			}
@@ -270,16 +385,28 @@ namespace riscv {
 				emit_pc(jtl.first);
 				as.jmp(term);
 			}
+
+			/* indirect jump target caches {pc, fn} (pc -1 never matches) */
+			static const u64 jmp_cache_init[2] = { u64(-1), 0 };
+			for (auto &label : jmp_cache_labels) {
+				as.align(kAlignData, 8);
+				as.bind(label);
+				as.embed(jmp_cache_init, sizeof(jmp_cache_init));
+			}
 		}
 
 		TraceLookup create_trace_lookup(JitRuntime &rt)
 		{
+			auto lookup_fast = as.newLabel();
 			auto lookup_slow = as.newLabel();
 			auto lookup_fail = as.newLabel();
+			auto lookup_ic = as.newLabel();
+			auto lookup_ic_miss = as.newLabel();
 
 			u32 mask = (P::trace_l1_size - 1) << 1;
 
 			/* fast path lookup cache pc -> trace fn */
+			as.bind(lookup_fast);
 			as.mov(x86::rcx, x86::qword_ptr(x86::rbp, proc_offset(pc)));
 			as.mov(x86::rax, x86::rcx);
 			as.and_(x86::rcx, Imm(mask));
@@ -289,16 +416,6 @@ namespace riscv {
 
 			/* slow path lookup cache pc -> trace fn */
 			as.bind(lookup_slow);
-			if (!proc.memory_registers) {
-				as.mov(rbp_reg_q(rv_ireg_ra), x86::rdx);
-				as.mov(rbp_reg_q(rv_ireg_sp), x86::rbx);
-				as.mov(rbp_reg_q(rv_ireg_t0), x86::rsi);
-				as.mov(rbp_reg_q(rv_ireg_t1), x86::rdi);
-				as.mov(rbp_reg_q(rv_ireg_a0), x86::r8);
-				as.mov(rbp_reg_q(rv_ireg_a1), x86::r9);
-				as.mov(rbp_reg_q(rv_ireg_a2), x86::r10);
-				as.mov(rbp_reg_q(rv_ireg_a3), x86::r11);
-			}
 			as.mov(x86::rdi, x86::rax);
 			as.call(Imm(func_address(lookup_trace_slow)));
 			as.test(x86::rax, x86::rax);
@@ -308,28 +425,12 @@ namespace riscv {
 			as.and_(x86::rcx, Imm(mask));
 			as.mov(x86::qword_ptr(x86::rbp, x86::rcx, 4, proc_offset(trace_fn)), x86::rax);
 			as.mov(x86::qword_ptr(x86::rbp, x86::rcx, 4, proc_offset(trace_pc)), x86::rdx);
-			if (!proc.memory_registers) {
-				as.mov(x86::rdx, rbp_reg_q(rv_ireg_ra));
-				as.mov(x86::rbx, rbp_reg_q(rv_ireg_sp));
-				as.mov(x86::rsi, rbp_reg_q(rv_ireg_t0));
-				as.mov(x86::rdi, rbp_reg_q(rv_ireg_t1));
-				as.mov(x86::r8,  rbp_reg_q(rv_ireg_a0));
-				as.mov(x86::r9,  rbp_reg_q(rv_ireg_a1));
-				as.mov(x86::r10, rbp_reg_q(rv_ireg_a2));
-				as.mov(x86::r11, rbp_reg_q(rv_ireg_a3));
-			}
 			as.jmp(x86::rax);
 
 			/* fail path, return to emulator */
 			as.bind(lookup_fail);
-			if (!proc.memory_registers) {
-				as.mov(rbp_reg_q(rv_ireg_a4), x86::r12);
-				as.mov(rbp_reg_q(rv_ireg_a5), x86::r13);
-				as.mov(rbp_reg_q(rv_ireg_a6), x86::r14);
-				as.mov(rbp_reg_q(rv_ireg_a7), x86::r15);
-			}
 			as.pop(x86::rbp);
-			if (!proc.memory_registers) {
+			if (!opts.memory_registers) {
 				as.pop(x86::rbx);
 				as.pop(x86::r15);
 				as.pop(x86::r14);
@@ -338,33 +439,55 @@ namespace riscv {
 			}
 			as.ret();
 
+			/* indirect jump target cache refill, rax = jump site cache {pc, fn} */
+			as.bind(lookup_ic);
+			as.push(x86::rdx);
+			as.mov(x86::rdx, x86::qword_ptr(x86::rbp, proc_offset(pc)));
+			as.mov(x86::rcx, x86::rdx);
+			as.and_(x86::rcx, Imm(mask));
+			as.cmp(x86::rdx, x86::qword_ptr(x86::rbp, x86::rcx, 4, proc_offset(trace_pc)));
+			as.jne(lookup_ic_miss);
+			as.mov(x86::rcx, x86::qword_ptr(x86::rbp, x86::rcx, 4, proc_offset(trace_fn)));
+			as.mov(x86::qword_ptr(x86::rax, 8), x86::rcx);
+			as.mov(x86::qword_ptr(x86::rax), x86::rdx);
+			as.pop(x86::rdx);
+			as.jmp(x86::rcx);
+			as.bind(lookup_ic_miss);
+			as.pop(x86::rdx);
+			as.jmp(lookup_fast);
+
 			Error err = rt.add(&lookup_trace_fast, &code);
 			if (err) panic("failed to create trace lookup function");
+			lookup_trace_ic = func_address_offset<TraceLookup>(lookup_trace_fast,
+				code.getLabelOffset(lookup_ic));
 			return lookup_trace_fast;
 		}
 
 		void save_volatile()
 		{
-			if (proc.memory_registers) return;
-			as.mov(rbp_reg_q(rv_ireg_ra), x86::rdx);
-			as.mov(rbp_reg_q(rv_ireg_t0), x86::rsi);
-			as.mov(rbp_reg_q(rv_ireg_t1), x86::rdi);
-			as.mov(rbp_reg_q(rv_ireg_a0), x86::r8);
-			as.mov(rbp_reg_q(rv_ireg_a1), x86::r9);
-			as.mov(rbp_reg_q(rv_ireg_a2), x86::r10);
-			as.mov(rbp_reg_q(rv_ireg_a3), x86::r11);
+			/* caller saved host registers, padded to keep the stack aligned */
+			if (opts.memory_registers) return;
+			as.push(x86::rdx);
+			as.push(x86::rsi);
+			as.push(x86::rdi);
+			as.push(x86::r8);
+			as.push(x86::r9);
+			as.push(x86::r10);
+			as.push(x86::r11);
+			as.sub(x86::rsp, Imm(8));
 		}
 
 		void restore_volatile()
 		{
-			if (proc.memory_registers) return;
-			as.mov(x86::rdx, rbp_reg_q(rv_ireg_ra));
-			as.mov(x86::rsi, rbp_reg_q(rv_ireg_t0));
-			as.mov(x86::rdi, rbp_reg_q(rv_ireg_t1));
-			as.mov(x86::r8, rbp_reg_q(rv_ireg_a0));
-			as.mov(x86::r9, rbp_reg_q(rv_ireg_a1));
-			as.mov(x86::r10, rbp_reg_q(rv_ireg_a2));
-			as.mov(x86::r11, rbp_reg_q(rv_ireg_a3));
+			if (opts.memory_registers) return;
+			as.add(x86::rsp, Imm(8));
+			as.pop(x86::r11);
+			as.pop(x86::r10);
+			as.pop(x86::r9);
+			as.pop(x86::r8);
+			as.pop(x86::rdi);
+			as.pop(x86::rsi);
+			as.pop(x86::rdx);
 		}
 
 		mmu_ops create_load_store(JitRuntime &rt)
@@ -468,6 +591,7 @@ namespace riscv {
 			term = as.newLabel();
 			start = as.newLabel();
 			as.bind(start);
+			emit_reg_load();
 		}
 
 		void end()
@@ -489,6 +613,20 @@ namespace riscv {
 			}
 		}
 
+		/* indirect jump via a per-site target cache, refilled from the trace lookup */
+		void emit_jmp_indirect()
+		{
+			Label cache = as.newLabel(), miss = as.newLabel();
+			jmp_cache_labels.push_back(cache);
+			as.mov(x86::rax, x86::qword_ptr(x86::rbp, proc_offset(pc)));
+			as.cmp(x86::rax, x86::qword_ptr(cache));
+			as.jne(miss);
+			as.jmp(x86::qword_ptr(cache, 8));
+			as.bind(miss);
+			as.lea(x86::rax, x86::ptr(cache));
+			as.jmp(Imm(func_address(lookup_trace_ic)));
+		}
+
 		void emit_sx_32_rd(decode_type &dec)
 		{
 			int rdx = x86_reg(dec.rd);
@@ -864,8 +1002,8 @@ namespace riscv {
 				emit_zero_rd(dec);
 			}
 			else {
-				if (!proc.memory_registers && rdx != 2 /* x86::rdx */) {
-					as.mov(x86::qword_ptr(x86::rbp, proc_offset(ireg[rv_ireg_ra])), x86::rdx);
+				if (!opts.memory_registers && rdx != 2 /* x86::rdx */) {
+					as.mov(x86::qword_ptr(x86::rbp, proc_offset(trace_spill)), x86::rdx);
 				}
 
 				emit_mv_rax_rs1(dec);
@@ -883,8 +1021,8 @@ namespace riscv {
 					as.mov(rbp_reg_q(dec.rd), x86::rdx);
 				}
 
-				if (!proc.memory_registers && rdx != 2 /* x86::rdx */) {
-					as.mov(x86::rdx, x86::qword_ptr(x86::rbp, proc_offset(ireg[rv_ireg_ra])));
+				if (!opts.memory_registers && rdx != 2 /* x86::rdx */) {
+					as.mov(x86::rdx, x86::qword_ptr(x86::rbp, proc_offset(trace_spill)));
 				}
 			}
 			return true;
@@ -902,8 +1040,8 @@ namespace riscv {
 				emit_zero_rd(dec);
 			}
 			else {
-				if (!proc.memory_registers && rdx != 2 /* x86::rdx */) {
-					as.mov(x86::qword_ptr(x86::rbp, proc_offset(ireg[rv_ireg_ra])), x86::rdx);
+				if (!opts.memory_registers && rdx != 2 /* x86::rdx */) {
+					as.mov(x86::qword_ptr(x86::rbp, proc_offset(trace_spill)), x86::rdx);
 				}
 
 				emit_mv_rax_rs1(dec);
@@ -921,8 +1059,8 @@ namespace riscv {
 					as.mov(rbp_reg_q(dec.rd), x86::rdx);
 				}
 
-				if (!proc.memory_registers && rdx != 2 /* x86::rdx */) {
-					as.mov(x86::rdx, x86::qword_ptr(x86::rbp, proc_offset(ireg[rv_ireg_ra])));
+				if (!opts.memory_registers && rdx != 2 /* x86::rdx */) {
+					as.mov(x86::rdx, x86::qword_ptr(x86::rbp, proc_offset(trace_spill)));
 				}
 			}
 			return true;
@@ -940,8 +1078,8 @@ namespace riscv {
 				emit_zero_rd(dec);
 			}
 			else {
-				if (!proc.memory_registers && (rdx != 2 /* x86::rdx */ || (rs1x == 2 /* x86::rdx */ || rs2x == 2 /* x86::rdx */))) {
-					as.mov(x86::qword_ptr(x86::rbp, proc_offset(ireg[rv_ireg_ra])), x86::rdx);
+				if (!opts.memory_registers && (rdx != 2 /* x86::rdx */ || (rs1x == 2 /* x86::rdx */ || rs2x == 2 /* x86::rdx */))) {
+					as.mov(x86::qword_ptr(x86::rbp, proc_offset(trace_spill)), x86::rdx);
 				}
 
 				/* if rs1 is positive branch to umul */
@@ -963,8 +1101,8 @@ namespace riscv {
 				as.mov(x86::rcx, x86::rdx);
 
 				/* if necessary restore rdx input operand */
-				if (!proc.memory_registers && (rs1x == 2 || rs2x == 2 /* x86::rdx */)) {
-					as.mov(x86::rdx, x86::qword_ptr(x86::rbp, proc_offset(ireg[rv_ireg_ra])));
+				if (!opts.memory_registers && (rs1x == 2 || rs2x == 2 /* x86::rdx */)) {
+					as.mov(x86::rdx, x86::qword_ptr(x86::rbp, proc_offset(trace_spill)));
 				}
 
 				/* second multiply */
@@ -1001,8 +1139,8 @@ namespace riscv {
 					as.mov(rbp_reg_q(dec.rd), x86::rdx);
 				}
 
-				if (!proc.memory_registers && (rdx != 2 /* x86::rdx */)) {
-					as.mov(x86::rdx, x86::qword_ptr(x86::rbp, proc_offset(ireg[rv_ireg_ra])));
+				if (!opts.memory_registers && (rdx != 2 /* x86::rdx */)) {
+					as.mov(x86::rdx, x86::qword_ptr(x86::rbp, proc_offset(trace_spill)));
 				}
 			}
 			return true;
@@ -2879,22 +3017,12 @@ namespace riscv {
 
 		void emit_jump_fixup(addr_t pc)
 		{
-			auto jtl = create_jump_tramp(pc);
-			auto jfl = create_jump_fixup(pc);
-			as.jmp(jtl->second);
-			Label label = as.newLabel();
-			as.bind(label);
-			jfl->second.push_back(label);
+			as.jmp(create_jump_tramp(pc)->second);
 		}
 
 		void emit_branch_fixup(x86::Cond bf, addr_t pc)
 		{
-			auto jtl = create_jump_tramp(pc);
-			auto jfl = create_jump_fixup(pc);
-			as.j(bf, jtl->second);
-			Label label = as.newLabel();
-			as.bind(label);
-			jfl->second.push_back(label);
+			as.j(bf, create_jump_tramp(pc)->second);
 		}
 
 		bool emit_branch(decode_type &dec, bool cond, x86::Cond bf, x86::Cond ibf)
@@ -2916,38 +3044,18 @@ namespace riscv {
 			}
 			else if (cond && branch_i != labels.end()) {
 				as.j(bf, branch_i->second);
-				uintptr_t cont_addr = lookup_trace_slow(cont_pc);
-				if (cont_addr) {
-					as.jmp(Imm(cont_addr));
-				} else {
-					emit_jump_fixup(cont_pc);
-				}
+				emit_jump_fixup(cont_pc);
 				term_pc = 0;
 			}
 			else if (!cond && cont_i != labels.end()) {
 				as.j(ibf, cont_i->second);
-				uintptr_t branch_addr = lookup_trace_slow(branch_pc);
-				if (branch_addr) {
-					as.jmp(Imm(branch_addr));
-				} else {
-					emit_jump_fixup(branch_pc);
-				}
+				emit_jump_fixup(branch_pc);
 				term_pc = 0;
 			} else if (cond) {
-				uintptr_t cont_addr = lookup_trace_slow(cont_pc);
-				if (cont_addr) {
-					as.j(ibf, Imm(cont_addr));
-				} else {
-					emit_branch_fixup(ibf, cont_pc);
-				}
+				emit_branch_fixup(ibf, cont_pc);
 				term_pc = branch_pc;
 			} else {
-				uintptr_t branch_addr = lookup_trace_slow(branch_pc);
-				if (branch_addr) {
-					as.j(bf, Imm(branch_addr));
-				} else {
-					emit_branch_fixup(bf, branch_pc);
-				}
+				emit_branch_fixup(bf, branch_pc);
 				term_pc = cont_pc;
 			}
 			return true;
@@ -3758,7 +3866,8 @@ namespace riscv {
 					as.mov(rbp_reg_q(dec.rd), x86::rax);
 				}
 
-				as.jmp(Imm(func_address(lookup_trace_fast)));
+				emit_reg_spill();
+				emit_jmp_indirect();
 
 				return false;
 			}
@@ -3799,14 +3908,14 @@ namespace riscv {
 				as.mov(x86::gpq(rs1x), Imm(term_pc));
 			} else {
 				as.mov(x86::rax, Imm(term_pc));
-				as.mov(rbp_reg_q(dec.rs1), x86::rax);
+				as.mov(rbp_reg_q(dec.rd), x86::rax);
 			}
 
 			if (rdx > 0) {
 				as.mov(x86::gpq(rdx), Imm(link_addr));
 			} else {
 				as.mov(x86::rax, Imm(link_addr));
-				as.mov(rbp_reg_q(dec.rd), x86::rax);
+				as.mov(rbp_reg_q(rv_ireg_ra), x86::rax);
 			}
 
 			return true;
@@ -4208,6 +4317,529 @@ namespace riscv {
 			return true;
 		}
 
+		const X86Mem rbp_freg_q(int reg)
+		{
+			return x86::qword_ptr(x86::rbp, proc_offset(freg) + reg * sizeof(typename P::freg_t));
+		}
+
+		const X86Mem rbp_freg_d(int reg)
+		{
+			return x86::dword_ptr(x86::rbp, proc_offset(freg) + reg * sizeof(typename P::freg_t));
+		}
+
+		void emit_addr(decode_type &dec)
+		{
+			int rs1x = x86_reg(dec.rs1);
+			if (dec.rs1 == rv_ireg_zero) {
+				as.mov(x86::rax, Imm(dec.imm));
+			}
+			else if (rs1x > 0) {
+				as.lea(x86::rax, x86::qword_ptr(x86::gpq(rs1x), dec.imm));
+			}
+			else {
+				as.mov(x86::rcx, rbp_reg_q(dec.rs1));
+				as.lea(x86::rax, x86::qword_ptr(x86::rcx, dec.imm));
+			}
+		}
+
+		void emit_fault_check(decode_type &dec)
+		{
+			auto okay = as.newLabel();
+			as.cmp(x86::qword_ptr(x86::rbp, proc_offset(cause)), Imm(0));
+			as.je(okay);
+			emit_pc(dec.pc);
+			as.jmp(term);
+			as.bind(okay);
+		}
+
+		void emit_ireg_load(const X86Gp &dst, int reg)
+		{
+			int regx = x86_reg(reg);
+			if (reg == rv_ireg_zero) {
+				as.xor_(dst, dst);
+			}
+			else if (regx > 0) {
+				as.mov(dst, x86::gpq(regx));
+			}
+			else {
+				as.mov(dst, rbp_reg_q(reg));
+			}
+		}
+
+		void emit_ireg_store(int reg)
+		{
+			int regx = x86_reg(reg);
+			if (regx > 0) {
+				as.mov(x86::gpq(regx), x86::rax);
+			}
+			else {
+				as.mov(rbp_reg_q(reg), x86::rax);
+			}
+		}
+
+		bool emit_fld(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			emit_addr(dec);
+			if (use_mmu) {
+				as.call(Imm(func_address(ops.ld)));
+				emit_fault_check(dec);
+			} else {
+				as.mov(x86::rax, x86::qword_ptr(x86::rax));
+			}
+			as.mov(rbp_freg_q(dec.rd), x86::rax);
+			return true;
+		}
+
+		bool emit_flw(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			emit_addr(dec);
+			if (use_mmu) {
+				as.call(Imm(func_address(ops.lw)));
+				emit_fault_check(dec);
+			} else {
+				as.mov(x86::eax, x86::dword_ptr(x86::rax));
+			}
+			as.mov(rbp_freg_d(dec.rd), x86::eax);
+			return true;
+		}
+
+		bool emit_fsd(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			emit_addr(dec);
+			as.mov(x86::rcx, rbp_freg_q(dec.rs2));
+			if (use_mmu) {
+				as.call(Imm(func_address(ops.sd)));
+				emit_fault_check(dec);
+			} else {
+				as.mov(x86::qword_ptr(x86::rax), x86::rcx);
+			}
+			return true;
+		}
+
+		bool emit_fsw(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			emit_addr(dec);
+			as.mov(x86::ecx, rbp_freg_d(dec.rs2));
+			if (use_mmu) {
+				as.call(Imm(func_address(ops.sw)));
+				emit_fault_check(dec);
+			} else {
+				as.mov(x86::dword_ptr(x86::rax), x86::ecx);
+			}
+			return true;
+		}
+
+		/*
+		 * FP arithmetic executes in SSE2 scalar registers. The rounding
+		 * mode is the host MXCSR which tracks fcsr.frm (set on CSR writes)
+		 * and exception flags accrue in MXCSR exactly as for the interpreter.
+		 */
+
+		bool emit_fop_d(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			as.movsd(x86::xmm0, rbp_freg_q(dec.rs1));
+			switch (dec.op) {
+				case rv_op_fadd_d: as.addsd(x86::xmm0, rbp_freg_q(dec.rs2)); break;
+				case rv_op_fsub_d: as.subsd(x86::xmm0, rbp_freg_q(dec.rs2)); break;
+				case rv_op_fmul_d: as.mulsd(x86::xmm0, rbp_freg_q(dec.rs2)); break;
+				case rv_op_fdiv_d: as.divsd(x86::xmm0, rbp_freg_q(dec.rs2)); break;
+				case rv_op_fsqrt_d: as.sqrtsd(x86::xmm0, x86::xmm0); break;
+			}
+			as.movsd(rbp_freg_q(dec.rd), x86::xmm0);
+			return true;
+		}
+
+		bool emit_fop_s(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			as.movss(x86::xmm0, rbp_freg_d(dec.rs1));
+			switch (dec.op) {
+				case rv_op_fadd_s: as.addss(x86::xmm0, rbp_freg_d(dec.rs2)); break;
+				case rv_op_fsub_s: as.subss(x86::xmm0, rbp_freg_d(dec.rs2)); break;
+				case rv_op_fmul_s: as.mulss(x86::xmm0, rbp_freg_d(dec.rs2)); break;
+				case rv_op_fdiv_s: as.divss(x86::xmm0, rbp_freg_d(dec.rs2)); break;
+				case rv_op_fsqrt_s: as.sqrtss(x86::xmm0, x86::xmm0); break;
+			}
+			as.movss(rbp_freg_d(dec.rd), x86::xmm0);
+			return true;
+		}
+
+		bool emit_fmadd_d(decode_type &dec)
+		{
+			/* not fused: rd = rs1 * rs2 +/- rs3 (rs2 negated for fnmsub/fnmadd) */
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			as.movsd(x86::xmm0, rbp_freg_q(dec.rs1));
+			if (dec.op == rv_op_fnmsub_d || dec.op == rv_op_fnmadd_d) {
+				as.mov(x86::rax, rbp_freg_q(dec.rs2));
+				as.btc(x86::rax, Imm(63));
+				as.movq(x86::xmm1, x86::rax);
+				as.mulsd(x86::xmm0, x86::xmm1);
+			} else {
+				as.mulsd(x86::xmm0, rbp_freg_q(dec.rs2));
+			}
+			if (dec.op == rv_op_fmadd_d || dec.op == rv_op_fnmsub_d) {
+				as.addsd(x86::xmm0, rbp_freg_q(dec.rs3));
+			} else {
+				as.subsd(x86::xmm0, rbp_freg_q(dec.rs3));
+			}
+			as.movsd(rbp_freg_q(dec.rd), x86::xmm0);
+			return true;
+		}
+
+		bool emit_fmadd_s(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			as.movss(x86::xmm0, rbp_freg_d(dec.rs1));
+			if (dec.op == rv_op_fnmsub_s || dec.op == rv_op_fnmadd_s) {
+				as.mov(x86::eax, rbp_freg_d(dec.rs2));
+				as.btc(x86::eax, Imm(31));
+				as.movd(x86::xmm1, x86::eax);
+				as.mulss(x86::xmm0, x86::xmm1);
+			} else {
+				as.mulss(x86::xmm0, rbp_freg_d(dec.rs2));
+			}
+			if (dec.op == rv_op_fmadd_s || dec.op == rv_op_fnmsub_s) {
+				as.addss(x86::xmm0, rbp_freg_d(dec.rs3));
+			} else {
+				as.subss(x86::xmm0, rbp_freg_d(dec.rs3));
+			}
+			as.movss(rbp_freg_d(dec.rd), x86::xmm0);
+			return true;
+		}
+
+		bool emit_fsgnj_d(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			as.mov(x86::rax, rbp_freg_q(dec.rs1));
+			as.mov(x86::rcx, rbp_freg_q(dec.rs2));
+			if (dec.op != rv_op_fsgnjx_d) {
+				as.btr(x86::rax, Imm(63));
+			}
+			if (dec.op == rv_op_fsgnjn_d) {
+				as.not_(x86::rcx);
+			}
+			as.shr(x86::rcx, Imm(63));
+			as.shl(x86::rcx, Imm(63));
+			if (dec.op == rv_op_fsgnjx_d) {
+				as.xor_(x86::rax, x86::rcx);
+			} else {
+				as.or_(x86::rax, x86::rcx);
+			}
+			as.mov(rbp_freg_q(dec.rd), x86::rax);
+			return true;
+		}
+
+		bool emit_fsgnj_s(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			as.mov(x86::eax, rbp_freg_d(dec.rs1));
+			as.mov(x86::ecx, rbp_freg_d(dec.rs2));
+			if (dec.op != rv_op_fsgnjx_s) {
+				as.btr(x86::eax, Imm(31));
+			}
+			if (dec.op == rv_op_fsgnjn_s) {
+				as.not_(x86::ecx);
+			}
+			as.and_(x86::ecx, Imm(0x80000000));
+			if (dec.op == rv_op_fsgnjx_s) {
+				as.xor_(x86::eax, x86::ecx);
+			} else {
+				as.or_(x86::eax, x86::ecx);
+			}
+			as.mov(rbp_freg_d(dec.rd), x86::eax);
+			return true;
+		}
+
+		bool emit_fcmp(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			if (dec.rd == rv_ireg_zero) return true;
+			bool sp = dec.op == rv_op_feq_s || dec.op == rv_op_flt_s || dec.op == rv_op_fle_s;
+			switch (dec.op) {
+				case rv_op_feq_s:
+				case rv_op_feq_d:
+					/* quiet compare, unordered sets PF */
+					if (sp) {
+						as.movss(x86::xmm0, rbp_freg_d(dec.rs1));
+						as.ucomiss(x86::xmm0, rbp_freg_d(dec.rs2));
+					} else {
+						as.movsd(x86::xmm0, rbp_freg_q(dec.rs1));
+						as.ucomisd(x86::xmm0, rbp_freg_q(dec.rs2));
+					}
+					as.sete(x86::al);
+					as.setnp(x86::cl);
+					as.and_(x86::al, x86::cl);
+					break;
+				default:
+					/* signaling compare with operands swapped, unordered sets CF */
+					if (sp) {
+						as.movss(x86::xmm0, rbp_freg_d(dec.rs2));
+						as.comiss(x86::xmm0, rbp_freg_d(dec.rs1));
+					} else {
+						as.movsd(x86::xmm0, rbp_freg_q(dec.rs2));
+						as.comisd(x86::xmm0, rbp_freg_q(dec.rs1));
+					}
+					if (dec.op == rv_op_flt_s || dec.op == rv_op_flt_d) {
+						as.seta(x86::al);
+					} else {
+						as.setae(x86::al);
+					}
+					break;
+			}
+			as.movzx(x86::eax, x86::al);
+			emit_ireg_store(dec.rd);
+			return true;
+		}
+
+		bool emit_fcvt_x_f(decode_type &dec)
+		{
+			/* truncating conversion, NaN and positive overflow saturate to max */
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			if (dec.rd == rv_ireg_zero) return true;
+			bool sp = dec.op == rv_op_fcvt_w_s || dec.op == rv_op_fcvt_l_s;
+			bool w = dec.op == rv_op_fcvt_w_s || dec.op == rv_op_fcvt_w_d;
+			auto max = as.newLabel(), done = as.newLabel();
+			if (sp) {
+				as.movss(x86::xmm0, rbp_freg_d(dec.rs1));
+				if (w) as.cvttss2si(x86::eax, x86::xmm0);
+				else as.cvttss2si(x86::rax, x86::xmm0);
+			} else {
+				as.movsd(x86::xmm0, rbp_freg_q(dec.rs1));
+				if (w) as.cvttsd2si(x86::eax, x86::xmm0);
+				else as.cvttsd2si(x86::rax, x86::xmm0);
+			}
+			if (w) {
+				as.cmp(x86::eax, Imm(0x80000000));
+			} else {
+				as.mov(x86::rcx, Imm(0x8000000000000000ULL));
+				as.cmp(x86::rax, x86::rcx);
+			}
+			as.jne(done);
+			as.xorps(x86::xmm1, x86::xmm1);
+			if (sp) {
+				as.ucomiss(x86::xmm0, x86::xmm1);
+			} else {
+				as.ucomisd(x86::xmm0, x86::xmm1);
+			}
+			as.jp(max);
+			as.jbe(done);
+			as.bind(max);
+			if (w) {
+				as.mov(x86::eax, Imm(0x7fffffff));
+			} else {
+				as.mov(x86::rax, Imm(0x7fffffffffffffffULL));
+			}
+			as.bind(done);
+			if (w) {
+				as.movsxd(x86::rax, x86::eax);
+			}
+			emit_ireg_store(dec.rd);
+			return true;
+		}
+
+		bool emit_fcvt_f_x(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			emit_ireg_load(x86::rax, dec.rs1);
+			switch (dec.op) {
+				case rv_op_fcvt_s_w:
+				case rv_op_fcvt_d_w:
+					as.movsxd(x86::rax, x86::eax);
+					break;
+				case rv_op_fcvt_s_wu:
+				case rv_op_fcvt_d_wu:
+					as.mov(x86::eax, x86::eax);
+					break;
+			}
+			switch (dec.op) {
+				case rv_op_fcvt_s_w:
+				case rv_op_fcvt_s_wu:
+				case rv_op_fcvt_s_l:
+					as.cvtsi2ss(x86::xmm0, x86::rax);
+					as.movss(rbp_freg_d(dec.rd), x86::xmm0);
+					break;
+				default:
+					as.cvtsi2sd(x86::xmm0, x86::rax);
+					as.movsd(rbp_freg_q(dec.rd), x86::xmm0);
+					break;
+			}
+			return true;
+		}
+
+		bool emit_fcvt_f_f(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			if (dec.op == rv_op_fcvt_s_d) {
+				as.cvtsd2ss(x86::xmm0, rbp_freg_q(dec.rs1));
+				as.movss(rbp_freg_d(dec.rd), x86::xmm0);
+			} else {
+				as.cvtss2sd(x86::xmm0, rbp_freg_d(dec.rs1));
+				as.movsd(rbp_freg_q(dec.rd), x86::xmm0);
+			}
+			return true;
+		}
+
+		bool emit_fmv_f_x(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			emit_ireg_load(x86::rax, dec.rs1);
+			if (dec.op == rv_op_fmv_s_x) {
+				as.mov(rbp_freg_d(dec.rd), x86::eax);
+			} else {
+				as.mov(rbp_freg_q(dec.rd), x86::rax);
+			}
+			return true;
+		}
+
+		/*
+		 * Atomics operate directly on host memory: amoswap uses xchg,
+		 * amoadd uses lock xadd and the remaining AMOs use a lock cmpxchg
+		 * loop. The LR reservation is the address held in proc.lr, the
+		 * same reservation the interpreter checks for SC.
+		 */
+
+		bool emit_lr(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			bool w = dec.op == rv_op_lr_w;
+			emit_addr(dec);
+			as.mov(x86::qword_ptr(x86::rbp, proc_offset(lr)), x86::rax);
+			if (use_mmu) {
+				as.call(Imm(w ? func_address(ops.lw) : func_address(ops.ld)));
+				emit_fault_check(dec);
+				if (w) as.movsxd(x86::rax, x86::eax);
+			} else if (w) {
+				as.movsxd(x86::rax, x86::dword_ptr(x86::rax));
+			} else {
+				as.mov(x86::rax, x86::qword_ptr(x86::rax));
+			}
+			if (dec.rd != rv_ireg_zero) {
+				emit_ireg_store(dec.rd);
+			}
+			return true;
+		}
+
+		bool emit_sc(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			bool w = dec.op == rv_op_sc_w;
+			auto fail = as.newLabel(), done = as.newLabel();
+			emit_addr(dec);
+			as.cmp(x86::rax, x86::qword_ptr(x86::rbp, proc_offset(lr)));
+			as.jne(fail);
+			emit_ireg_load(x86::rcx, dec.rs2);
+			if (use_mmu) {
+				as.call(Imm(w ? func_address(ops.sw) : func_address(ops.sd)));
+				emit_fault_check(dec);
+			} else if (w) {
+				as.mov(x86::dword_ptr(x86::rax), x86::ecx);
+			} else {
+				as.mov(x86::qword_ptr(x86::rax), x86::rcx);
+			}
+			as.xor_(x86::eax, x86::eax);
+			as.jmp(done);
+			as.bind(fail);
+			as.mov(x86::eax, Imm(1));
+			as.bind(done);
+			if (dec.rd != rv_ireg_zero) {
+				emit_ireg_store(dec.rd);
+			}
+			return true;
+		}
+
+		bool emit_amo(decode_type &dec)
+		{
+			log_trace("\t# 0x%016llx\t%s", dec.pc, disasm_inst_simple(dec).c_str());
+			term_pc = dec.pc + inst_length(dec.inst);
+			bool w = false;
+			switch (dec.op) {
+				case rv_op_amoswap_w: case rv_op_amoadd_w: case rv_op_amoxor_w:
+				case rv_op_amoor_w: case rv_op_amoand_w: case rv_op_amomin_w:
+				case rv_op_amomax_w: case rv_op_amominu_w: case rv_op_amomaxu_w:
+					w = true;
+					break;
+			}
+			auto mem = w ? x86::dword_ptr(x86::rax) : x86::qword_ptr(x86::rax);
+			auto val = w ? x86::ecx : x86::rcx;
+			emit_addr(dec);
+			emit_ireg_load(x86::rcx, dec.rs2);
+			switch (dec.op) {
+				case rv_op_amoswap_w:
+				case rv_op_amoswap_d:
+					as.xchg(mem, val);
+					break;
+				case rv_op_amoadd_w:
+				case rv_op_amoadd_d:
+					as.lock().xadd(mem, val);
+					break;
+				default: {
+					/* rdx holds the address, the operand is spilled to the stack */
+					auto loop = as.newLabel();
+					auto old = w ? x86::eax : x86::rax;
+					auto arg = w ? x86::dword_ptr(x86::rsp) : x86::qword_ptr(x86::rsp);
+					as.push(x86::rdx);
+					as.push(x86::rcx);
+					as.mov(x86::rdx, x86::rax);
+					as.mov(old, w ? x86::dword_ptr(x86::rdx) : x86::qword_ptr(x86::rdx));
+					as.bind(loop);
+					as.mov(val, old);
+					switch (dec.op) {
+						case rv_op_amoxor_w:
+						case rv_op_amoxor_d:  as.xor_(val, arg); break;
+						case rv_op_amoor_w:
+						case rv_op_amoor_d:   as.or_(val, arg); break;
+						case rv_op_amoand_w:
+						case rv_op_amoand_d:  as.and_(val, arg); break;
+						case rv_op_amomin_w:
+						case rv_op_amomin_d:  as.cmp(val, arg); as.cmovg(val, arg); break;
+						case rv_op_amomax_w:
+						case rv_op_amomax_d:  as.cmp(val, arg); as.cmovl(val, arg); break;
+						case rv_op_amominu_w:
+						case rv_op_amominu_d: as.cmp(val, arg); as.cmova(val, arg); break;
+						case rv_op_amomaxu_w:
+						case rv_op_amomaxu_d: as.cmp(val, arg); as.cmovb(val, arg); break;
+					}
+					as.lock().cmpxchg(w ? x86::dword_ptr(x86::rdx) : x86::qword_ptr(x86::rdx), val);
+					as.jne(loop);
+					as.mov(val, old);
+					as.pop(x86::rax);
+					as.pop(x86::rdx);
+					break;
+				}
+			}
+			if (dec.rd != rv_ireg_zero) {
+				if (w) {
+					as.movsxd(x86::rax, x86::ecx);
+				} else {
+					as.mov(x86::rax, x86::rcx);
+				}
+				emit_ireg_store(dec.rd);
+			}
+			return true;
+		}
+
 		bool emit(decode_type &dec)
 		{
 			auto li = labels.find(dec.pc);
@@ -4281,6 +4913,76 @@ namespace riscv {
 				case rv_op_sh:        instret++;    return emit_sh(dec);
 				case rv_op_sb:        instret++;    return emit_sb(dec);
 				case rv_op_lui:       instret++;    return emit_lui(dec);
+				case rv_op_lr_w:
+				case rv_op_lr_d:      instret++;    return emit_lr(dec);
+				case rv_op_sc_w:
+				case rv_op_sc_d:      instret++;    return emit_sc(dec);
+				case rv_op_amoswap_w:
+				case rv_op_amoadd_w:
+				case rv_op_amoxor_w:
+				case rv_op_amoor_w:
+				case rv_op_amoand_w:
+				case rv_op_amomin_w:
+				case rv_op_amomax_w:
+				case rv_op_amominu_w:
+				case rv_op_amomaxu_w:
+				case rv_op_amoswap_d:
+				case rv_op_amoadd_d:
+				case rv_op_amoxor_d:
+				case rv_op_amoor_d:
+				case rv_op_amoand_d:
+				case rv_op_amomin_d:
+				case rv_op_amomax_d:
+				case rv_op_amominu_d:
+				case rv_op_amomaxu_d: instret++;    return emit_amo(dec);
+				case rv_op_fld:       instret++;    return emit_fld(dec);
+				case rv_op_flw:       instret++;    return emit_flw(dec);
+				case rv_op_fsd:       instret++;    return emit_fsd(dec);
+				case rv_op_fsw:       instret++;    return emit_fsw(dec);
+				case rv_op_fadd_d:
+				case rv_op_fsub_d:
+				case rv_op_fmul_d:
+				case rv_op_fdiv_d:
+				case rv_op_fsqrt_d:   instret++;    return emit_fop_d(dec);
+				case rv_op_fadd_s:
+				case rv_op_fsub_s:
+				case rv_op_fmul_s:
+				case rv_op_fdiv_s:
+				case rv_op_fsqrt_s:   instret++;    return emit_fop_s(dec);
+				case rv_op_fmadd_d:
+				case rv_op_fmsub_d:
+				case rv_op_fnmsub_d:
+				case rv_op_fnmadd_d:  instret++;    return emit_fmadd_d(dec);
+				case rv_op_fmadd_s:
+				case rv_op_fmsub_s:
+				case rv_op_fnmsub_s:
+				case rv_op_fnmadd_s:  instret++;    return emit_fmadd_s(dec);
+				case rv_op_fsgnj_d:
+				case rv_op_fsgnjn_d:
+				case rv_op_fsgnjx_d:  instret++;    return emit_fsgnj_d(dec);
+				case rv_op_fsgnj_s:
+				case rv_op_fsgnjn_s:
+				case rv_op_fsgnjx_s:  instret++;    return emit_fsgnj_s(dec);
+				case rv_op_feq_d:
+				case rv_op_flt_d:
+				case rv_op_fle_d:
+				case rv_op_feq_s:
+				case rv_op_flt_s:
+				case rv_op_fle_s:     instret++;    return emit_fcmp(dec);
+				case rv_op_fcvt_w_d:
+				case rv_op_fcvt_l_d:
+				case rv_op_fcvt_w_s:
+				case rv_op_fcvt_l_s:  instret++;    return emit_fcvt_x_f(dec);
+				case rv_op_fcvt_d_w:
+				case rv_op_fcvt_d_wu:
+				case rv_op_fcvt_d_l:
+				case rv_op_fcvt_s_w:
+				case rv_op_fcvt_s_wu:
+				case rv_op_fcvt_s_l:  instret++;    return emit_fcvt_f_x(dec);
+				case rv_op_fcvt_s_d:
+				case rv_op_fcvt_d_s:  instret++;    return emit_fcvt_f_f(dec);
+				case rv_op_fmv_d_x:
+				case rv_op_fmv_s_x:   instret++;    return emit_fmv_f_x(dec);
 				case rv_op_jal:       instret++;    return emit_jal(dec);
 				case rv_op_jalr:      instret++;    return emit_jalr(dec);
 				case jit_op_la:       instret += 2; return emit_la(dec);
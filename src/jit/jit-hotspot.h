@@ -0,0 +1,79 @@
+//
+//  jit-hotspot.h
+//
+
+#ifndef rv_jit_hotspot_h
+#define rv_jit_hotspot_h
+
+namespace riscv {
+
+	/*
+	 * jit_hotspot
+	 *
+	 * Saturating execution counters for control flow targets, held in an
+	 * open addressed table with a short linear probe. When the probe window
+	 * is full the coldest entry is replaced, so rarely reached targets are
+	 * forgotten rather than growing the table.
+	 *
+	 * hotspot[pc] = count
+	 */
+
+	template <const size_t table_size = 8192, const size_t probe_max = 8>
+	struct jit_hotspot
+	{
+		static_assert(ispow2(table_size), "table_size must be a power of 2");
+
+		enum : u32 {
+			count_limit = std::numeric_limits<u32>::max() - 1,
+			count_skip = std::numeric_limits<u32>::max()     /* pc can't be traced */
+		};
+
+		struct hotspot_ent
+		{
+			addr_t pc;
+			u32    count;
+		};
+
+		std::vector<hotspot_ent> table;
+
+		jit_hotspot() : table(table_size) {}
+
+		static size_t slot(addr_t pc)
+		{
+			return ((pc >> 1) * 0x9e3779b97f4a7c15ULL) >> (64 - ctz_pow2(table_size));
+		}
+
+		hotspot_ent& lookup(addr_t pc)
+		{
+			size_t i = slot(pc);
+			hotspot_ent *victim = &table[i];
+			for (size_t p = 0; p < probe_max; p++, i = (i + 1) & (table_size - 1)) {
+				hotspot_ent &ent = table[i];
+				if (ent.pc == pc) return ent;
+				if (ent.pc == 0) {
+					victim = &ent;
+					break;
+				}
+				if (ent.count < victim->count) victim = &ent;
+			}
+			*victim = hotspot_ent{ pc, 0 };
+			return *victim;
+		}
+
+		/* returns the count after incrementing, or count_skip */
+		u32 add(addr_t pc)
+		{
+			hotspot_ent &ent = lookup(pc);
+			if (ent.count < count_limit) ent.count++;
+			return ent.count;
+		}
+
+		void set(addr_t pc, u32 count)
+		{
+			lookup(pc).count = count;
+		}
+	};
+
+}
+
+#endif
@@ -23,6 +23,16 @@ namespace riscv {
 		std::vector<std::string> bbinfo;
 		std::vector<std::vector<std::string>> reginfo;
 
+		int regmap[P::ireg_count];    /* guest register to host register, -1 for memory */
+		u32 reg_entry;                /* registers loaded on trace entry */
+		u32 reg_def;                  /* registers spilled on trace exit */
+
+		jit_regalloc() : reg_entry(~0U), reg_def(~0U)
+		{
+			for (size_t r = 0; r < P::ireg_count; r++) regmap[r] = -1;
+			regmap[rv_ireg_zero] = 0;
+		}
+
 		const char* inst_format(decode_type &dec)
 		{
 			static const char* jit_format[] = {
@@ -67,26 +77,7 @@ namespace riscv {
 
 		int x86_reg(int rd)
 		{
-			/*
-			 * TODO - get the emitter to use common code
-			 *        and eliminate some copied code
-			 */
-			switch (rd) {
-				case rv_ireg_zero: return 0;
-				case rv_ireg_ra: return 2;  /* rdx */
-				case rv_ireg_sp: return 3;  /* rbx */
-				case rv_ireg_t0: return 6;  /* rsi */
-				case rv_ireg_t1: return 7;  /* rdi */
-				case rv_ireg_a0: return 8;  /* r8  */
-				case rv_ireg_a1: return 9;  /* r9  */
-				case rv_ireg_a2: return 10; /* r10 */
-				case rv_ireg_a3: return 11; /* r11 */
-				case rv_ireg_a4: return 12; /* r12 */
-				case rv_ireg_a5: return 13; /* r13 */
-				case rv_ireg_a6: return 14; /* r14 */
-				case rv_ireg_a7: return 15; /* r15 */
-				default: return -1;
-			}
+			return regmap[rd];
 		}
 
 		template <typename T>
@@ -178,6 +169,106 @@ namespace riscv {
 			}
 		}
 
+		bool may_exit(decode_type &dec)
+		{
+			/* branches, jumps and memory accesses can leave the trace */
+			return is_branch(dec) || is_jump(dec) || strchr(inst_format(dec), '(');
+		}
+
+		void def_use(decode_type &dec, u32 &def, u32 &use)
+		{
+			def = use = 0;
+			switch (dec.op) {
+				case jit_op_call:
+					def = (1U << dec.rd) | (1U << rv_ireg_ra);
+					break;
+				case jit_op_addiwz:
+					def = use = (1U << dec.rd);
+					break;
+				case jit_op_rorwi_rr:
+				case jit_op_rorwi_lr:
+				case jit_op_rordi_rr:
+				case jit_op_rordi_lr:
+					def = (1U << dec.rd) | (1U << dec.rs2);
+					use = (1U << dec.rs1) | (1U << dec.rs2);
+					break;
+				default:
+					for (const char *fmt = inst_format(dec); *fmt; fmt++) {
+						switch (*fmt) {
+							case '0': def |= (1U << dec.rd); break;
+							case '1': use |= (1U << dec.rs1); break;
+							case '2': use |= (1U << dec.rs2); break;
+							default: break;
+						}
+					}
+					break;
+			}
+			def &= ~1U;
+			use &= ~1U;
+		}
+
+		/*
+		 * Assign host registers to the guest registers of a trace.
+		 *
+		 * Guest registers are ranked by use count, weighted by the loop
+		 * nesting depth of internal backward branches, and the hottest are
+		 * given host registers for the whole trace. Registers are loaded at
+		 * trace entry unless they are defined before any use or exit, and
+		 * registers defined in the trace are spilled at exits.
+		 */
+		void allocate(std::vector<decode_type> &trace, const int *host_regs, size_t host_count)
+		{
+			std::map<addr_t,size_t> pc_index;
+			std::vector<size_t> depth(trace.size(), 0);
+			for (size_t i = 0; i < trace.size(); i++) {
+				pc_index[trace[i].pc] = i;
+			}
+			for (size_t i = 0; i < trace.size(); i++) {
+				auto &dec = trace[i];
+				if (!(is_branch(dec) || dec.op == rv_op_jal) || intptr_t(dec.imm) >= 0) continue;
+				auto ti = pc_index.find(dec.pc + dec.imm);
+				if (ti == pc_index.end()) continue;
+				for (size_t j = ti->second; j <= i; j++) depth[j]++;
+			}
+
+			size_t weight[P::ireg_count] = { 0 };
+			u32 seen = 0;
+			reg_entry = 0;
+			reg_def = 0;
+			for (size_t i = 0; i < trace.size(); i++) {
+				u32 def, use;
+				auto &dec = trace[i];
+				def_use(dec, def, use);
+				size_t w = size_t(1) << (3 * std::min(depth[i], size_t(3)));
+				for (size_t r = 1; r < P::ireg_count; r++) {
+					if ((def | use) & (1U << r)) weight[r] += w;
+				}
+				reg_entry |= use & ~seen;
+				seen |= use;
+				/* a faulting load exits before rd is written, so rd must hold
+				   its entry value for the spill at the exit */
+				if (may_exit(dec)) {
+					reg_entry |= ~seen;
+					seen = ~0U;
+				}
+				seen |= def;
+				reg_def |= def;
+			}
+			reg_entry |= ~seen;
+
+			std::vector<size_t> rank;
+			for (size_t r = 1; r < P::ireg_count; r++) {
+				regmap[r] = -1;
+				if (weight[r] > 0) rank.push_back(r);
+			}
+			std::stable_sort(rank.begin(), rank.end(), [&] (size_t a, size_t b) {
+				return weight[a] > weight[b];
+			});
+			for (size_t i = 0; i < rank.size() && i < host_count; i++) {
+				regmap[rank[i]] = host_regs[i];
+			}
+		}
+
 		void scan_def(std::vector<decode_type> &trace, size_t i, size_t r)
 		{
 			for (ssize_t j = i; j >= 0; j--) {
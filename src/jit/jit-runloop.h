@@ -7,12 +7,20 @@
 
 namespace riscv {
 
+	/* runloop running on this thread, used by signal handlers and mmu trampolines */
 	struct jit_singleton
 	{
-		static jit_singleton *current;
+		static thread_local jit_singleton *current;
+
+		/* signals on threads without a runloop take the default action */
+		static void signal_unowned(int signum)
+		{
+			signal(signum, SIG_DFL);
+			if (signum != SIGSEGV && signum != SIGBUS) raise(signum);
+		}
 	};
 
-	jit_singleton* jit_singleton::current = nullptr;
+	thread_local jit_singleton* jit_singleton::current = nullptr;
 
 	struct jit_logger : Logger
 	{
@@ -30,6 +38,9 @@ namespace riscv {
 		typedef J jit_emitter;
 
 		static const size_t inst_cache_size = 8191;
+		static const size_t trace_front_size = 4096;
+		static const size_t trace_regions = 8;
+		static const size_t jit_queue_size = 256;
 		static const int inst_step = 100000;
 
 		struct rv_inst_cache_ent
@@ -38,28 +49,118 @@ namespace riscv {
 			typename P::decode_type dec;
 		};
 
+		/* direct mapped pc -> trace prolog cache in front of trace_cache_prolog
+		 * (fn is nullptr for pcs that are known to have no trace) */
+		struct trace_front_ent
+		{
+			addr_t pc;
+			TraceFunc fn;
+		};
+
+		/* translated trace code range, branch targets and jump target caches */
+		struct trace_info_ent
+		{
+			TraceFunc fn;
+			intptr_t code_begin;
+			intptr_t code_end;
+			std::vector<addr_t> jmp_targets;
+			std::vector<intptr_t> jmp_caches;
+			u64 region;                    /* id of the region holding the trace, 0 if none */
+		};
+
+		/* jump site patched to branch directly to another trace */
+		struct trace_link
+		{
+			intptr_t site;
+			int disp;
+		};
+
+		/* trace compiled on the JIT thread and published by the interpreter;
+		 * label offsets are resolved so the CodeHolder is not kept */
+		struct jit_job
+		{
+			addr_t pc;
+			addr_t end_pc;
+			u64 gen;
+			std::vector<typename P::decode_type> trace;
+			jit_options opts;
+			TraceFunc fn;
+			size_t entry_offset;
+			size_t code_size;
+			std::vector<std::pair<addr_t,std::vector<size_t>>> jmp_fixups;
+			std::vector<size_t> jmp_caches;
+		};
+
+		/* traces are allocated in regions (generations) and the oldest
+		 * region is evicted when the trace cache exceeds its size limit */
+		struct trace_region
+		{
+			u64 id;
+			size_t bytes;
+			std::vector<addr_t> pcs;
+		};
+
 		JitRuntime rt;
 		google::dense_hash_map<addr_t,TraceFunc> trace_cache_prolog;
 		google::dense_hash_map<addr_t,TraceFunc> trace_cache_entry;
 		google::dense_hash_map<addr_t,TraceFunc> audit_trace_cache_prolog;
 		std::map<addr_t,std::vector<intptr_t>> jmp_fixup_addrs;
+		std::map<addr_t,std::vector<trace_link>> jmp_links;
+		std::map<addr_t,trace_info_ent> trace_info;
+		std::deque<trace_region> trace_region_list;
+		google::dense_hash_map<addr_t,size_t> trace_evicted;
 		std::shared_ptr<debug_cli<P>> cli;
+		typedef block_cache<typename P::decode_type> block_cache_type;
+		typedef typename block_cache_type::block_ent block_ent;
+		typedef jit_hotspot<> hotspot_type;
+		typedef jit_trace_store<typename P::decode_type> trace_store_type;
+
 		rv_inst_cache_ent inst_cache[inst_cache_size];
+		block_cache_type blocks;
+		typename P::decode_type *block_dec;
+		hotspot_type hotspot;
+		queue_atomic<jit_job*> jit_queue;
+		queue_atomic<jit_job*> jit_done;
+		std::mutex jit_mutex;
+		std::condition_variable jit_cond;
+		std::atomic<bool> jit_running;
+		std::thread jit_thread;
+		size_t jit_pending;
+		u64 trace_gen;
+		u64 trace_region_id;
+		std::string trace_cache_dir;
+		trace_store_type trace_store;
+		trace_front_ent trace_front[trace_front_size];
 		TraceLookup lookup_trace_fast;
+		TraceLookup lookup_trace_ic;
 		mmu_ops ops;
 
 		jit_runloop() : jit_runloop(std::make_shared<debug_cli<P>>()) {}
-		jit_runloop(std::shared_ptr<debug_cli<P>> cli) : cli(cli), inst_cache(), ops{
+		jit_runloop(std::shared_ptr<debug_cli<P>> cli) : cli(cli), inst_cache(), block_dec(nullptr),
+			jit_queue(jit_queue_size), jit_done(jit_queue_size), jit_running(true), jit_pending(0), trace_gen(0), trace_region_id(0),
+			trace_store(P::xlen), trace_front(), ops{
 			.lb = mmu_lb, .lh = mmu_lh, .lw = mmu_lw, .ld = mmu_ld,
 			.sb = mmu_sb, .sh = mmu_sh, .sw = mmu_sw, .sd = mmu_sd
 		}
 		{
+			clear_trace_front();
 			trace_cache_prolog.set_empty_key(0);
 			trace_cache_prolog.set_deleted_key(-1);
 			trace_cache_entry.set_empty_key(0);
 			trace_cache_entry.set_deleted_key(-1);
 			audit_trace_cache_prolog.set_empty_key(0);
 			audit_trace_cache_prolog.set_deleted_key(-1);
+			trace_evicted.set_empty_key(0);
+			trace_evicted.set_deleted_key(-1);
+		}
+
+		~jit_runloop()
+		{
+			jit_shutdown();
+			trace_store_release();
+			if (jit_singleton::current == this) {
+				jit_singleton::current = nullptr;
+			}
 		}
 
 		virtual bool handleError(Error err, const char* message, CodeEmitter* origin)
@@ -70,10 +171,21 @@ namespace riscv {
 
 		static void signal_handler(int signum, siginfo_t *info, void *)
 		{
+			if (!jit_singleton::current) {
+				jit_singleton::signal_unowned(signum);
+				return;
+			}
 			static_cast<jit_runloop<P,T,J>*>
 				(jit_singleton::current)->signal_dispatch(signum, info);
 		}
 
+		/* bind this runloop to the calling thread */
+		void make_current()
+		{
+			jit_singleton::current = this;
+			P::bind_thread();
+		}
+
 		void signal_dispatch(int signum, siginfo_t *info)
 		{
 			printf("SIGNAL   :%s pc:0x%0llx si_addr:0x%0llx\n",
@@ -115,7 +227,7 @@ namespace riscv {
 			sigaction(SIGINT, &sigaction_handler, nullptr);
 			sigaction(SIGHUP, &sigaction_handler, nullptr);
 			sigaction(SIGUSR1, &sigaction_handler, nullptr);
-			jit_singleton::current = this;
+			make_current();
 
 			/* unblock signals */
 			if (pthread_sigmask(SIG_UNBLOCK, &set, NULL) != 0) {
@@ -128,6 +240,25 @@ namespace riscv {
 			/* create trace lookup and load store functions */
 			create_trace_lookup();
 			create_load_store();
+
+			/* start the trace compiler thread */
+			if (P::log & proc_log_jit_trap) {
+				jit_thread = std::thread(&jit_runloop<P,T,J>::jit_mainloop, this);
+			}
+
+			/* re-emit traces saved by earlier runs of the same text */
+			if ((P::log & proc_log_jit_trap) && trace_cache_dir.size() > 0) {
+				if (mkdir(trace_cache_dir.c_str(), 0777) < 0 && errno != EEXIST) {
+					panic("can't create jit cache directory: %s: %s",
+						trace_cache_dir.c_str(), strerror(errno));
+				}
+				trace_store.hash_text(P::elf, P::imageoffset);
+				trace_store.load(trace_cache_dir);
+				for (auto &ent : trace_store.traces) {
+					jit_submit(new jit_job{ ent.first, ent.second.back().pc, trace_gen, ent.second, jit_opts() });
+				}
+				trace_store_register();
+			}
 		}
 
 		void create_trace_lookup()
@@ -135,8 +266,9 @@ namespace riscv {
 			CodeHolder code;
 			code.init(rt.getCodeInfo());
 			code.setErrorHandler(this);
-			jit_emitter emitter(*this, code, ops, lookup_trace, nullptr);
+			jit_emitter emitter(jit_opts(), code, ops, lookup_trace, nullptr, nullptr);
 			lookup_trace_fast = emitter.create_trace_lookup(rt);
+			lookup_trace_ic = emitter.lookup_trace_ic;
 		}
 
 		void create_load_store()
@@ -144,7 +276,7 @@ namespace riscv {
 			CodeHolder code;
 			code.init(rt.getCodeInfo());
 			code.setErrorHandler(this);
-			jit_emitter emitter(*this, code, ops, lookup_trace, nullptr);
+			jit_emitter emitter(jit_opts(), code, ops, lookup_trace, nullptr, nullptr);
 			ops = emitter.create_load_store(rt);
 		}
 
@@ -185,6 +317,7 @@ namespace riscv {
 					return pc_offset;
 				case rv_op_fence_i:
 					clear_trace_cache();
+					blocks.flush();
 					return pc_offset;
 				default: break;
 			}
@@ -193,11 +326,157 @@ namespace riscv {
 
 		void clear_trace_cache()
 		{
+			trace_gen++;
 			for (auto ent : trace_cache_prolog) {
 				rt.release(ent.second);
 			}
 			trace_cache_prolog.clear_no_resize();
 			trace_cache_entry.clear_no_resize();
+			jmp_fixup_addrs.clear();
+			jmp_links.clear();
+			trace_info.clear();
+			trace_region_list.clear();
+			P::trace_cache_bytes = P::trace_cache_traces = 0;
+			clear_trace_front();
+		}
+
+		/* replaced traces are not counted as evictions */
+		void evict_trace(addr_t pc, bool replaced = false)
+		{
+			auto ti = trace_info.find(pc);
+			if (ti == trace_info.end()) return;
+			trace_info_ent &ent = ti->second;
+
+			/* unlink jumps from other traces, restoring their trampolines */
+			auto jl = jmp_links.find(pc);
+			if (jl != jmp_links.end()) {
+				auto &fixups = jmp_fixup_addrs[pc];
+				for (auto &link : jl->second) {
+					*(int*)(link.site - 4) = link.disp;
+					fixups.push_back(link.site);
+				}
+				jmp_links.erase(jl);
+			}
+
+			/* drop pending and patched jumps located in this trace */
+			auto in_trace = [&](intptr_t site) {
+				return site >= ent.code_begin && site < ent.code_end;
+			};
+			for (auto target : ent.jmp_targets) {
+				auto jfa = jmp_fixup_addrs.find(target);
+				if (jfa != jmp_fixup_addrs.end()) {
+					auto &v = jfa->second;
+					v.erase(std::remove_if(v.begin(), v.end(), in_trace), v.end());
+					if (v.size() == 0) jmp_fixup_addrs.erase(jfa);
+				}
+				auto tl = jmp_links.find(target);
+				if (tl != jmp_links.end()) {
+					auto &v = tl->second;
+					v.erase(std::remove_if(v.begin(), v.end(),
+						[&](trace_link &link) { return in_trace(link.site); }), v.end());
+					if (v.size() == 0) jmp_links.erase(tl);
+				}
+			}
+
+			/* release the trace */
+			trace_cache_prolog.erase(pc);
+			trace_cache_entry.erase(pc);
+			if (trace_front_slot(pc).pc == pc) {
+				trace_front_slot(pc) = trace_front_ent{ addr_t(-1), nullptr };
+			}
+			trace_region *region = find_trace_region(ent.region);
+			if (region) {
+				region->bytes -= ent.code_end - ent.code_begin;
+			}
+			if (replaced) {
+				/* region eviction resets these wholesale, a replaced trace
+				 * must be dropped from them before its code is released */
+				size_t slot = (pc >> 1) & (P::trace_l1_size - 1);
+				if (P::trace_pc[slot] == pc) {
+					P::trace_pc[slot] = P::trace_fn[slot] = 0;
+				}
+				for (auto &ti : trace_info) {
+					for (auto jmp_cache : ti.second.jmp_caches) {
+						if (((u64*)jmp_cache)[0] == pc) {
+							((u64*)jmp_cache)[0] = u64(-1);
+							((u64*)jmp_cache)[1] = 0;
+						}
+					}
+				}
+				if (region) {
+					region->pcs.erase(std::remove(region->pcs.begin(), region->pcs.end(), pc), region->pcs.end());
+				}
+			} else {
+				P::trace_evictions++;
+				trace_evicted[pc]++;
+			}
+			P::trace_cache_bytes -= ent.code_end - ent.code_begin;
+			P::trace_cache_traces--;
+			rt.release(ent.fn);
+			trace_info.erase(ti);
+		}
+
+		void evict_trace_regions()
+		{
+			size_t evicted = 0;
+			while (P::trace_cache_bytes > P::trace_cache_limit && trace_region_list.size() > 1) {
+				/* skip pcs retranslated since, their traces belong to newer regions */
+				trace_region &region = trace_region_list.front();
+				for (auto pc : region.pcs) {
+					auto ti = trace_info.find(pc);
+					if (ti != trace_info.end() && ti->second.region == region.id) {
+						evict_trace(pc);
+					}
+				}
+				trace_region_list.pop_front();
+				evicted++;
+			}
+			if (evicted == 0) return;
+
+			/* the emitted lookup cache and jump target caches may point to evicted traces */
+			memset(P::trace_pc, 0, sizeof(P::trace_pc));
+			memset(P::trace_fn, 0, sizeof(P::trace_fn));
+			for (auto &ti : trace_info) {
+				for (auto jmp_cache : ti.second.jmp_caches) {
+					((u64*)jmp_cache)[0] = u64(-1);
+					((u64*)jmp_cache)[1] = 0;
+				}
+			}
+		}
+
+		trace_region* find_trace_region(u64 id)
+		{
+			/* region ids are consecutive from the oldest region */
+			if (id == 0 || trace_region_list.size() == 0) return nullptr;
+			u64 index = id - trace_region_list.front().id;
+			return index < trace_region_list.size() ? &trace_region_list[index] : nullptr;
+		}
+
+		u64 trace_region_add(addr_t pc, size_t bytes)
+		{
+			size_t region_size = P::trace_cache_limit / trace_regions;
+			if (trace_region_list.size() == 0 || trace_region_list.back().bytes >= region_size) {
+				trace_region_list.push_back(trace_region{ ++trace_region_id, 0, std::vector<addr_t>() });
+			}
+			trace_region_list.back().bytes += bytes;
+			trace_region_list.back().pcs.push_back(pc);
+			return trace_region_list.back().id;
+		}
+
+		void clear_trace_front()
+		{
+			/* pc -1 never matches so the cache starts out empty */
+			for (size_t i = 0; i < trace_front_size; i++) {
+				trace_front[i] = trace_front_ent{ addr_t(-1), nullptr };
+			}
+			/* the emitted lookup cache points into released code */
+			memset(P::trace_pc, 0, sizeof(P::trace_pc));
+			memset(P::trace_fn, 0, sizeof(P::trace_fn));
+		}
+
+		trace_front_ent& trace_front_slot(addr_t pc)
+		{
+			return trace_front[(pc >> 1) & (trace_front_size - 1)];
 		}
 
 		static uintptr_t lookup_trace(uintptr_t pc)
@@ -264,70 +543,94 @@ namespace riscv {
 			proc->mmu.template store<P,u64>(*proc, addr, val);
 		}
 
-		void jit_apply_fixups(jit_emitter &emitter, addr_t pc, intptr_t entry_addr)
+		void jit_apply_fixups(addr_t pc, intptr_t entry_addr)
 		{
 			auto jfa = jmp_fixup_addrs.find(pc);
 			if (jfa != jmp_fixup_addrs.end()) {
+				auto &links = jmp_links[pc];
 				for (auto fixup_addr : jfa->second) {
+					links.push_back(trace_link{ fixup_addr, *(int*)(fixup_addr - 4) });
 					*(int*)(fixup_addr - 4) = (int)(entry_addr - fixup_addr);
 				}
 				jmp_fixup_addrs.erase(jfa);
 			}
 		}
 
-		void jit_stash_fixups(jit_emitter &emitter, CodeHolder &code, intptr_t prolog_addr)
+		void jit_stash_fixups(jit_job *job, intptr_t prolog_addr)
 		{
-			for (auto &jfl : emitter.jmp_fixup_labels) {
-				addr_t fixup_pc = jfl.first;
-				for (auto &label : jfl.second) {
-					auto jfa = jmp_fixup_addrs.find(fixup_pc);
-					if (jfa == jmp_fixup_addrs.end()) {
-						jfa = jmp_fixup_addrs.insert(jmp_fixup_addrs.end(),
-							std::pair<addr_t,std::vector<intptr_t>>(fixup_pc, std::vector<intptr_t>()));
-					}
-					jfa->second.push_back(prolog_addr + code.getLabelOffset(label));
+			for (auto &jf : job->jmp_fixups) {
+				auto &fixups = jmp_fixup_addrs[jf.first];
+				for (auto offset : jf.second) {
+					fixups.push_back(prolog_addr + offset);
 				}
 			}
 		}
 
-		void jit_cache(jit_emitter &emitter, CodeHolder &code, addr_t pc)
+		/* install a compiled trace, called on the interpreter thread */
+		void jit_cache(jit_job *job)
 		{
-			TraceFunc fn = nullptr;
-			Error err = rt.add(&fn, &code);
-			if (!err) {
-				union { intptr_t i; TraceFunc fn; } r = { .fn = fn };
-				intptr_t prolog_addr = r.i;
-				r.i += code.getLabelOffset(emitter.start);
-				intptr_t entry_addr = r.i;
-				trace_cache_prolog[pc] = fn;
-				trace_cache_entry[pc] = r.fn;
-				jit_apply_fixups(emitter, pc, entry_addr);
-				jit_stash_fixups(emitter, code, prolog_addr);
+			addr_t pc = job->pc;
+			bool replaced = trace_info.find(pc) != trace_info.end();
+			evict_trace(pc, replaced);
+			union { intptr_t i; TraceFunc fn; } r = { .fn = job->fn };
+			intptr_t prolog_addr = r.i;
+			r.i += job->entry_offset;
+			intptr_t entry_addr = r.i;
+			trace_cache_prolog[pc] = job->fn;
+			trace_cache_entry[pc] = r.fn;
+			trace_front_slot(pc) = trace_front_ent{ pc, job->fn };
+			jit_apply_fixups(pc, entry_addr);
+			jit_stash_fixups(job, prolog_addr);
+
+			/* link exits to traces that are already translated */
+			for (auto &jf : job->jmp_fixups) {
+				auto ti = trace_cache_entry.find(jf.first);
+				if (ti != trace_cache_entry.end()) {
+					jit_apply_fixups(jf.first, func_address(ti->second));
+				}
+			}
+
+			/* record the trace for eviction */
+			trace_info_ent &ent = trace_info[pc];
+			ent.fn = job->fn;
+			ent.code_begin = prolog_addr;
+			ent.code_end = prolog_addr + job->code_size;
+			for (auto &jf : job->jmp_fixups) {
+				ent.jmp_targets.push_back(jf.first);
+			}
+			for (auto offset : job->jmp_caches) {
+				ent.jmp_caches.push_back(prolog_addr + offset);
+			}
+			ent.region = 0;
+			P::trace_cache_bytes += job->code_size;
+			P::trace_cache_traces++;
+			if (!replaced && trace_evicted.find(pc) != trace_evicted.end()) {
+				P::trace_retranslations++;
+			}
+			if (P::trace_cache_limit) {
+				ent.region = trace_region_add(pc, job->code_size);
+				evict_trace_regions();
 			}
 		}
 
 		bool jit_exec(P &proc, addr_t pc)
 		{
-			auto ti = trace_cache_prolog.find(pc);
-			if (ti != trace_cache_prolog.end()) {
-				ti->second(static_cast<typename P::processor_type *>(&proc));
+			trace_front_ent &ent = trace_front_slot(pc);
+			if (unlikely(ent.pc != pc)) {
+				auto ti = trace_cache_prolog.find(pc);
+				ent = trace_front_ent{ pc, ti != trace_cache_prolog.end() ? ti->second : nullptr };
+			}
+			if (ent.fn) {
+				ent.fn(static_cast<typename P::processor_type *>(&proc));
 				return true;
 			}
 			return false;
 		}
 
+		/* trace code by interpreting it, then compile the trace */
 		void jit_trace()
 		{
-			CodeHolder code;
-			jit_logger logger;
-			logger.addOptions(Logger::kOptionBinaryForm | Logger::kOptionHexDisplacement | Logger::kOptionHexImmediate);
- 			code.init(rt.getCodeInfo());
-			code.setErrorHandler(this);
-
 			jit_tracer tracer(*this);
-			jit_emitter emitter(*this, code, ops, lookup_trace, lookup_trace_fast);
-			jit_regalloc<P> regalloc;
-
 			typename P::ux trace_pc = P::pc;
 			typename P::ux trace_instret = P::instret;
 
@@ -349,40 +652,203 @@ namespace riscv {
 			tracer.end();
 			P::log |= proc_log_jit_trap;
 
+			if (P::instret == trace_instret) {
+				hotspot.set(trace_pc, hotspot_type::count_skip);
+				return;
+			}
+
+			jit_submit(new jit_job{ trace_pc, P::pc, trace_gen, std::move(tracer.trace), jit_opts() });
+		}
+
+		jit_options jit_opts()
+		{
+			return jit_options{ u32(P::log), bool(P::update_instret), bool(P::memory_registers) };
+		}
+
+		/* compile on the JIT thread unless logging needs ordered output */
+		void jit_submit(jit_job *job)
+		{
+			hotspot.set(job->pc, hotspot_type::count_skip);
+			if (jit_thread.joinable() && jit_pending < jit_queue_size &&
+				!(P::log & (proc_log_jit_trace | proc_log_jit_regalloc)) &&
+				jit_queue.push_back(job))
+			{
+				jit_pending++;
+				std::lock_guard<std::mutex> lock(jit_mutex);
+				jit_cond.notify_one();
+			} else {
+				jit_compile(job);
+				jit_publish(job);
+			}
+		}
+
+		/* emit a trace as native code, called on either thread */
+		void jit_compile(jit_job *job)
+		{
+			CodeHolder code;
+			jit_logger logger;
+			logger.addOptions(Logger::kOptionBinaryForm | Logger::kOptionHexDisplacement | Logger::kOptionHexImmediate);
+			code.init(rt.getCodeInfo());
+			code.setErrorHandler(this);
+
+			jit_emitter emitter(job->opts, code, ops, lookup_trace, lookup_trace_fast, lookup_trace_ic);
+			jit_regalloc<P> regalloc;
+
+			/* allocate host registers for the trace */
+			if (!job->opts.memory_registers) {
+				regalloc.allocate(job->trace, jit_emitter::host_regs(), jit_emitter::host_reg_count);
+				emitter.set_regmap(regalloc.regmap, regalloc.reg_entry, regalloc.reg_def);
+			}
+
 			/* log register allocation */
-			if (P::log & proc_log_jit_regalloc) {
-				printf("jit-regalloc 0x%016llx-0x%016llx\n\n", (u64)trace_pc, (u64)P::pc);
-				regalloc.analyse(tracer.trace);
+			if (job->opts.log & proc_log_jit_regalloc) {
+				printf("jit-regalloc 0x%016llx-0x%016llx\n\n", (u64)job->pc, (u64)job->end_pc);
+				regalloc.analyse(job->trace);
 			}
 
 			/* log start of trace */
-			if (P::log & proc_log_jit_trace) {
-				printf("jit-trace 0x%016llx-0x%016llx\n\n", (u64)trace_pc, (u64)P::pc);
+			if (job->opts.log & proc_log_jit_trace) {
+				printf("jit-trace 0x%016llx-0x%016llx\n\n", (u64)job->pc, (u64)job->end_pc);
 				code.setLogger(&logger);
 			}
 
 			/* emit trace buffer as native code */
 			emitter.emit_prolog();
 			emitter.begin();
-			for (auto &dec : tracer.trace) {
+			for (auto &dec : job->trace) {
 				emitter.emit(dec);
 			}
 			emitter.end();
 			emitter.emit_epilog();
 
 			/* log end of trace */
-			if (P::log & proc_log_jit_trace) {
+			if (job->opts.log & proc_log_jit_trace) {
 				printf("\n");
 			}
 
-			if (P::instret == trace_instret) {
-				P::histogram_set_pc(trace_pc, P::hostspot_trace_skip);
+			/* add the code and resolve label offsets so the CodeHolder can go */
+			if (rt.add(&job->fn, &code)) {
+				job->fn = nullptr;
+				return;
+			}
+			job->entry_offset = code.getLabelOffset(emitter.start);
+			job->code_size = code.getCodeSize();
+			for (auto &jfl : emitter.jmp_fixup_labels) {
+				std::vector<size_t> offsets;
+				for (auto &label : jfl.second) {
+					offsets.push_back(code.getLabelOffset(label));
+				}
+				job->jmp_fixups.push_back(std::pair<addr_t,std::vector<size_t>>(jfl.first, offsets));
 			}
-			else {
-				jit_cache(emitter, code, trace_pc);
+			for (auto &label : emitter.jmp_cache_labels) {
+				job->jmp_caches.push_back(code.getLabelOffset(label));
 			}
 		}
 
+		/* cache a compiled trace unless fence.i flushed the cache since it was traced */
+		void jit_publish(jit_job *job)
+		{
+			if (!job->fn) {
+				hotspot.set(job->pc, hotspot_type::count_skip);
+			} else if (job->gen != trace_gen) {
+				rt.release(job->fn);
+				hotspot.set(job->pc, 0);
+			} else {
+				jit_cache(job);
+				hotspot.set(job->pc, hotspot_type::count_limit);
+				if (trace_cache_dir.size() > 0) {
+					trace_store.add(job->pc, job->trace);
+				}
+			}
+			delete job;
+		}
+
+		/* publish traces compiled on the JIT thread */
+		void jit_drain()
+		{
+			jit_job *job;
+			while ((job = jit_done.pop_front())) {
+				jit_publish(job);
+				jit_pending--;
+			}
+		}
+
+		void jit_mainloop()
+		{
+			sigset_t set;
+			sigfillset(&set);
+			if (pthread_sigmask(SIG_BLOCK, &set, NULL) != 0) {
+				panic("jit thread: can't set thread signal mask: %s", strerror(errno));
+			}
+			while (jit_running.load(std::memory_order_acquire)) {
+				jit_job *job;
+				while ((job = jit_queue.pop_front())) {
+					jit_compile(job);
+					jit_done.push_back(job);
+				}
+				std::unique_lock<std::mutex> lock(jit_mutex);
+				jit_cond.wait(lock, [&] { return !jit_running.load(std::memory_order_acquire) || !jit_queue.empty(); });
+			}
+		}
+
+		/* live runloops with a trace cache, saved on exit or destruction */
+		static std::mutex& trace_store_mutex()
+		{
+			static std::mutex mutex;
+			return mutex;
+		}
+
+		static std::vector<jit_runloop*>& trace_store_list()
+		{
+			static std::vector<jit_runloop*> list;
+			return list;
+		}
+
+		static void trace_store_save_all()
+		{
+			std::lock_guard<std::mutex> lock(trace_store_mutex());
+			for (auto *proc : trace_store_list()) {
+				proc->trace_store.save(proc->trace_cache_dir);
+			}
+			trace_store_list().clear();
+		}
+
+		void trace_store_register()
+		{
+			static std::once_flag once;
+			std::call_once(once, [] { std::atexit(trace_store_save_all); });
+			std::lock_guard<std::mutex> lock(trace_store_mutex());
+			trace_store_list().push_back(this);
+		}
+
+		void trace_store_release()
+		{
+			std::lock_guard<std::mutex> lock(trace_store_mutex());
+			auto &list = trace_store_list();
+			auto ent = std::find(list.begin(), list.end(), this);
+			if (ent == list.end()) return;
+			list.erase(ent);
+			trace_store.save(trace_cache_dir);
+		}
+
+		void jit_shutdown()
+		{
+			if (!jit_thread.joinable()) return;
+			{
+				std::lock_guard<std::mutex> lock(jit_mutex);
+				jit_running.store(false, std::memory_order_release);
+				jit_cond.notify_one();
+			}
+			jit_thread.join();
+			jit_job *job;
+			while ((job = jit_queue.pop_front())) delete job;
+			while ((job = jit_done.pop_front())) {
+				if (job->fn) rt.release(job->fn);
+				delete job;
+			}
+			jit_pending = 0;
+		}
+
 		void copy_reg(typename P::processor_type *dst, typename P::processor_type *src)
 		{
 			memcpy(dst, src, sizeof(typename P::processor_type));
@@ -406,7 +872,7 @@ namespace riscv {
 			logger.addOptions(Logger::kOptionBinaryForm | Logger::kOptionHexDisplacement | Logger::kOptionHexImmediate);
 			code.init(rt.getCodeInfo());
 			code.setErrorHandler(this);
-			jit_emitter emitter(*this, code, ops, lookup_trace, lookup_trace_fast);
+			jit_emitter emitter(jit_opts(), code, ops, lookup_trace, lookup_trace_fast, lookup_trace_ic);
 			bool audited = false;
 			typename P::processor_type pre_jit, post_jit;
 			addr_t save_pc = dec.pc = P::pc;
@@ -487,12 +953,64 @@ namespace riscv {
 			}
 		}
 
+		block_ent* block_lookup(addr_t host)
+		{
+			block_ent *ent = blocks.lookup(host);
+			if (!ent) {
+				P::mmu.inst_code_page(*this, P::pc, host);
+				ent = blocks.fill(*this, host, P::pc);
+			}
+			return ent->count > 0 ? ent : nullptr;
+		}
+
+		/* count control flow targets, returns true if the target is hot */
+		bool hotspot_target(addr_t pc)
+		{
+			u32 count = hotspot.add(pc);
+			return count >= P::trace_iters && count != hotspot_type::count_skip;
+		}
+
+		bool step_block(block_ent *ent, typename P::ux inststop, bool &target)
+		{
+			typename P::ux new_offset;
+			for (size_t i = 0; i < ent->count && P::instret != inststop; i++) {
+				auto &bi = ent->inst[i];
+				block_dec = &bi.dec;
+				if ((new_offset = P::inst_exec(bi.dec, bi.len)) != typename P::ux(-1) ||
+					(new_offset = inst_fence_i(bi.dec, bi.len)) != typename P::ux(-1) ||
+					(new_offset = P::inst_priv(bi.dec, bi.len)) != typename P::ux(-1))
+				{
+					if (P::log & ~(proc_log_hist_pc | proc_log_jit_trap)) {
+						typename P::decode_type dec = bi.dec; /* logging rewrites pseudo ops */
+						P::print_log(dec, bi.inst);
+					}
+					target = new_offset != bi.len;
+					P::pc += new_offset;
+					P::instret++;
+				} else {
+					P::raise(rv_cause_illegal_instruction, P::pc);
+				}
+				if (P::pc == P::breakpoint && P::breakpoint != 0) {
+					block_dec = nullptr;
+					return false;
+				}
+			}
+			block_dec = nullptr;
+			return true;
+		}
+
 		exit_cause step(size_t count)
 		{
 			typename P::decode_type dec;
+			block_ent *ent;
+			addr_t host;
 			typename P::ux inststop = P::instret + count;
 			typename P::ux pc_offset, new_offset;
 			inst_t inst = 0, inst_cache_key;
+			bool target = false;
+
+			/* machines may be stepped from any thread */
+			make_current();
 
 			/* interrupt service routine */
 			P::time = cpu_cycle_clock();
@@ -502,6 +1020,11 @@ namespace riscv {
 			int cause;
 			if (unlikely((cause = setjmp(P::env)) > 0)) {
 				cause -= P::internal_cause_offset;
+				target = false;
+				if (block_dec) {
+					dec = *block_dec;
+					block_dec = nullptr;
+				}
 				switch(cause) {
 					case P::internal_cause_cli:
 						return exit_cause_cli;
@@ -511,9 +1034,6 @@ namespace riscv {
 						return exit_cause_poweroff;
 					case P::internal_cause_poweroff:
 						return exit_cause_poweroff;
-					case P::internal_cause_hotspot:
-						jit_trace();
-						return exit_cause_continue;
 				}
 				P::trap(dec, cause);
 				if (!P::running) return exit_cause_poweroff;
@@ -521,12 +1041,34 @@ namespace riscv {
 
 			/* step the processor */
 			while (P::instret != inststop) {
-				if ((P::log & proc_log_jit_trap) && jit_exec(*this, P::pc)) {
-					continue;
+				/* trace exits, taken branches and jumps are counted as
+				 * hotspot candidates and traced once they are hot */
+				if (P::log & proc_log_jit_trap) {
+					if (jit_pending) {
+						jit_drain();
+					}
+					if (jit_exec(*this, P::pc)) {
+						target = true;
+						continue;
+					}
+					if (target && hotspot_target(P::pc)) {
+						jit_trace();
+						return exit_cause_continue;
+					}
+					target = false;
 				}
 				if (P::pc == P::breakpoint && P::breakpoint != 0) {
 					return exit_cause_cli;
 				}
+				/* run decoded blocks when not profiling or auditing */
+				if (!(P::log & proc_log_jit_audit) &&
+					(host = P::mmu.inst_host(*this, P::pc)) && (ent = block_lookup(host)))
+				{
+					if (!step_block(ent, inststop, target)) {
+						return exit_cause_cli;
+					}
+					continue;
+				}
 				inst = P::mmu.inst_fetch(*this, P::pc, pc_offset);
 				inst_cache_key = inst % inst_cache_size;
 				if (inst_cache[inst_cache_key].inst == inst) {
@@ -544,6 +1086,7 @@ namespace riscv {
 						 (new_offset = P::inst_priv(dec, pc_offset)) != typename P::ux(-1))
 				{
 					if (P::log & ~(proc_log_hist_pc | proc_log_jit_trap)) P::print_log(dec, inst);
+					target = new_offset != pc_offset;
 					P::pc += new_offset;
 					P::instret++;
 				} else {
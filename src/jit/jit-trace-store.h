@@ -0,0 +1,206 @@
+//
+//  jit-trace-store.h
+//
+
+#ifndef rv_jit_trace_store_h
+#define rv_jit_trace_store_h
+
+namespace riscv {
+
+	/*
+	 * jit_trace_store
+	 *
+	 * Persistent trace descriptors keyed by the SHA-512 of the executable
+	 * text. Traces are stored as decoded instructions, including fused
+	 * ops and recorded branch directions, so they can be re-emitted at
+	 * startup without profiling. Only traces lying entirely within the
+	 * hashed text and matching its current contents are stored or loaded,
+	 * so traces recorded from modified code are dropped.
+	 *
+	 * file = magic:version:xlen:count:{pc:length:{jit_decode}[length]}[count]
+	 */
+
+	template <typename DEC>
+	struct jit_trace_store
+	{
+		enum : u32 {
+			store_magic = 0x746a7672,     /* "rvjt" */
+			store_version = 1,
+			trace_max = 65536
+		};
+
+		struct text_range
+		{
+			addr_t begin;
+			addr_t end;
+		};
+
+		u32 xlen;
+		std::string key;
+		std::vector<text_range> text;
+		std::map<addr_t,std::vector<DEC>> traces;
+
+		jit_trace_store(u32 xlen) : xlen(xlen) {}
+
+		/* hash the executable segments of a mapped ELF image */
+		void hash_text(elf_file &elf, addr_t imageoffset)
+		{
+			sha512_ctx_t sha512;
+			u8 hash[SHA512_OUTPUT_BYTES];
+			sha512_init(&sha512);
+			sha512_update(&sha512, (const u8*)&xlen, sizeof(xlen));
+			for (auto &phdr : elf.phdrs) {
+				if (phdr.p_type != PT_LOAD || !(phdr.p_flags & PF_X)) continue;
+				addr_t begin = phdr.p_vaddr + imageoffset;
+				u64 size = phdr.p_filesz;
+				text.push_back(text_range{ begin, begin + size });
+				sha512_update(&sha512, (const u8*)&begin, sizeof(begin));
+				sha512_update(&sha512, (const u8*)&size, sizeof(size));
+				sha512_update(&sha512, (const u8*)begin, size);
+			}
+			sha512_final(&sha512, hash);
+			key.clear();
+			for (size_t i = 0; i < SHA512_OUTPUT_BYTES; i += 8) {
+				key.append(format_string("%016llx", be64toh(*(u64*)(hash + i))));
+			}
+		}
+
+		/* fused ops span sz bytes from pc and hold their last instruction */
+		static addr_t inst_end(DEC &dec)
+		{
+			return dec.pc + (dec.sz ? dec.sz : inst_length(dec.inst));
+		}
+
+		bool in_text(std::vector<DEC> &trace)
+		{
+			for (auto &dec : trace) {
+				addr_t end = inst_end(dec);
+				if (std::none_of(text.begin(), text.end(), [&](text_range &r) {
+					return dec.pc >= r.begin && end <= r.end;
+				})) return false;
+
+				/* compare with the instruction currently in memory */
+				size_t len = inst_length(dec.inst);
+				u64 inst = 0;
+				if (len > sizeof(inst) || end - dec.pc < len) return false;
+				memcpy(&inst, (const void*)(end - len), len);
+				u64 mask = len == sizeof(inst) ? ~0ULL : (1ULL << (len << 3)) - 1;
+				if (inst != (dec.inst & mask)) return false;
+			}
+			return trace.size() > 0;
+		}
+
+		void add(addr_t pc, std::vector<DEC> &trace)
+		{
+			if (in_text(trace)) traces[pc] = trace;
+		}
+
+		std::string filename(std::string dirname)
+		{
+			return dirname + "/" + key + ".traces";
+		}
+
+		static void write_dec(FILE *file, DEC &dec)
+		{
+			u8 rec[32] = { 0 };
+			*(u64*)(rec + 0) = dec.pc;
+			*(u64*)(rec + 8) = dec.inst;
+			*(s32*)(rec + 16) = dec.imm;
+			*(u16*)(rec + 20) = dec.op;
+			rec[22] = dec.codec;
+			rec[23] = dec.rd;
+			rec[24] = dec.rs1;
+			rec[25] = dec.rs2;
+			rec[26] = dec.rs3;
+			rec[27] = dec.rm;
+			rec[28] = dec.pred | (dec.succ << 4);
+			rec[29] = dec.aq | (dec.rl << 1) | (dec.brt << 2) | (dec.brc << 3) | (dec.sz << 4);
+			fwrite(rec, sizeof(rec), 1, file);
+		}
+
+		static bool read_dec(FILE *file, DEC &dec)
+		{
+			u8 rec[32];
+			if (fread(rec, sizeof(rec), 1, file) != 1) return false;
+			dec.pc = *(u64*)(rec + 0);
+			dec.inst = *(u64*)(rec + 8);
+			dec.imm = *(s32*)(rec + 16);
+			dec.op = *(u16*)(rec + 20);
+			dec.codec = rec[22];
+			dec.rd = rec[23];
+			dec.rs1 = rec[24];
+			dec.rs2 = rec[25];
+			dec.rs3 = rec[26];
+			dec.rm = rec[27];
+			dec.pred = rec[28] & 0xf;
+			dec.succ = rec[28] >> 4;
+			dec.aq = rec[29] & 1;
+			dec.rl = (rec[29] >> 1) & 1;
+			dec.brt = (rec[29] >> 2) & 1;
+			dec.brc = (rec[29] >> 3) & 1;
+			dec.sz = rec[29] >> 4;
+			return true;
+		}
+
+		/* a missing or mismatched file is an empty cache */
+		bool load(std::string dirname)
+		{
+			FILE *file;
+			u32 hdr[4];
+			if ((file = fopen(filename(dirname).c_str(), "r")) == nullptr) {
+				return false;
+			}
+			bool ok = fread(hdr, sizeof(hdr), 1, file) == 1 &&
+				hdr[0] == store_magic && hdr[1] == store_version && hdr[2] == xlen;
+			for (u32 i = 0; ok && i < hdr[3]; i++) {
+				u64 pc;
+				u32 length;
+				ok = fread(&pc, sizeof(pc), 1, file) == 1 &&
+					fread(&length, sizeof(length), 1, file) == 1 && length <= trace_max;
+				std::vector<DEC> trace(ok ? length : 0);
+				for (auto &dec : trace) {
+					if (!(ok = read_dec(file, dec))) break;
+				}
+				if (ok && in_text(trace)) traces[pc] = std::move(trace);
+			}
+			fclose(file);
+			if (!ok) traces.clear();
+			return ok;
+		}
+
+		/* write to a temporary file and rename so concurrent runs see whole files */
+		bool save(std::string dirname)
+		{
+			FILE *file;
+			std::string name = filename(dirname);
+			std::string tmpname = format_string("%s.%d", name.c_str(), getpid());
+			if ((file = fopen(tmpname.c_str(), "w")) == nullptr) {
+				debug("jit_trace_store: unable to open: %s: %s",
+					tmpname.c_str(), strerror(errno));
+				return false;
+			}
+			u32 hdr[4] = { store_magic, store_version, xlen, u32(traces.size()) };
+			fwrite(hdr, sizeof(hdr), 1, file);
+			for (auto &ent : traces) {
+				u64 pc = ent.first;
+				u32 length = u32(ent.second.size());
+				fwrite(&pc, sizeof(pc), 1, file);
+				fwrite(&length, sizeof(length), 1, file);
+				for (auto &dec : ent.second) {
+					write_dec(file, dec);
+				}
+			}
+			bool ok = !ferror(file);
+			fclose(file);
+			if (!ok || rename(tmpname.c_str(), name.c_str()) < 0) {
+				debug("jit_trace_store: unable to write: %s", name.c_str());
+				unlink(tmpname.c_str());
+				return false;
+			}
+			return true;
+		}
+	};
+
+}
+
+#endif
@@ -15,114 +15,292 @@
 
 #include "mmap-core.h"
 
+/*
+ * Pages are tracked in a 3 level bitmap indexed by address bits 47:36,
+ * 35:24 and 23:12. Interior levels hold present, used and full summary
+ * bits for each child so free and fully used subtrees are skipped, and
+ * leaves are scanned a word at a time. Recently unmapped extents are
+ * kept in size bucketed slots and reused before searching.
+ */
+
+#define BMAP_BITS 4096
+#define BMAP_WORDS (BMAP_BITS / 64)
+#define EXTENT_BUCKETS 16
+#define EXTENT_SLOTS 8
+
+typedef struct { uint64_t w[BMAP_WORDS]; } bmap_t;
+
+/* present: child mapped, used: child has a used page, full: child all used */
+typedef struct {
+	bmap_t present;
+	bmap_t used;
+	bmap_t full;
+} bmap_node_t;
+
+typedef struct {
+	uintptr_t addr;
+	size_t len;
+} extent_t;
+
 static _Bool map_inited = false;
 static _Bool map_debug = false;
 static pthread_mutex_t meta_lock = PTHREAD_MUTEX_INITIALIZER;
+static extent_t extent_cache[EXTENT_BUCKETS][EXTENT_SLOTS];
 
 static const uintptr_t GUEST_MMAP_BASE = 0x40000000ULL;
 static const uintptr_t HOST_MMAP_BASE = 0x7fff00000000UL;
 static const uintptr_t METADATA_BASE = 0x7f0000000000UL;
+static const uintptr_t ADDR_LIMIT = (1ULL << 48);
 static const uintptr_t PAGE_SHIFT = 12;
 static const uintptr_t PAGE_SIZE = (1ULL << 12);
-static const uintptr_t PAGE_MASK = ((1ULL << 12) - 1);
-static const uintptr_t LEVEL_SIZE = (1ULL << 12);
-static const uintptr_t LEVEL_BYTES = ((1ULL << 12) >> 3);
+static const uintptr_t LEVEL_SHIFT = 12;
+static const uintptr_t LEVEL_MASK = ((1ULL << 12) - 1);
 static const int METADATA_PROT = PROT_READ | PROT_WRITE;
 static const int METADATA_FLAGS = MAP_FIXED | MAP_ANONYMOUS | MAP_PRIVATE;
 
-static void mark_used(uintptr_t start_of_range, size_t len);
-static void mark_free(uintptr_t start_of_range, size_t len);
-static _Bool page_present(uintptr_t addr);
+/* metadata layout: root page, a page per node, a page per leaf */
+#define ROOT_NODE ((bmap_node_t*)METADATA_BASE)
+#define NODE_BASE (METADATA_BASE + PAGE_SIZE)
+#define LEAF_BASE (NODE_BASE + (PAGE_SIZE << LEVEL_SHIFT))
 
-static void init_mmap()
+static inline size_t top_index(uintptr_t addr) { return (addr >> 36) & LEVEL_MASK; }
+static inline size_t mid_index(uintptr_t addr) { return (addr >> 24) & LEVEL_MASK; }
+static inline size_t page_index(uintptr_t addr) { return (addr >> 12) & LEVEL_MASK; }
+
+static inline bmap_node_t* node_bmap(size_t top)
 {
-	if(map_inited) return;
-	if (mmap((void*)METADATA_BASE, 4096, METADATA_PROT, METADATA_FLAGS, -1, 0) == MAP_FAILED) {
-		fprintf(stderr, "mmap failed: %s", strerror(errno));
+	return (bmap_node_t*)(NODE_BASE + (top << PAGE_SHIFT));
+}
+
+static inline bmap_t* leaf_bmap(size_t top, size_t mid)
+{
+	return (bmap_t*)(LEAF_BASE + (((top << LEVEL_SHIFT) | mid) << PAGE_SHIFT));
+}
+
+static inline _Bool bmap_test(const bmap_t *b, size_t i)
+{
+	return (b->w[i >> 6] >> (i & 63)) & 1;
+}
+
+static inline void bmap_assign(bmap_t *b, size_t i, _Bool val)
+{
+	if (val) b->w[i >> 6] |= 1ULL << (i & 63);
+	else b->w[i >> 6] &= ~(1ULL << (i & 63));
+}
+
+/* set or clear bits [begin, end) */
+static void bmap_assign_range(bmap_t *b, size_t begin, size_t end, _Bool val)
+{
+	while (begin < end) {
+		size_t bit = begin & 63, n = 64 - bit;
+		if (n > end - begin) n = end - begin;
+		uint64_t mask = (n == 64 ? ~0ULL : ((1ULL << n) - 1)) << bit;
+		if (val) b->w[begin >> 6] |= mask;
+		else b->w[begin >> 6] &= ~mask;
+		begin += n;
+	}
+}
+
+/* index of the first bit equal to val at or after i, or BMAP_BITS */
+static size_t bmap_scan(const bmap_t *b, size_t i, _Bool val)
+{
+	for (size_t w = i >> 6; w < BMAP_WORDS; w++) {
+		uint64_t word = val ? b->w[w] : ~b->w[w];
+		if (w == (i >> 6)) word &= ~0ULL << (i & 63);
+		if (word) return (w << 6) + __builtin_ctzll(word);
+	}
+	return BMAP_BITS;
+}
+
+static _Bool bmap_any(const bmap_t *b)
+{
+	for (size_t w = 0; w < BMAP_WORDS; w++) {
+		if (b->w[w]) return true;
+	}
+	return false;
+}
+
+static _Bool bmap_all(const bmap_t *b)
+{
+	for (size_t w = 0; w < BMAP_WORDS; w++) {
+		if (~b->w[w]) return false;
+	}
+	return true;
+}
+
+static void map_metadata(void *addr)
+{
+	void *rv;
+	if (map_debug) {
+		printf("reifying metadata %p\n", addr);
+	}
+	if ((rv = mmap(addr, PAGE_SIZE, METADATA_PROT, METADATA_FLAGS, -1, 0)) == MAP_FAILED) {
+		fprintf(stderr, "mmap failed: %s\n", strerror(errno));
+		exit(1);
+	} else if (rv != addr) {
+		fprintf(stderr, "mmap failed: invalid address\n");
 		exit(1);
 	}
+}
+
+static void init_mmap()
+{
+	if(map_inited) return;
+	map_metadata(ROOT_NODE);
 	map_inited = 1;
 }
 
-static uintptr_t level_bmap(size_t level, uintptr_t addr, uintptr_t *offset)
+/* returns the leaf for addr, mapping metadata if reify is set */
+static bmap_t* reify_bmap(uintptr_t addr, _Bool reify)
 {
-	uintptr_t bmap;
-	switch (level) {
-		case 3:
-			bmap = METADATA_BASE;
-			break;
-		case 2:
-		    bmap = METADATA_BASE + LEVEL_BYTES + ((addr >> (36 + 3)) & 0xfff) * LEVEL_BYTES;
-			break;
-		case 1:
-		    bmap = METADATA_BASE + LEVEL_BYTES + (LEVEL_SIZE * LEVEL_BYTES) + ((addr >> (24 + 3)) & 0xfff) * LEVEL_BYTES;
-			break;
-		default:
-			bmap = -1;
-			break;
+	size_t top = top_index(addr), mid = mid_index(addr);
+	if (!bmap_test(&ROOT_NODE->present, top)) {
+		if (!reify) return NULL;
+		map_metadata(node_bmap(top));
+		bmap_assign(&ROOT_NODE->present, top, true);
 	}
-	if (offset) {
-		*offset = ((addr >> (12 * level)) & PAGE_MASK);
+	bmap_node_t *node = node_bmap(top);
+	if (!bmap_test(&node->present, mid)) {
+		if (!reify) return NULL;
+		map_metadata(leaf_bmap(top, mid));
+		bmap_assign(&node->present, mid, true);
 	}
-	return bmap;
+	return leaf_bmap(top, mid);
 }
 
-static void reify_bmap(char *bmap)
+/* mark pages [start, end) used or free and update the summary bits */
+static void mark_range(uintptr_t start, uintptr_t end, _Bool used)
 {
-	for (size_t level = 2; level > 0; level--) {
-		uintptr_t offset1;
-		char *bmap1 = (char*)level_bmap(level + 1, (uintptr_t)bmap, &offset1);
-		if ((bmap1[offset1 >> 3] & (1 << (offset1 & 7))) == 0) {
-			uintptr_t offset2;
-			char *bmap2 = (char*)level_bmap(level, (uintptr_t)bmap, &offset2);
-			void *rv, *map_addr = (void*)((uintptr_t)bmap2 & ~(PAGE_SIZE-1));
-			if (map_debug) {
-				printf("reifying addr=%p level=%zu %p:%zu -> %p:%zu mmap(%p,%p)\n",
-					bmap, level, bmap1, offset1, bmap2, offset2, map_addr, (void*)PAGE_SIZE);
-			}
-			if ((rv = mmap(map_addr, PAGE_SIZE, METADATA_PROT, METADATA_FLAGS, -1, 0)) == MAP_FAILED) {
-				fprintf(stderr, "mmap failed: %s\n", strerror(errno));
-				exit(1);
-			} else if (rv != map_addr) {
-				fprintf(stderr, "mmap failed: invalid address\n");
-				exit(1);
-			}
-			bmap1[offset1 >> 3] = 0xff;
+	uintptr_t leaf_span = PAGE_SIZE << LEVEL_SHIFT;
+	for (uintptr_t addr = start; addr < end; ) {
+		uintptr_t next = (addr & ~(leaf_span - 1)) + leaf_span;
+		if (next > end || next == 0) next = end;
+		bmap_t *leaf = reify_bmap(addr, used);
+		if (leaf) {
+			size_t top = top_index(addr), mid = mid_index(addr);
+			bmap_node_t *node = node_bmap(top);
+			bmap_assign_range(leaf, page_index(addr), page_index(next - 1) + 1, used);
+			bmap_assign(&node->used, mid, bmap_any(leaf));
+			bmap_assign(&node->full, mid, bmap_all(leaf));
+			bmap_assign(&ROOT_NODE->used, top, bmap_any(&node->used));
+			bmap_assign(&ROOT_NODE->full, top, bmap_all(&node->full));
 		}
+		addr = next;
+	}
+}
+
+/* end of the run of pages starting at addr that are all free or all used */
+static uintptr_t extent_end(uintptr_t addr, _Bool *is_free)
+{
+	size_t i, top = top_index(addr), mid = mid_index(addr);
+	if (!bmap_test(&ROOT_NODE->used, top)) {
+		*is_free = true;
+		i = bmap_scan(&ROOT_NODE->used, top, true);
+		return i == BMAP_BITS ? ADDR_LIMIT : (uintptr_t)i << 36;
+	}
+	if (bmap_test(&ROOT_NODE->full, top)) {
+		*is_free = false;
+		i = bmap_scan(&ROOT_NODE->full, top, false);
+		return i == BMAP_BITS ? ADDR_LIMIT : (uintptr_t)i << 36;
+	}
+	uintptr_t top_base = (uintptr_t)top << 36;
+	bmap_node_t *node = node_bmap(top);
+	if (!bmap_test(&node->used, mid)) {
+		*is_free = true;
+		return top_base + ((uintptr_t)bmap_scan(&node->used, mid, true) << 24);
+	}
+	if (bmap_test(&node->full, mid)) {
+		*is_free = false;
+		return top_base + ((uintptr_t)bmap_scan(&node->full, mid, false) << 24);
 	}
+	uintptr_t mid_base = top_base + ((uintptr_t)mid << 24);
+	bmap_t *leaf = leaf_bmap(top, mid);
+	size_t page = page_index(addr);
+	*is_free = !bmap_test(leaf, page);
+	return mid_base + ((uintptr_t)bmap_scan(leaf, page, *is_free) << PAGE_SHIFT);
 }
 
-static _Bool page_present(uintptr_t addr)
+static _Bool range_free(uintptr_t start, uintptr_t end)
 {
-	for (size_t level = 3; level > 0; level--) {
-		uintptr_t offset;
-		char *bmap = (char*)level_bmap(level, addr, &offset);
-		_Bool is_present = bmap[offset >> 3] & 1 << (offset & 7);
-		if (!is_present) return false;
+	_Bool is_free;
+	for (uintptr_t addr = start; addr < end; ) {
+		addr = extent_end(addr, &is_free);
+		if (!is_free) return false;
 	}
 	return true;
 }
 
+static size_t extent_bucket(size_t len)
+{
+	size_t b = 63 - __builtin_clzll(len >> PAGE_SHIFT);
+	return b < EXTENT_BUCKETS ? b : EXTENT_BUCKETS - 1;
+}
+
+static void extent_add(uintptr_t addr, size_t len)
+{
+	extent_t *slots = extent_cache[extent_bucket(len)];
+	size_t victim = 0;
+	for (size_t i = 0; i < EXTENT_SLOTS; i++) {
+		if (slots[i].len == 0) {
+			victim = i;
+			break;
+		}
+		if (slots[i].len < slots[victim].len) victim = i;
+	}
+	slots[victim] = (extent_t){ addr, len };
+}
+
+/* take len bytes from a cached extent within [start, end), or 0 */
+static uintptr_t extent_take(uintptr_t start, uintptr_t end, size_t len)
+{
+	for (size_t b = extent_bucket(len); b < EXTENT_BUCKETS; b++) {
+		for (size_t i = 0; i < EXTENT_SLOTS; i++) {
+			extent_t *ent = &extent_cache[b][i];
+			if (ent->len < len || ent->addr < start || ent->addr + len > end) continue;
+			extent_t found = *ent;
+			ent->len = 0;
+			if (!range_free(found.addr, found.addr + len)) continue;
+			if (found.len > len) {
+				extent_add(found.addr + len, found.len - len);
+			}
+			return found.addr;
+		}
+	}
+	return 0;
+}
+
 static uintptr_t find_free(uintptr_t start, uintptr_t end, size_t len)
 {
 	if (map_debug) {
 		printf("find_free range=(%p-%p) len=%zu\n",
 			(void*)start, (void*)end, len);
 	}
-	uintptr_t start_of_range;
-	for (uintptr_t addr = start; addr < end; addr += PAGE_SIZE) {
-		start_of_range = addr;
-		reify_bmap((char*)addr);
-		for (; addr < end && !page_present(addr); addr += PAGE_SIZE) {
-			if (addr - start_of_range >= len) {
-				if (map_debug) {
-					printf("find_free found=(%p-%p) scanned=%zu\n",
-						(void*)start_of_range, (void*)(start_of_range + len),
-						(start_of_range - start) >> PAGE_SHIFT);
-				}
-				return start_of_range;
+	len = (len + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+	if (len == 0) return 0;
+	if (end > ADDR_LIMIT) end = ADDR_LIMIT;
+	uintptr_t found = extent_take(start, end, len);
+	if (found) {
+		if (map_debug) {
+			printf("find_free cached=(%p-%p)\n", (void*)found, (void*)(found + len));
+		}
+		return found;
+	}
+	_Bool is_free;
+	uintptr_t start_of_range = start;
+	for (uintptr_t addr = start; addr < end; ) {
+		uintptr_t next = extent_end(addr, &is_free);
+		if (next > end) next = end;
+		if (!is_free) {
+			start_of_range = next;
+		} else if (next - start_of_range >= len) {
+			if (map_debug) {
+				printf("find_free found=(%p-%p) scanned=%zu\n",
+					(void*)start_of_range, (void*)(start_of_range + len),
+					(start_of_range - start) >> PAGE_SHIFT);
 			}
+			return start_of_range;
 		}
+		addr = next;
 	}
 	return 0;
 }
@@ -133,12 +311,7 @@ static void mark_used(uintptr_t start_of_range, size_t len)
 		printf("mark_used range=(%p-%p) len=%zu\n",
 			(void*)start_of_range, (void*)(start_of_range + len), len);
 	}
-	for (uintptr_t addr = start_of_range; addr < start_of_range + len; addr += PAGE_SIZE) {
-		reify_bmap((char*)addr);
-		uintptr_t offset;
-		char *bmap = (char*)level_bmap(1, addr, &offset);
-		bmap[offset >> 3] |= 1 << (offset & 7);
-	}
+	mark_range(start_of_range, start_of_range + len, true);
 }
 
 static void mark_free(uintptr_t start_of_range, size_t len)
@@ -147,11 +320,11 @@ static void mark_free(uintptr_t start_of_range, size_t len)
 		printf("mark_free range=(%p-%p) len=%zu\n",
 			(void*)start_of_range, (void*)(start_of_range + len), len);
 	}
-	for (uintptr_t addr = start_of_range; addr < start_of_range + len; addr += PAGE_SIZE) {
-		reify_bmap((char*)addr);
-		uintptr_t offset;
-		char *bmap = (char*)level_bmap(1, addr, &offset);
-		bmap[offset >> 3] &= ~(1 << (offset & 7));
+	uintptr_t page_start = start_of_range & ~(PAGE_SIZE - 1);
+	uintptr_t page_end = (start_of_range + len + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+	mark_range(page_start, page_end, false);
+	if (page_end > page_start) {
+		extent_add(page_start, page_end - page_start);
 	}
 }
 
@@ -219,7 +392,7 @@ void* __guest_mmap(mmap_fn mmap, void *addr, size_t len, int prot, int flags, in
 	pthread_mutex_lock(&meta_lock);
 	init_mmap();
 	if (addr == NULL) {
-		addr = (void*)find_free(GUEST_MMAP_BASE, HOST_MMAP_BASE, len);
+		addr = (void*)find_free(GUEST_MMAP_BASE, METADATA_BASE, len);
 		if (!addr) {
 			pthread_mutex_unlock(&meta_lock);
 			return addr;